@@ -0,0 +1,72 @@
+-- /profile — Lua callback profiler. Enable it in config/scripts.toml [profiler] or with /profile on.
+
+local profileTalk = TalkAction("/profile")
+
+local function formatBytes(bytes)
+    if math.abs(bytes) >= 1024 * 1024 then
+        return string.format("%.1fM", bytes / (1024 * 1024))
+    elseif math.abs(bytes) >= 1024 then
+        return string.format("%.1fK", bytes / 1024)
+    end
+    return tostring(bytes)
+end
+
+local function cmdTop(player, args)
+    local sortBy = args[1] or "time"
+    local limit = tonumber(args[2]) or 15
+    local profile = Game.getScriptProfile(limit, sortBy)
+
+    local lines = { string.format("=== Script Profile by %s (%s) ===", sortBy, profile.enabled and "running" or "stopped") }
+    table.insert(lines, string.format("%-10s %-8s %-9s %-9s %-8s %s", "Total ms", "Calls", "Avg us", "Max us", "Alloc", "Callback"))
+    for _, row in ipairs(profile.callbacks) do
+        table.insert(lines, string.format("%-10.1f %-8d %-9.1f %-9d %-8s %s [%s] %s",
+            row.totalTime / 1000, row.calls, row.totalTime / row.calls, row.maxTime, formatBytes(row.allocBytes),
+            row.script, row.event, row.func))
+    end
+
+    if #profile.samples > 0 then
+        table.insert(lines, "")
+        table.insert(lines, "[Hottest functions, count hook samples]")
+        for _, row in ipairs(profile.samples) do
+            table.insert(lines, string.format("%-8d %s", row.samples, row.func))
+        end
+    end
+
+    player:sendTextMessage(MESSAGE_INFO_DESCR, table.concat(lines, "\n"))
+end
+
+function profileTalk.onSay(player, words, param)
+    if not player:getGroup():getAccess() then
+        return true
+    end
+
+    local parts = param:splitTrimmed(" ")
+    local sub = table.remove(parts, 1)
+
+    if sub == "on" or sub == "off" then
+        Game.setScriptProfiling(sub == "on")
+        player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "[profile] Profiling " .. (sub == "on" and "started." or "stopped."))
+    elseif sub == "reset" then
+        Game.resetScriptProfile()
+        player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "[profile] Reset.")
+    elseif sub == "dump" then
+        local path = Game.dumpScriptProfile()
+        if path then
+            player:sendTextMessage(MESSAGE_STATUS_CONSOLE_BLUE, "[profile] Written to " .. path)
+        else
+            player:sendCancelMessage("Dump failed — check the profiler directory.")
+        end
+    elseif sub == nil or sub == "" or sub == "time" or sub == "calls" or sub == "alloc" then
+        if sub and sub ~= "" then
+            table.insert(parts, 1, sub)
+        end
+        cmdTop(player, parts)
+    else
+        player:sendTextMessage(MESSAGE_INFO_DESCR, "Usage: /profile [time|calls|alloc [limit]] | on | off | reset | dump")
+    end
+
+    return false
+end
+
+profileTalk:separator(" ")
+profileTalk:register()
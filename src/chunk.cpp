@@ -120,7 +120,7 @@ namespace BlackTek::World
         creature_z[updateIndex] = newPosition.z;
     }
 
-    void Chunk::SetTileBlockState(const uint32_t offsetX, const uint32_t offsetY, const uint8_t z, const bool blocksPath, const bool blocksSolid, const bool blocksProjectile)
+    void Chunk::SetTileBlockState(const uint32_t offsetX, const uint32_t offsetY, const uint8_t z, const bool blocksPath, const bool blocksSolid, const bool blocksProjectile, const bool blocksArea)
     {
         const uint64_t bit = uint64_t{ 1 } << (offsetY * Floor::Size + offsetX);
 
@@ -132,8 +132,22 @@ namespace BlackTek::World
                 mask &= ~bit;
         };
 
+        const uint64_t walkBits = block_path_mask[z] | block_solid_mask[z];
+
         apply(block_path_mask[z], blocksPath);
         apply(block_solid_mask[z], blocksSolid);
         apply(block_projectile_mask[z], blocksProjectile);
+        apply(block_area_mask[z], blocksArea);
+
+        if ((block_path_mask[z] | block_solid_mask[z]) != walkBits)
+            ++path_revision[z];
+    }
+
+    void Chunk::SetTileWalkState(const uint32_t offsetX, const uint32_t offsetY, const uint8_t z, const bool hasGround, const bool needsWalkCheck)
+    {
+        const uint64_t bit = uint64_t{ 1 } << (offsetY * Floor::Size + offsetX);
+
+        ground_mask[z] = hasGround ? ground_mask[z] | bit : ground_mask[z] & ~bit;
+        walk_check_mask[z] = needsWalkCheck ? walk_check_mask[z] | bit : walk_check_mask[z] & ~bit;
     }
 }
@@ -11,6 +11,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace BlackTek::World
@@ -36,6 +37,10 @@ namespace BlackTek::World
         }
     };
 
+    // one bitplane per Zones::ZoneFlag, plane n holds the tiles with bit n set
+    static constexpr size_t ZoneFlagPlanes = 18;
+    using ZoneFlagLayers = std::array<std::array<uint64_t, ZoneFlagPlanes>, MaxLayers>;
+
     [[nodiscard]] constexpr ChunkCoord ToChunkCoord(uint16_t x, uint16_t y) noexcept
     {
         return ChunkCoord{ x >> Floor::Bits, y >> Floor::Bits };
@@ -60,6 +65,18 @@ namespace BlackTek::World
         std::array<uint64_t, MaxLayers> block_path_mask = {};
         std::array<uint64_t, MaxLayers> block_solid_mask = {};
         std::array<uint64_t, MaxLayers> block_projectile_mask = {};
+        // tiles area spells don't spread past (immovable solid items and anything blocking the path)
+        std::array<uint64_t, MaxLayers> block_area_mask = {};
+        // tiles with a ground item
+        std::array<uint64_t, MaxLayers> ground_mask = {};
+        // tiles on which the path and solid bits don't tell whether a creature may enter, it depends on the
+        // creature itself (fields, houses, floor changes, teleports, items that can be pushed away)
+        std::array<uint64_t, MaxLayers> walk_check_mask = {};
+        // bumped whenever a layer's path or solid bits change (or a tile is added to it), PathGraph rebuilds
+        // its transitions for the chunk and its four neighbors lazily when it sees a new value
+        std::array<uint32_t, MaxLayers> path_revision = {};
+        // world flags of Zones::ZoneManager, only allocated once a tile of the chunk is inside a flagged zone
+        std::unique_ptr<ZoneFlagLayers> zone_flags;
 
         [[nodiscard]] bool AllCreaturesSameFloor() const { return distinct_floor_count <= 1; }
 
@@ -67,6 +84,7 @@ namespace BlackTek::World
         void RemoveCreature(const CreaturePtr& creature);
         void UpdateCreaturePosition(const CreaturePtr& creature, const Position& newPosition);
 
-        void SetTileBlockState(uint32_t offsetX, uint32_t offsetY, uint8_t z, bool blocksPath, bool blocksSolid, bool blocksProjectile);
+        void SetTileBlockState(uint32_t offsetX, uint32_t offsetY, uint8_t z, bool blocksPath, bool blocksSolid, bool blocksProjectile, bool blocksArea);
+        void SetTileWalkState(uint32_t offsetX, uint32_t offsetY, uint8_t z, bool hasGround, bool needsWalkCheck);
     };
 }
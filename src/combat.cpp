@@ -3249,57 +3249,10 @@ namespace BlackTek
 		}
 	}
 
-	bool Combat::IsAreaTileClear(const uint16_t x, const uint16_t y, const uint8_t z) noexcept
-	{
-		const auto tile = g_game.map.getTile(x, y, z);
-		if (not tile) return true;
-		constexpr uint32_t barrier = TILESTATE_IMMOVABLEBLOCKSOLID
-			| TILESTATE_BLOCKPATH
-			| TILESTATE_IMMOVABLENOFIELDBLOCKPATH;
-		return (tile->getFlags() & barrier) == 0u;
-	}
-
-	bool Combat::CheckSteepLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z) noexcept
-	{
-		const float dx    = x1 - x0;
-		const float slope = (dx == 0.0f) ? 1.0f : (y1 - y0) / dx;
-		float yi = y0 + slope;
-		for (uint16_t x = x0 + 1; x < x1; ++x, yi += slope)
-		{
-			if (not IsAreaTileClear(static_cast<uint16_t>(std::floor(yi + 0.1f)), x, z))
-				return false;
-		}
-		return true;
-	}
-
-	bool Combat::CheckSlightLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z) noexcept
-	{
-		const float dx    = x1 - x0;
-		const float slope = (dx == 0.0f) ? 1.0f : (y1 - y0) / dx;
-		float yi = y0 + slope;
-		for (uint16_t x = x0 + 1; x < x1; ++x, yi += slope)
-		{
-			if (not IsAreaTileClear(x, static_cast<uint16_t>(std::floor(yi + 0.1f)), z))
-				return false;
-		}
-		return true;
-	}
-
 	bool Combat::IsAreaSightClear(const Position& from, const Position& to) noexcept
 	{
-		if (from == to or from.z != to.z) return true;
-		if (std::abs(from.x - to.x) < 2 and std::abs(from.y - to.y) < 2) return true;
-
-		if (std::abs(to.y - from.y) > std::abs(to.x - from.x))
-		{
-			if (to.y > from.y)
-				return CheckSteepLine(from.y, from.x, to.y, to.x, from.z);
-			return CheckSteepLine(to.y, to.x, from.y, from.x, from.z);
-		}
-
-		if (from.x > to.x)
-			return CheckSlightLine(to.x, to.y, from.x, from.y, from.z);
-		return CheckSlightLine(from.x, from.y, to.x, to.y, from.z);
+		// walks the chunk block_area_mask bits (immovable solid and path blocking tiles), memoized per dispatcher cycle
+		return g_game.map.isAreaSightClear(from, to);
 	}
 
 	void Combat::execute(const CreaturePtr& caster, const Position& center) noexcept
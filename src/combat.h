@@ -759,9 +759,6 @@ namespace BlackTek
 
 		
 
-		[[nodiscard]] static bool IsAreaTileClear(uint16_t x, uint16_t y, uint8_t z) noexcept;
-		[[nodiscard]] static bool CheckSteepLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z) noexcept;
-		[[nodiscard]] static bool CheckSlightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z) noexcept;
 		[[nodiscard]] static bool IsAreaSightClear(const Position& from, const Position& to) noexcept;
 
 		friend class CombatRegistry;
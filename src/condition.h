@@ -104,6 +104,11 @@ class Condition
 		virtual void addCondition(CreaturePtr creature, const Condition* condition) = 0;
 		virtual uint32_t getIcons() const;
 
+		// executeCondition does more than count the ticks down, the creature's conditions are due every think
+		virtual bool isPeriodic() const {
+			return true;
+		}
+
 		ConditionId_t getId() const {
 			return id;
 		}
@@ -187,6 +192,9 @@ class ConditionGeneric : public Condition
 		void endCondition(CreaturePtr creature) override;
 		void addCondition(CreaturePtr creature, const Condition* condition) override;
 		uint32_t getIcons() const override;
+		bool isPeriodic() const override {
+			return false;
+		}
 
 		[[nodiscard]] ConditionHandle clone() const override {
 			return ConditionHandle(new ConditionGeneric(*this));
@@ -241,6 +249,9 @@ class ConditionRegeneration final : public ConditionGeneric
 
 		void addCondition(CreaturePtr creature, const Condition* condition) override;
 		bool executeCondition(CreaturePtr creature, int32_t interval) override;
+		bool isPeriodic() const override {
+			return true;
+		}
 
 		bool setParam(ConditionParam_t param, int32_t value) override;
 		int32_t getParam(ConditionParam_t param) override;
@@ -271,6 +282,9 @@ class ConditionSoul final : public ConditionGeneric
 
 		void addCondition(CreaturePtr creature, const Condition* condition) override;
 		bool executeCondition(CreaturePtr creature, int32_t interval) override;
+		bool isPeriodic() const override {
+			return true;
+		}
 
 		bool setParam(ConditionParam_t param, int32_t value) override;
 		int32_t getParam(ConditionParam_t param) override;
@@ -390,6 +404,9 @@ class ConditionSpeed final : public Condition
 		void endCondition(CreaturePtr creature) override;
 		void addCondition(CreaturePtr creature, const Condition* condition) override;
 		uint32_t getIcons() const override;
+		bool isPeriodic() const override {
+			return false;
+		}
 
 		[[nodiscard]] ConditionHandle clone() const override {
 			return ConditionHandle(new ConditionSpeed(*this));
@@ -424,6 +441,9 @@ class ConditionOutfit final : public Condition
 		bool executeCondition(CreaturePtr creature, int32_t interval) override;
 		void endCondition(CreaturePtr creature) override;
 		void addCondition(CreaturePtr creature, const Condition* condition) override;
+		bool isPeriodic() const override {
+			return false;
+		}
 
 		[[nodiscard]] ConditionHandle clone() const override {
 			return ConditionHandle(new ConditionOutfit(*this));
@@ -510,6 +530,9 @@ class ConditionDrunk final : public Condition
 		bool startCondition(CreaturePtr creature) override;
 		bool setParam(ConditionParam_t param, int32_t value) override;
 		void addCondition(CreaturePtr creature, const Condition* condition) override;
+		bool isPeriodic() const override {
+			return false;
+		}
 
 		[[nodiscard]] ConditionHandle clone() const override {
 			return ConditionHandle(new ConditionDrunk(*this));
@@ -113,6 +113,11 @@ bool ConfigManager::Load()
             strings[IPV6] = serverTbl["network"]["ipv6"].value_or<std::string>("::");
         }
 
+        if (strings[SIMD_LEVEL].empty())
+        {
+            strings[SIMD_LEVEL] = serverTbl["performance"]["simd_level"].value_or<std::string>("auto");
+        }
+
         strings[MAP_NAME]          = serverTbl["world"]["map_name"].value_or<std::string>("forgotten");
         strings[MAP_AUTHOR]        = serverTbl["world"]["map_author"].value_or<std::string>("Unknown");
         strings[HOUSE_RENT_PERIOD] = gameplayTbl["houses"]["rent_period"].value_or<std::string>("never");
@@ -124,6 +129,7 @@ bool ConfigManager::Load()
         strings[ASSETS_DAT_PATH]   = serverTbl["world"]["assets_dat_path"].value_or<std::string>("data/items/assets.dat");
 
         integers[SQL_PORT]              = static_cast<int32_t>(databaseTbl["mysql"]["port"].value_or(int64_t{3306}));
+        integers[DATABASE_WORKERS]      = static_cast<int32_t>(databaseTbl["mysql"]["async_workers"].value_or(int64_t{2}));
         integers[MARKET_OFFER_DURATION] = static_cast<int32_t>(gameplayTbl["market"]["offer_duration"].value_or(int64_t{2592000}));
 
         if (integers[GAME_PORT] == 0)
@@ -173,6 +179,11 @@ bool ConfigManager::Load()
     integers[ACCOUNT_MANAGER_POS_Y]  = static_cast<int32_t>(serverTbl["account_manager"]["position_y"].value_or(int64_t{0}));
     integers[ACCOUNT_MANAGER_POS_Z]  = static_cast<int32_t>(serverTbl["account_manager"]["position_z"].value_or(int64_t{0}));
 
+    // Performance
+    integers[MAP_LOAD_THREADS] = static_cast<int32_t>(serverTbl["performance"]["map_load_threads"].value_or(int64_t{1}));
+    booleans[MAP_SNAPSHOT]     = serverTbl["performance"]["map_snapshot"].value_or(false);
+    integers[PATH_THREADS]     = static_cast<int32_t>(serverTbl["performance"]["path_threads"].value_or(int64_t{0}));
+
     // Combat
     booleans[AIMBOT_HOTKEY_ENABLED]   = combatTbl["hotkey"]["aimbot_enabled"].value_or(true);
     booleans[REMOVE_RUNE_CHARGES]     = combatTbl["items"]["remove_rune_charges"].value_or(true);
@@ -296,6 +307,8 @@ bool ConfigManager::Load()
     // Monsters
     booleans[FORCE_MONSTERTYPE_LOAD] = monstersTbl["spawn"]["force_monstertype_load"].value_or(true);
     booleans[REMOVE_ON_DESPAWN]      = monstersTbl["despawn"]["remove_on_despawn"].value_or(true);
+    booleans[MONSTER_FLOW_FIELDS]    = monstersTbl["pathfinding"]["flow_fields"].value_or(false);
+    booleans[MONSTER_DORMANCY]       = monstersTbl["dormancy"]["enabled"].value_or(true);
 
     integers[DEFAULT_DESPAWNRANGE]      = Monster::despawnRange  = static_cast<int32_t>(monstersTbl["despawn"]["range"].value_or(int64_t{2}));
     integers[DEFAULT_DESPAWNRADIUS]     = Monster::despawnRadius = static_cast<int32_t>(monstersTbl["despawn"]["radius"].value_or(int64_t{50}));
@@ -310,6 +323,25 @@ bool ConfigManager::Load()
     booleans[CHECK_DUPLICATE_STORAGE_KEYS] = scriptsTbl["validation"]["check_duplicate_storage_keys"].value_or(false);
     booleans[LUA_ITEM_DESC]                = scriptsTbl["validation"]["lua_item_desc"].value_or(false);
 
+    booleans[LUA_PROFILER]                     = scriptsTbl["profiler"]["enabled"].value_or(false);
+    integers[LUA_PROFILER_SAMPLE_INSTRUCTIONS] = static_cast<int32_t>(scriptsTbl["profiler"]["sample_instructions"].value_or(int64_t{0}));
+    integers[LUA_PROFILER_DUMP_MINUTES]        = static_cast<int32_t>(scriptsTbl["profiler"]["dump_interval_minutes"].value_or(int64_t{60}));
+    integers[LUA_PROFILER_KEEP_DUMPS]          = static_cast<int32_t>(scriptsTbl["profiler"]["keep_dump_count"].value_or(int64_t{24}));
+    strings[LUA_PROFILER_DIRECTORY]            = scriptsTbl["profiler"]["directory"].value_or<std::string>("logs/scripts/profile");
+
+    booleans[LUA_POOLED_ALLOCATOR] = scriptsTbl["allocator"]["pooled"].value_or(true);
+
+    booleans[LUA_BYTECODE_CACHE]          = scriptsTbl["bytecode_cache"]["enabled"].value_or(true);
+    strings[LUA_BYTECODE_CACHE_DIRECTORY] = scriptsTbl["bytecode_cache"]["directory"].value_or<std::string>("cache/scripts");
+
+    strings[LUA_GC_MODE]              = scriptsTbl["gc"]["mode"].value_or<std::string>("generational");
+    integers[LUA_GC_MINOR_MULTIPLIER] = static_cast<int32_t>(scriptsTbl["gc"]["minor_multiplier"].value_or(int64_t{20}));
+    integers[LUA_GC_MAJOR_MULTIPLIER] = static_cast<int32_t>(scriptsTbl["gc"]["major_multiplier"].value_or(int64_t{100}));
+    integers[LUA_GC_PAUSE]            = static_cast<int32_t>(scriptsTbl["gc"]["pause"].value_or(int64_t{200}));
+    integers[LUA_GC_STEP_MULTIPLIER]  = static_cast<int32_t>(scriptsTbl["gc"]["step_multiplier"].value_or(int64_t{100}));
+    integers[LUA_GC_IDLE_STEP_KB]     = static_cast<int32_t>(scriptsTbl["gc"]["idle_step_kb"].value_or(int64_t{64}));
+    integers[LUA_GC_IDLE_BUDGET_US]   = static_cast<int32_t>(scriptsTbl["gc"]["idle_budget_us"].value_or(int64_t{2000}));
+
     // Store
     strings[STORE_IMAGES_URL]      = storeTbl["store"]["images_url"].value_or<std::string>("http://127.0.0.1/images/store/");
     integers[STORE_COIN_PACKAGE_SIZE] = static_cast<int32_t>(storeTbl["store"]["coin_package_size"].value_or(int64_t{25}));
@@ -79,6 +79,12 @@ public:
         STRIP_LEGACY_ZONE_FLAGS,
         SMART_CONVERT_LEGACY_SPAWNS,
         DISABLE_LEGACY_SPAWN_FILE_AFTER_CONVERSION,
+        MAP_SNAPSHOT,
+        MONSTER_FLOW_FIELDS,
+        MONSTER_DORMANCY,
+        LUA_PROFILER,
+        LUA_POOLED_ALLOCATOR,
+        LUA_BYTECODE_CACHE,
 
         LAST_BOOLEAN_CONFIG
     };
@@ -106,6 +112,10 @@ public:
         ASSETS_DAT_PATH,
         IPV6,
         STORE_IMAGES_URL,
+        SIMD_LEVEL,
+        LUA_PROFILER_DIRECTORY,
+        LUA_GC_MODE,
+        LUA_BYTECODE_CACHE_DIRECTORY,
 
         LAST_STRING_CONFIG
     };
@@ -181,6 +191,18 @@ public:
         MULTILEVEL_FLOOR_RANGE,
         STORE_COIN_PACKAGE_SIZE,
         LEGACY_SPAWN_CLUSTER_RADIUS,
+        MAP_LOAD_THREADS,
+        DATABASE_WORKERS,
+        PATH_THREADS,
+        LUA_PROFILER_SAMPLE_INSTRUCTIONS,
+        LUA_PROFILER_DUMP_MINUTES,
+        LUA_PROFILER_KEEP_DUMPS,
+        LUA_GC_MINOR_MULTIPLIER,
+        LUA_GC_MAJOR_MULTIPLIER,
+        LUA_GC_PAUSE,
+        LUA_GC_STEP_MULTIPLIER,
+        LUA_GC_IDLE_STEP_KB,
+        LUA_GC_IDLE_BUDGET_US,
 
         LAST_INTEGER_CONFIG
     };
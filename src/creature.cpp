@@ -13,6 +13,8 @@
 #include "events.h"
 #include "party.h"
 #include "metrics.h"
+#include "pathworkers.h"
+#include "walksnapshot.h"
 
 double Creature::speedA = 857.36;
 double Creature::speedB = 261.29;
@@ -23,13 +25,15 @@ extern ConfigManager g_config;
 extern CreatureEvents* g_creatureEvents;
 extern Events* g_events;
 
-Creature::Creature()
+Creature::Creature() : luaHandle(BlackTek::CreatureRegistry::Register(this))
 {
 	onIdleStatus();
 }
 
 Creature::~Creature()
 {
+	BlackTek::CreatureRegistry::Release(luaHandle);
+
 	for (auto& summon : summons) {
 		summon->setAttackedCreature(nullptr);
 		summon->removeMaster();
@@ -892,10 +896,12 @@ bool Creature::setAttackedCreature(const CreaturePtr& creature)
 		if (creaturePos.z != getPosition().z or not canSee(creaturePos))
 		{
 			attackedCreature.reset();
+			g_game.setCreatureAttacking(*this, false);
 			return false;
 		}
 
 		attackedCreature = creature;
+		g_game.setCreatureAttacking(*this, true);
 		onAttackedCreature(getAttackedCreature());
 		getAttackedCreature()->onAttacked();
 
@@ -906,6 +912,7 @@ bool Creature::setAttackedCreature(const CreaturePtr& creature)
 	{
 		bool wasInBattle = static_cast<bool>(attackedCreature.lock());
 		attackedCreature.reset();
+		g_game.setCreatureAttacking(*this, false);
 
 		if (wasInBattle)
 		{
@@ -966,9 +973,12 @@ void Creature::goToFollowCreature()
 				hasFollowPath = true;
 				startAutoWalk();
 			}
+		} else if (requestFollowPath(target, fpp)) {
+			// the rest happens once the path is back
+			return;
 		} else {
 			listWalkDir.clear();
-			if (getPathTo(targetPos, listWalkDir, fpp)) {
+			if (getFollowPath(target, listWalkDir, fpp)) {
 				hasFollowPath = true;
 				startAutoWalk();
 			} else {
@@ -1201,6 +1211,17 @@ bool Creature::addCondition(ConditionHandle condition, bool force/* = false*/)
 	if (!condition)
 		return false;
 
+	// frozen conditions are replayed first, so the new one isn't advanced along with them
+	wakeUp();
+
+	// the same for the time the think wheel held them back
+	if (const uint32_t turns = g_game.settleCreatureConditions(*this))
+		executeConditions(turns * EVENT_CREATURE_THINK_INTERVAL);
+
+	// either replay can kill (and remove) the creature
+	if (isRemoved() || getHealth() <= 0)
+		return false;
+
 	if (!force && condition->getType() == CONDITION_HASTE && hasCondition(CONDITION_PARALYZE)) {
 		int64_t walkDelay = getWalkDelay();
 		if (walkDelay > 0) {
@@ -1218,6 +1239,7 @@ bool Creature::addCondition(ConditionHandle condition, bool force/* = false*/)
 	if (Condition* prevCond = getCondition(condition->getType(), condition->getId(), condition->getSubId()))
 	{
 		prevCond->addCondition(self, condition.Get());
+		g_game.updateCreatureConditionDeadline(*this);
 		return true;
 	}
 
@@ -1225,6 +1247,7 @@ bool Creature::addCondition(ConditionHandle condition, bool force/* = false*/)
 	if (condition->startCondition(self))
 	{
 		conditions.push_back(std::move(condition));
+		g_game.updateCreatureConditionDeadline(*this);
 		onAddCondition(condType);
 
 		if (auto spawnOverlay = Zones::ZoneManager::GetSpawns(getPosition()))
@@ -1294,6 +1317,7 @@ void Creature::removeCondition(ConditionType_t type, bool force/* = false*/)
 		ConditionHandle cond = std::move(*it);
 		cond->markRemoved();
 		it = conditions.erase(it);
+		g_game.updateCreatureConditionDeadline(*this);
 		cond->endCondition(self);
 		onEndCondition(type);
 
@@ -1325,6 +1349,7 @@ void Creature::removeCondition(ConditionType_t type, ConditionId_t conditionId,
 		ConditionHandle cond = std::move(*it);
 		cond->markRemoved();
 		it = conditions.erase(it);
+		g_game.updateCreatureConditionDeadline(*this);
 		cond->endCondition(self);
 		onEndCondition(type);
 
@@ -1368,6 +1393,7 @@ void Creature::removeCondition(const Condition* condition, bool force/* = false*
 	ConditionHandle cond = std::move(*it);
 	cond->markRemoved();
 	conditions.erase(it);
+	g_game.updateCreatureConditionDeadline(*this);
 	cond->endCondition(self);
 	onEndCondition(condType);
 
@@ -1397,6 +1423,9 @@ Condition* Creature::getCondition(ConditionType_t type, ConditionId_t conditionI
 
 void Creature::executeConditions(uint32_t interval)
 {
+	if (conditions.empty())
+		return;
+
 	const auto self = std::static_pointer_cast<Creature>(shared_from_this());
 
 	std::vector<ConditionHandle> snapshot;
@@ -1428,6 +1457,26 @@ void Creature::executeConditions(uint32_t interval)
 		onEndCondition(condType);
 		BlackTek::EmitConditionEnd(self, condType, BlackTek::Metrics::ConditionRecordType::Expiry);
 	}
+
+	g_game.updateCreatureConditionDeadline(*this);
+}
+
+int64_t Creature::getConditionDeadline() const
+{
+	if (conditions.empty())
+		return BlackTek::ThinkWheel::NoDeadline;
+
+	if (getPlayer())
+		return 0;
+
+	int64_t deadline = OTSYS_TIME() + MaxConditionHold;
+	for (const auto& condition : conditions) {
+		if (condition->isPeriodic())
+			return 0;
+
+		deadline = std::min(deadline, condition->getEndTime());
+	}
+	return deadline;
 }
 
 bool Creature::hasCondition(ConditionType_t type, uint32_t subId/* = 0*/) const
@@ -1799,10 +1848,81 @@ bool Creature::isInvisible() const
 	}) != conditions.end();
 }
 
+bool Creature::getFollowPath(const CreatureConstPtr& target, std::vector<Direction>& dirList, const FindPathParams& fpp)
+{
+	if (canUseFlowField(fpp)) {
+		auto t_c = getCreature();
+		if (g_game.map.getFlowFieldPath(t_c, target->getID(), target->getPosition(), dirList, fpp)) {
+			return true;
+		}
+	}
+	return getPathTo(target->getPosition(), dirList, fpp);
+}
+
+bool Creature::requestFollowPath(const CreatureConstPtr& target, const FindPathParams& fpp)
+{
+	if (!g_pathWorkers.isEnabled() || !canSearchPathAsync(fpp)) {
+		return false;
+	}
+
+	const Position startPos = getPosition();
+	const Position& targetPos = target->getPosition();
+	const int32_t targetDist = std::max<int32_t>(Position::getDistanceX(startPos, targetPos), Position::getDistanceY(startPos, targetPos));
+	const int32_t radius = std::max<int32_t>(fpp.maxSearchDist != 0 ? fpp.maxSearchDist : Map::maxViewportX, targetDist + std::max<int32_t>(fpp.maxTargetDist, 0)) + 1;
+
+	PathRequest request;
+	request.snapshot = BlackTek::World::WalkSnapshot::Capture(g_game.map, startPos, radius, this);
+	request.startPos = startPos;
+	request.targetPos = targetPos;
+	request.fpp = fpp;
+	request.callback = [creatureId = getID(), targetId = target->getID(), ticket = ++pathRequestTicket, snapshot = request.snapshot, startPos, fpp](bool found, std::vector<Direction>&& dirList) {
+		CreaturePtr creature = g_game.getCreatureByID(creatureId);
+		if (!creature || creature->isRemoved() || creature->pathRequestTicket != ticket) {
+			return;
+		}
+
+		const auto& target = creature->getFollowCreature();
+		if (!target || target->getID() != targetId) {
+			return;
+		}
+
+		// moved or the map changed under the search, look again on the next think
+		if (creature->getPosition() != startPos || !snapshot->IsCurrent(g_game.map)) {
+			creature->forceUpdateFollowPath = true;
+			return;
+		}
+
+		// the snapshot knows nothing about fields, zones or missing ground, the live map has the final say
+		if (found) {
+			Position pos = startPos;
+			for (auto it = dirList.rbegin(); it != dirList.rend() && found; ++it) {
+				pos = getNextPosition(*it, pos);
+				found = g_game.map.canWalkTo(creature, pos) != nullptr;
+			}
+
+			if (!found) {
+				dirList.clear();
+				found = creature->getFollowPath(target, dirList, fpp);
+			}
+		}
+
+		creature->listWalkDir = std::move(dirList);
+		creature->hasFollowPath = found;
+		if (found) {
+			creature->startAutoWalk();
+		}
+		creature->onFollowCreatureComplete(target);
+	};
+
+	g_pathWorkers.addRequest(std::move(request));
+	return true;
+}
+
 bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp)
 {
 	CreaturePtr t_c = getCreature();
-	return g_game.map.getPathMatching(t_c, dirList, FrozenPathingConditionCall(targetPos), fpp);
+	const FrozenPathingConditionCall pathCondition(targetPos);
+	return g_game.map.getHierarchicalPath(t_c, dirList, pathCondition, fpp) || g_game.map.getPathMatching(t_c, dirList, pathCondition, fpp);
 }
 
 bool Creature::getPathTo(const Position& targetPos, std::vector<Direction>& dirList, int32_t minTargetDist, int32_t maxTargetDist, bool fullPathSearch /*= true*/, bool clearSight /*= true*/, int32_t maxSearchDist /*= 0*/)
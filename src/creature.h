@@ -11,11 +11,17 @@
 #include "tile.h"
 #include "enums.h"
 #include "creatureevent.h"
+#include "creatureregistry.h"
 #include "declarations.h"
 #include "skills.h"
 #include "pointbasedstat.h"
 
 class Map;
+
+namespace BlackTek
+{
+	class ThinkWheel;
+}
 using ConditionList = std::list<ConditionHandle>;
 using CreatureEventList = std::list<CreatureEvent*>;
 using namespace Components::Skills;
@@ -50,6 +56,8 @@ struct FindPathParams {
 };
 static constexpr int32_t EVENT_DUMP_DECAY = 250;
 static constexpr int32_t EVENT_CREATURE_THINK_INTERVAL = 1000;
+// a condition's ticks can be changed by scripts while it runs, a held back expiry is looked at again after this long
+static constexpr int64_t MaxConditionHold = 5 * EVENT_CREATURE_THINK_INTERVAL;
 static constexpr int32_t EVENT_CORO_TIMER_CYCLE = 50;
 static constexpr int32_t EVENT_CHECK_CREATURE_INTERVAL = 100;
 
@@ -140,6 +148,11 @@ class Creature : public SharedObject
 		uint32_t getID() const {
 			return id;
 		}
+
+		// what Lua userdata of this creature holds, see BlackTek::CreatureRegistry
+		BlackTek::CreatureHandle getLuaHandle() const {
+			return luaHandle;
+		}
 	
 		virtual void removeList() = 0;
 		virtual void addList() = 0;
@@ -396,6 +409,9 @@ class Creature : public SharedObject
 		Condition* getCondition(ConditionType_t type) const;
 		Condition* getCondition(ConditionType_t type, ConditionId_t conditionId, uint32_t subId = 0) const;
 		void executeConditions(uint32_t interval);
+		// when executeConditions next has something to do: right away for periodic conditions (and any of a
+		// player's, the ticks left are saved), the first expiry otherwise, rechecked at least every MaxConditionHold
+		int64_t getConditionDeadline() const;
 		bool hasCondition(ConditionType_t type, uint32_t subId = 0) const;
 		virtual bool isImmune(ConditionType_t type) const;
 		virtual bool isImmune(CombatType_t type) const;
@@ -450,6 +466,12 @@ class Creature : public SharedObject
 		virtual void onChangeZone(ZoneType_t zone);
 		virtual void onAttackedCreatureChangeZone(ZoneType_t zone);
 		virtual void onIdleStatus();
+		// catches up on whatever was skipped while the creature slept off the think wheel
+		virtual void wakeUp() {}
+		// turns onThink can be skipped for, the interval it gets afterwards covers them
+		virtual uint32_t getThinkHold() const {
+			return 0;
+		}
 
 		virtual LightInfo getCreatureLight() const;
 		virtual void setNormalCreatureLight();
@@ -630,6 +652,10 @@ class Creature : public SharedObject
 		double getDamageRatio(const CreaturePtr& attacker) const;
 
 		bool getPathTo(const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp);
+		bool getFollowPath(const CreatureConstPtr& target, std::vector<Direction>& dirList, const FindPathParams& fpp);
+		// Hands the follow path search to the path workers, the path is applied once it comes back. False when
+		// the search has to run right away.
+		bool requestFollowPath(const CreatureConstPtr& target, const FindPathParams& fpp);
 		bool getPathTo(const Position& targetPos, std::vector<Direction>& dirList, int32_t minTargetDist, int32_t maxTargetDist, bool fullPathSearch = true, bool clearSight = true, int32_t maxSearchDist = 0);
 		CreatureEventList getCreatureEvents(CreatureEventType_t type) const;
 
@@ -679,11 +705,16 @@ class Creature : public SharedObject
 
 		uint64_t lastStep = 0;
 		uint64_t lastChaseRepath = 0;
+		BlackTek::CreatureHandle luaHandle;
 		uint32_t id = 0;
 		uint32_t chunk_slot = 0;
 		uint32_t scriptEventsBitField = 0;
 		uint32_t eventWalk = 0;
 		uint32_t walkUpdateTicks = 0;
+		// the follow path request whose answer is still wanted, older answers are dropped
+		uint32_t pathRequestTicket = 0;
+		// entry in Game's think wheel, ThinkWheel::InvalidIndex while not in it
+		uint32_t thinkIndex = 0xFFFFFFFF;
 		uint32_t lastHitCreatureId = 0;
 		uint32_t defense_charges = 0;
 		uint32_t armor_charges = 0;
@@ -708,8 +739,6 @@ class Creature : public SharedObject
 
 		bool isInternalRemoved = false;
 		bool isUpdatingPath = false;
-		bool creatureCheck = false;
-		bool inCheckCreaturesVector = false;
 		bool skillLoss = true;
 		bool lootDrop = true;
 		bool cancelNextWalk = false;
@@ -740,11 +769,20 @@ class Creature : public SharedObject
 		}
 
 		virtual void getPathSearchParams(const CreatureConstPtr& creature, FindPathParams& fpp) const;
+		// whether a follow path with these params may come from the flow field shared by everyone chasing the same target
+		virtual bool canUseFlowField(const FindPathParams&) const {
+			return false;
+		}
+		// whether a follow path with these params may be searched on the path workers
+		virtual bool canSearchPathAsync(const FindPathParams&) const {
+			return false;
+		}
 		virtual void death(const CreaturePtr&) {}
 		virtual bool dropCorpse(const CreaturePtr& lastHitCreature, const CreaturePtr& mostDamageCreature, bool lastHitUnjustified, bool mostDamageUnjustified);
 		ItemPtr getCorpse(const CreaturePtr& lastHitCreature, const CreaturePtr& mostDamageCreature);
 
 		friend class Game;
+		friend class BlackTek::ThinkWheel;
 		friend class Map;
 		friend class LuaScriptInterface;
 };
@@ -0,0 +1,64 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "creatureregistry.h"
+
+#include "console.h"
+
+#include <mutex>
+#include <vector>
+
+namespace BlackTek
+{
+    namespace
+    {
+        std::mutex g_slot_mutex;
+        std::vector<uint32_t> g_free_slots;
+        uint32_t g_next_slot = 0;
+    }
+
+    CreatureHandle CreatureRegistry::Register(Creature* creature)
+    {
+        std::lock_guard lock(g_slot_mutex);
+
+        uint32_t index;
+        if (not g_free_slots.empty())
+        {
+            index = g_free_slots.back();
+            g_free_slots.pop_back();
+        }
+        else
+        {
+            if (g_next_slot >= MaxBlocks * BlockSize) [[unlikely]]
+            {
+                Console::Error("Creature registry is full, {} creatures can't be passed to Lua.", MaxBlocks * BlockSize);
+                return {};
+            }
+
+            index = g_next_slot++;
+            auto& block = blocks[index >> BlockBits];
+            if (not block.load(std::memory_order_relaxed))
+                block.store(new Block(), std::memory_order_release);
+        }
+
+        // blocks are never freed, a resolve racing with the allocation above at worst sees an empty slot
+        Slot& slot = (*blocks[index >> BlockBits].load(std::memory_order_relaxed))[index & (BlockSize - 1)];
+        slot.creature.store(creature, std::memory_order_release);
+        return { index, slot.generation.load(std::memory_order_relaxed) };
+    }
+
+    void CreatureRegistry::Release(CreatureHandle handle) noexcept
+    {
+        if (not handle.IsValid())
+            return;
+
+        std::lock_guard lock(g_slot_mutex);
+
+        Slot& slot = (*blocks[handle.slot_index >> BlockBits].load(std::memory_order_relaxed))[handle.slot_index & (BlockSize - 1)];
+        slot.creature.store(nullptr, std::memory_order_release);
+        slot.generation.fetch_add(1, std::memory_order_acq_rel);
+        g_free_slots.push_back(handle.slot_index);
+    }
+}
@@ -0,0 +1,99 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include "handle.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class Creature;
+
+namespace BlackTek
+{
+    struct CreatureTag {};
+    using CreatureHandle = Handle<CreatureTag>;
+
+    // Every creature owns a slot from its constructor to its destructor. Lua userdata only keeps the
+    // handle, the game keeps ownership, and a handle of a destroyed creature resolves to nullptr even
+    // after its slot went to another creature. Lookups don't lock, creatures can be destroyed off the
+    // dispatcher thread (saving, login) while Lua resolves handles.
+    class CreatureRegistry
+    {
+    public:
+        static constexpr uint32_t BlockBits = 10;
+        static constexpr uint32_t BlockSize = 1u << BlockBits;
+        static constexpr uint32_t MaxBlocks = 1024;
+
+        [[nodiscard]] static CreatureHandle Register(Creature* creature);
+        static void Release(CreatureHandle handle) noexcept;
+
+        [[nodiscard]] static Creature* Resolve(CreatureHandle handle) noexcept
+        {
+            if (handle.slot_index >= MaxBlocks * BlockSize)
+                return nullptr;
+
+            const Block* block = blocks[handle.slot_index >> BlockBits].load(std::memory_order_acquire);
+            if (not block)
+                return nullptr;
+
+            // pointer first: if the slot gets released and taken over in between, the generation no longer matches
+            const Slot& slot = (*block)[handle.slot_index & (BlockSize - 1)];
+            Creature* creature = slot.creature.load(std::memory_order_acquire);
+            if (slot.generation.load(std::memory_order_acquire) != handle.generation)
+                return nullptr;
+
+            return creature;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<Creature*> creature{ nullptr };
+            std::atomic<uint32_t> generation{ 0 };
+        };
+
+        using Block = std::array<Slot, BlockSize>;
+
+        static inline std::array<std::atomic<Block*>, MaxBlocks> blocks{};
+    };
+
+    // What a Lua accessor gets for a const creature argument: a plain pointer resolved from the
+    // handle, no reference count taken. Only for calls that can't remove the creature, anything that
+    // may run game logic or other scripts takes a shared_ptr instead.
+    template <typename T>
+    class CreatureView
+    {
+    public:
+        using element_type = T;
+
+        CreatureView() = default;
+        explicit CreatureView(T* creature) noexcept : creature(creature) {}
+
+        [[nodiscard]] T* get() const noexcept { return creature; }
+        T* operator->() const noexcept { return creature; }
+        T& operator*() const noexcept { return *creature; }
+        explicit operator bool() const noexcept { return creature != nullptr; }
+
+        bool operator==(std::nullptr_t) const noexcept { return creature == nullptr; }
+        template <typename U>
+        bool operator==(const CreatureView<U>& other) const noexcept { return creature == other.get(); }
+        template <typename U>
+        bool operator==(const std::shared_ptr<U>& other) const noexcept { return creature == other.get(); }
+
+        template <typename U>
+        operator std::shared_ptr<U>() const
+        {
+            if (not creature)
+                return nullptr;
+            return std::static_pointer_cast<T>(creature->weak_from_this().lock());
+        }
+
+    private:
+        T* creature = nullptr;
+    };
+}
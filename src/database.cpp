@@ -227,6 +227,11 @@ DBInsert::DBInsert(std::string query) : query(std::move(query))
 	this->length = this->query.length();
 }
 
+DBInsert::DBInsert(std::string query, std::vector<std::string>& sink) : query(std::move(query)), sink(&sink)
+{
+	this->length = this->query.length();
+}
+
 bool DBInsert::addRow(const std::string& row)
 {
 	// adds new row to buffer
@@ -264,6 +269,13 @@ bool DBInsert::execute()
 		return true;
 	}
 
+	if (sink) {
+		sink->push_back(query + values);
+		values.clear();
+		length = query.length();
+		return true;
+	}
+
 	// executes buffer
 	bool res = Database::getInstance().executeQuery(query + values);
 	values.clear();
@@ -8,6 +8,7 @@
 
 #include <mysql/mysql.h>
 #include <span>
+#include <vector>
 
 class DBResult;
 using DBResult_ptr = std::shared_ptr<DBResult>;
@@ -170,6 +171,8 @@ class DBInsert
 {
 	public:
 		explicit DBInsert(std::string query);
+		// collects the statements in `sink` instead of executing them, to be run later or elsewhere
+		DBInsert(std::string query, std::vector<std::string>& sink);
 		bool addRow(const std::string& row);
 		bool addRow(std::ostringstream& row);
 		bool execute();
@@ -178,16 +181,18 @@ class DBInsert
 		std::string query;
 		std::string values;
 		size_t length;
+		std::vector<std::string>* sink = nullptr;
 };
 
 class DBTransaction
 {
 	public:
-		constexpr DBTransaction() = default;
+		DBTransaction() : db(Database::getInstance()) {}
+		explicit DBTransaction(Database& db) : db(db) {}
 
 		~DBTransaction() {
 			if (state == STATE_START) {
-				Database::getInstance().rollback();
+				db.rollback();
 			}
 		}
 
@@ -197,7 +202,7 @@ class DBTransaction
 
 		bool begin() {
 			state = STATE_START;
-			return Database::getInstance().beginTransaction();
+			return db.beginTransaction();
 		}
 
 		bool commit() {
@@ -206,7 +211,7 @@ class DBTransaction
 			}
 
 			state = STATE_COMMIT;
-			return Database::getInstance().commit();
+			return db.commit();
 		}
 
 	private:
@@ -216,6 +221,7 @@ class DBTransaction
 			STATE_COMMIT,
 		};
 
+		Database& db;
 		TransactionStates_t state = STATE_NO_START;
 };
 
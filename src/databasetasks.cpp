@@ -4,56 +4,137 @@
 #include "otpch.h"
 
 #include "databasetasks.h"
+#include "configmanager.h"
 #include "tasks.h"
 
+extern ConfigManager g_config;
 extern Dispatcher g_dispatcher;
 
 void DatabaseTasks::start()
 {
-	db.connect();
+	const size_t workerCount = std::max<int32_t>(1, g_config.GetNumber(ConfigManager::DATABASE_WORKERS));
+	workers.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; ++i) {
+		auto& worker = workers.emplace_back(std::make_unique<Worker>());
+		worker->db.connect();
+	}
+
+	// the first worker runs on the ThreadHolder thread
 	ThreadHolder::start();
+	for (size_t i = 1; i < workerCount; ++i) {
+		workers[i]->thread = std::thread(&DatabaseTasks::workerMain, this, std::ref(*workers[i]));
+	}
+}
+
+void DatabaseTasks::join()
+{
+	ThreadHolder::join();
+	for (auto& worker : workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
 }
 
 void DatabaseTasks::threadMain()
 {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
+	workerMain(*workers.front());
+}
+
+std::deque<DatabaseTask>* DatabaseTasks::nextQueue(Worker& worker)
+{
+	if (!priorityTasks.empty()) {
+		return &priorityTasks;
+	}
+
+	if (!worker.tasks.empty()) {
+		return &worker.tasks;
+	}
+
+	if (!sharedTasks.empty()) {
+		return &sharedTasks;
+	}
+	return nullptr;
+}
+
+void DatabaseTasks::workerMain(Worker& worker)
+{
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	while (true) {
+		auto queue = nextQueue(worker);
+		if (!queue) {
+			// terminated workers leave once nothing is left for them
+			if (getState() == THREAD_STATE_TERMINATED) {
+				break;
+			}
+
 			taskSignal.wait(taskLockUnique);
+			continue;
 		}
 
-		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
-			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
-		} else {
-			taskLockUnique.unlock();
+		DatabaseTask task = std::move(queue->front());
+		queue->pop_front();
+		++runningTasks;
+		taskLockUnique.unlock();
+
+		runTask(worker.db, task);
+
+		taskLockUnique.lock();
+		--runningTasks;
+		if (runningTasks == 0) {
+			idleSignal.notify_all();
 		}
 	}
 }
 
-void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/)
+void DatabaseTasks::enqueue(DatabaseTask&& task, uint64_t orderKey, bool priority)
 {
-	bool signal = false;
-	taskLock.lock();
-	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
-	}
-	taskLock.unlock();
+	{
+		std::lock_guard<std::mutex> lockGuard(taskLock);
+		if (getState() != THREAD_STATE_RUNNING) {
+			return;
+		}
 
-	if (signal) {
-		taskSignal.notify_one();
+		if (priority) {
+			priorityTasks.push_back(std::move(task));
+		} else if (orderKey != UNORDERED) {
+			workers[orderKey % workers.size()]->tasks.push_back(std::move(task));
+		} else {
+			sharedTasks.push_back(std::move(task));
+		}
 	}
+
+	// keyed tasks can only be taken by one of the workers, so every worker has to look
+	taskSignal.notify_all();
+}
+
+void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/, uint64_t orderKey/* = DEFAULT_ORDER_KEY*/)
+{
+	enqueue(DatabaseTask(std::move(query), std::move(callback), store), orderKey, false);
 }
 
-void DatabaseTasks::runTask(const DatabaseTask& task)
+void DatabaseTasks::addPriorityTask(std::string query, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, bool store/* = false*/)
+{
+	enqueue(DatabaseTask(std::move(query), std::move(callback), store), UNORDERED, true);
+}
+
+void DatabaseTasks::addPriorityJob(std::function<bool(Database&)> job, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/)
+{
+	enqueue(DatabaseTask(std::move(job), std::move(callback)), UNORDERED, true);
+}
+
+void DatabaseTasks::addJob(std::function<bool(Database&)> job, std::function<void(DBResult_ptr, bool)> callback/* = nullptr*/, uint64_t orderKey/* = DEFAULT_ORDER_KEY*/)
+{
+	enqueue(DatabaseTask(std::move(job), std::move(callback)), orderKey, false);
+}
+
+void DatabaseTasks::runTask(Database& db, const DatabaseTask& task)
 {
 	bool success;
 	DBResult_ptr result;
-	if (task.store) {
+	if (task.job) {
+		success = task.job(db);
+	} else if (task.store) {
 		result = db.storeQuery(task.query);
 		success = true;
 	} else {
@@ -69,13 +150,13 @@ void DatabaseTasks::runTask(const DatabaseTask& task)
 void DatabaseTasks::flush()
 {
 	std::unique_lock<std::mutex> guard{ taskLock };
-	while (!tasks.empty()) {
-		auto task = std::move(tasks.front());
-		tasks.pop_front();
-		guard.unlock();
-		runTask(task);
-		guard.lock();
-	}
+	idleSignal.wait(guard, [this]() {
+		if (runningTasks != 0 || !priorityTasks.empty() || !sharedTasks.empty()) {
+			return false;
+		}
+
+		return std::all_of(workers.begin(), workers.end(), [](const auto& worker) { return worker->tasks.empty(); });
+	});
 }
 
 void DatabaseTasks::shutdown()
@@ -83,6 +164,6 @@ void DatabaseTasks::shutdown()
 	taskLock.lock();
 	setState(THREAD_STATE_TERMINATED);
 	taskLock.unlock();
+	taskSignal.notify_all();
 	flush();
-	taskSignal.notify_one();
 }
@@ -13,31 +13,68 @@
 struct DatabaseTask {
 	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
 		query(std::move(query)), callback(std::move(callback)), store(store) {}
+	DatabaseTask(std::function<bool(Database&)>&& job, std::function<void(DBResult_ptr, bool)>&& callback) :
+		job(std::move(job)), callback(std::move(callback)), store(false) {}
 
 	std::string query;
+	// runs instead of the query when set, for work that needs several statements on the connection
+	std::function<bool(Database&)> job;
 	std::function<void(DBResult_ptr, bool)> callback;
 	bool store;
 };
 
+// Runs queries on a pool of connections, one thread each (`async_workers` in database.toml).
+//
+// Tasks that pass the same order key always run on the same connection, one after the other in the
+// order they were added; a player GUID is the usual key. Tasks without a key share DEFAULT_ORDER_KEY,
+// so they keep running in the order they were added like they did on the single connection (script
+// writes go there). Tasks passing UNORDERED go to whichever connection is free first, for reads and
+// other callers that don't care what runs before or alongside them. Priority tasks are taken before
+// any other queued task, they are meant for the few lookups someone is actively waiting on (the
+// login server's account lookup) and carry no order key.
 class DatabaseTasks : public ThreadHolder<DatabaseTasks>
 {
 	public:
+		// order key shared by everything that writes player saves in batches
+		static constexpr uint64_t PLAYER_SAVE_ORDER_KEY = std::numeric_limits<uint64_t>::max();
+		// order key of every task added without one
+		static constexpr uint64_t DEFAULT_ORDER_KEY = std::numeric_limits<uint64_t>::max() - 1;
+		// opts out of ordering, the task may run on any connection before or alongside earlier ones
+		static constexpr uint64_t UNORDERED = 0;
+
 		DatabaseTasks() = default;
 		void start();
+		void join();
+		// returns once every task queued so far has finished
 		void flush();
 		void shutdown();
 
-		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+		void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false, uint64_t orderKey = DEFAULT_ORDER_KEY);
+		void addPriorityTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+		void addPriorityJob(std::function<bool(Database&)> job, std::function<void(DBResult_ptr, bool)> callback = nullptr);
+		void addJob(std::function<bool(Database&)> job, std::function<void(DBResult_ptr, bool)> callback = nullptr, uint64_t orderKey = DEFAULT_ORDER_KEY);
 
 		void threadMain();
 	private:
-		void runTask(const DatabaseTask& task);
+		struct Worker {
+			Database db;
+			std::thread thread;
+			// tasks whose order key maps to this worker
+			std::deque<DatabaseTask> tasks;
+		};
+
+		void workerMain(Worker& worker);
+		void enqueue(DatabaseTask&& task, uint64_t orderKey, bool priority);
+		std::deque<DatabaseTask>* nextQueue(Worker& worker);
+		void runTask(Database& db, const DatabaseTask& task);
 
-		Database db;
-		std::thread thread;
-		std::deque<DatabaseTask> tasks;
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::deque<DatabaseTask> priorityTasks;
+		std::deque<DatabaseTask> sharedTasks;
+		size_t runningTasks = 0;
 		std::mutex taskLock;
 		std::condition_variable taskSignal;
+		std::condition_variable idleSignal;
 };
 
 extern DatabaseTasks g_databaseTasks;
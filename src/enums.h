@@ -620,4 +620,20 @@ enum NotifyLink {
 	LINK_NEAR,
 };
 
+// tables a player save rewrites as a whole, each as one DELETE followed by its INSERTs
+enum PlayerSaveSection : uint8_t {
+	PLAYER_SAVE_SPELLS,
+	PLAYER_SAVE_INVENTORY,
+	PLAYER_SAVE_DEPOT,
+	PLAYER_SAVE_REWARD,
+	PLAYER_SAVE_INBOX,
+	PLAYER_SAVE_STORE_INBOX,
+	PLAYER_SAVE_STORAGE,
+	PLAYER_SAVE_AUGMENTS,
+	PLAYER_SAVE_CUSTOM_SKILLS,
+	PLAYER_SAVE_CUSTOM_STATS,
+
+	PLAYER_SAVE_SECTION_COUNT
+};
+
 #endif // FS_ENUMS_H_
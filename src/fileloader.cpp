@@ -98,6 +98,8 @@ bool Loader::getProps(const Node& node, PropStream& props)
         return false;
     }
 
+    thread_local std::vector<char> propBuffer;
+
     if (static_cast<ptrdiff_t>(propBuffer.capacity()) < size)
     {
         propBuffer.reserve(static_cast<size_t>(size));
@@ -45,9 +45,10 @@ struct InvalidOTBFormat final : LoadError {
 class Loader {
 	MappedFile     fileContents;
 	Node              root;
-	std::vector<char> propBuffer;
 public:
 	Loader(const std::string& fileName, const Identifier& acceptedIdentifier);
+	// The stream points into a per-thread buffer that stays valid until the next getProps call on the
+	// same thread, so map loading workers can read nodes of one parsed tree concurrently.
 	bool getProps(const Node& node, PropStream& props);
 	const Node& parseTree();
 
@@ -112,6 +113,17 @@ class PropStream
 			return true;
 		}
 
+		// hands the next n bytes out as a stream of their own, without copying them
+		bool readStream(size_t n, PropStream& out) {
+			if (size() < n) {
+				return false;
+			}
+
+			out.init(p, n);
+			p += n;
+			return true;
+		}
+
 	private:
 		const char* p = nullptr;
 		const char* end = nullptr;
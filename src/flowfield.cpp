@@ -0,0 +1,154 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "flowfield.h"
+
+#include "map.h"
+#include "zones.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace BlackTek::World
+{
+    namespace
+    {
+        // zone flags no monster may walk into, the same set Monster::updateWalkRow blocks
+        constexpr uint32_t BlockingZoneFlags = static_cast<uint32_t>(Zones::ZoneFlag::Protection) | static_cast<uint32_t>(Zones::ZoneFlag::NoMonsters)
+            | static_cast<uint32_t>(Zones::ZoneFlag::NoWalk) | static_cast<uint32_t>(Zones::ZoneFlag::NoPathfinding);
+    }
+
+    void FlowField::Build(Map& map, const Position& targetPos)
+    {
+        target = targetPos;
+        origin_x = static_cast<int32_t>(target.x) - Radius;
+        origin_y = static_cast<int32_t>(target.y) - Radius;
+
+        walkable.fill(false);
+        distance.fill(Unreachable);
+
+        // walkability, one chunk lookup per 8x8 block of the field
+        const int32_t firstX = std::max(origin_x, 0);
+        const int32_t firstY = std::max(origin_y, 0);
+        const int32_t lastX = std::min(origin_x + Span - 1, 0xFFFF);
+        const int32_t lastY = std::min(origin_y + Span - 1, 0xFFFF);
+
+        for (int32_t blockY = firstY & ~Floor::Mask; blockY <= lastY; blockY += Floor::Size)
+        {
+            for (int32_t blockX = firstX & ~Floor::Mask; blockX <= lastX; blockX += Floor::Size)
+            {
+                const Chunk* chunk = map.getChunk(static_cast<uint16_t>(blockX), static_cast<uint16_t>(blockY));
+                if (not chunk)
+                    continue;
+
+                uint64_t blocked = chunk->block_path_mask[target.z] | chunk->block_solid_mask[target.z];
+                const auto zoneBits = Zones::ZoneManager::ChunkFlagBits(*chunk, target.z, BlockingZoneFlags);
+                if (zoneBits)
+                    blocked |= *zoneBits;
+
+                for (int32_t y = std::max(blockY, firstY); y <= std::min(blockY + Floor::Mask, lastY); ++y)
+                {
+                    for (int32_t x = std::max(blockX, firstX); x <= std::min(blockX + Floor::Mask, lastX); ++x)
+                    {
+                        const uint32_t bitIndex = (y & Floor::Mask) * Floor::Size + (x & Floor::Mask);
+                        if ((blocked >> bitIndex) & 1u)
+                            continue;
+
+                        const auto& tile = map.getTileInChunk(chunk, static_cast<uint16_t>(x), static_cast<uint16_t>(y), target.z);
+                        if (not tile or not tile->getGround() or tile->hasFlag(TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT) or tile->isHouseTile())
+                            continue;
+
+                        // flags not stamped into the chunks yet, see ZoneManager::ChunkFlagBits
+                        if (not zoneBits and (Zones::ZoneManager::GetWorldFlags(tile->getPosition()) & BlockingZoneFlags) != 0)
+                            continue;
+
+                        walkable[(y - origin_y) * Span + (x - origin_x)] = true;
+                    }
+                }
+            }
+        }
+
+        // Dijkstra from the target outwards with the same step costs A* uses. The target tile is the seed
+        // even though it is occupied (and maybe not walkable for anyone else).
+        static constexpr int32_t offsets[8][2] = {
+            {-1, 0}, {0, 1}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}, {-1, 1}
+        };
+
+        const auto byDistance = [](const auto& a, const auto& b) { return a.first > b.first; };
+
+        open.clear();
+        const uint16_t seed = static_cast<uint16_t>(Radius * Span + Radius);
+        distance[seed] = 0;
+        open.emplace_back(0, seed);
+
+        while (not open.empty())
+        {
+            std::ranges::pop_heap(open, byDistance);
+            const auto [nodeDistance, node] = open.back();
+            open.pop_back();
+
+            if (nodeDistance != distance[node])
+                continue;
+
+            const int32_t nodeX = node % Span;
+            const int32_t nodeY = node / Span;
+
+            for (int32_t i = 0; i < 8; ++i)
+            {
+                const int32_t x = nodeX + offsets[i][0];
+                const int32_t y = nodeY + offsets[i][1];
+                if (x < 0 or y < 0 or x >= Span or y >= Span)
+                    continue;
+
+                const uint16_t neighbor = static_cast<uint16_t>(y * Span + x);
+                if (not walkable[neighbor])
+                    continue;
+
+                const uint32_t cost = nodeDistance + (i < 4 ? MAP_NORMALWALKCOST : MAP_DIAGONALWALKCOST);
+                if (cost >= distance[neighbor])
+                    continue;
+
+                distance[neighbor] = static_cast<uint16_t>(cost);
+                open.emplace_back(cost, neighbor);
+                std::ranges::push_heap(open, byDistance);
+            }
+        }
+    }
+
+    const FlowField& FlowFieldCache::Get(Map& map, const uint32_t targetId, const Position& targetPos, const int64_t tick)
+    {
+        if (tick != current_tick)
+        {
+            entry_count = 0;
+            current_tick = tick;
+        }
+
+        for (size_t i = 0; i < entry_count; ++i)
+        {
+            const auto& entry = *entries[i];
+            if (entry.target_id == targetId and entry.field.Target() == targetPos)
+                return entry.field;
+        }
+
+        if (entry_count == entries.size())
+            entries.push_back(std::make_unique<Entry>());
+
+        auto& entry = *entries[entry_count++];
+        entry.target_id = targetId;
+
+        const auto start = std::chrono::steady_clock::now();
+        entry.field.Build(map, targetPos);
+        stats.buildNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        ++stats.builds;
+
+        return entry.field;
+    }
+
+    void FlowFieldCache::Clear()
+    {
+        entry_count = 0;
+        current_tick = -1;
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "position.h"
+
+class Map;
+
+namespace BlackTek::World
+{
+    // Walking distance from every tile around a target to the target itself, built once with Dijkstra and
+    // then sampled by any number of followers. Only the static walkability is part of it: the chunk
+    // block_path_mask/block_solid_mask bitmaps, missing ground and tiles no monster may enter (protection,
+    // no-monster, no-walk and no-pathfinding zones, houses, floor changes, teleports). Creatures are not, a
+    // follower still checks every tile it steps on.
+    class FlowField
+    {
+    public:
+        static constexpr int32_t Radius = 24;
+        static constexpr int32_t Span = Radius * 2 + 1;
+        static constexpr uint16_t Unreachable = 0xFFFF;
+
+        void Build(Map& map, const Position& target);
+
+        [[nodiscard]] const Position& Target() const { return target; }
+
+        // Unreachable for blocked tiles and anything outside of the field
+        [[nodiscard]] uint16_t DistanceAt(int32_t x, int32_t y) const
+        {
+            const int32_t localX = x - origin_x;
+            const int32_t localY = y - origin_y;
+            if (localX < 0 or localY < 0 or localX >= Span or localY >= Span)
+                return Unreachable;
+
+            return distance[localY * Span + localX];
+        }
+
+    private:
+        Position target;
+        int32_t origin_x = 0;
+        int32_t origin_y = 0;
+        std::array<uint16_t, Span * Span> distance{};
+        std::array<bool, Span * Span> walkable{};
+        std::vector<std::pair<uint32_t, uint16_t>> open;
+    };
+
+    struct FlowFieldStats
+    {
+        uint64_t builds = 0;
+        // follow paths taken from a field / handed back to A*
+        uint64_t paths = 0;
+        uint64_t fallbacks = 0;
+        int64_t buildNanos = 0;
+    };
+
+    // One field per followed creature and position, kept for the creature think interval it was built in.
+    class FlowFieldCache
+    {
+    public:
+        const FlowField& Get(Map& map, uint32_t targetId, const Position& targetPos, int64_t tick);
+        void Clear();
+
+        FlowFieldStats stats;
+
+    private:
+        struct Entry
+        {
+            uint32_t target_id = 0;
+            FlowField field;
+        };
+
+        // entries are kept (and their fields reused) across ticks, only the first entry_count are current
+        std::vector<std::unique_ptr<Entry>> entries;
+        size_t entry_count = 0;
+        int64_t current_tick = -1;
+    };
+}
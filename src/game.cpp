@@ -12,6 +12,7 @@
 #include "creature.h"
 #include "creatureevent.h"
 #include "databasetasks.h"
+#include "pathworkers.h"
 #include "events.h"
 #include "game.h"
 #include "creaturecontainer.h"
@@ -71,6 +72,9 @@ std::pmr::pool_options MakePoolOptions(const ObjectPools::PoolParams& p) noexcep
     return { p.max_chunks, p.block_size };
 }
 
+// players written per database transaction by saveGameState
+constexpr size_t PLAYER_SAVE_BATCH_SIZE = 50;
+
 } // namespace
 
 Game::Game()
@@ -187,6 +191,7 @@ void Game::setGameState(GameState_t newState)
 
 			g_scheduler.stop();
 			g_databaseTasks.stop();
+			g_pathWorkers.stop();
 			g_dispatcher.stop();
 			g_utility_boss.stop();
 			break;
@@ -224,14 +229,70 @@ void Game::saveGameState()
 	if (not saveAccountStorageValues())
 		BlackTek::Console::Error("Failed to save account - level storage values.");
 
+	// Players are rendered to SQL here and written in batches by a database worker, one batch
+	// after the other, so the dispatcher only pays for the serialization.
+	const auto snapshotStart = std::chrono::steady_clock::now();
+
+	std::vector<PlayerSaveSnapshot> snapshots;
+	snapshots.reserve(players.size());
 	for (const auto& it : players)
 	{
 		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
+		if (not IOLoginData::snapshotPlayer(it.second, snapshots.emplace_back()))
+		{
+			BlackTek::Console::Error("Failed to save player: {}", it.second->getName());
+			snapshots.pop_back();
+		}
+	}
+
+	struct SaveProgress
+	{
+		PlayerSaveStats stats;
+		std::atomic<int64_t> databaseTime = 0;
+		uint32_t finishedBatches = 0;
+	};
+
+	auto progress = std::make_shared<SaveProgress>();
+	progress->stats.playerCount = snapshots.size();
+	progress->stats.batchCount = (snapshots.size() + PLAYER_SAVE_BATCH_SIZE - 1) / PLAYER_SAVE_BATCH_SIZE;
+	progress->stats.snapshotTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - snapshotStart).count();
+
+	for (size_t first = 0; first < snapshots.size(); first += PLAYER_SAVE_BATCH_SIZE)
+	{
+		const size_t last = std::min(first + PLAYER_SAVE_BATCH_SIZE, snapshots.size());
+		auto batch = std::make_shared<std::vector<PlayerSaveSnapshot>>(std::make_move_iterator(snapshots.begin() + first), std::make_move_iterator(snapshots.begin() + last));
+
+		g_databaseTasks.addJob([batch, progress](Database& db) {
+			const auto start = std::chrono::steady_clock::now();
+			const bool success = IOLoginData::writePlayerSnapshots(db, *batch);
+			progress->databaseTime += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+			return success;
+		}, [this, batch, progress](DBResult_ptr, bool success) {
+			for (const auto& snapshot : *batch)
+			{
+				if (const auto player = snapshot.player.lock())
+					IOLoginData::finishPlayerSave(player, snapshot);
+			}
+
+			if (not success)
+				++progress->stats.failedBatchCount;
+
+			if (++progress->finishedBatches != progress->stats.batchCount)
+				return;
+
+			progress->stats.databaseTime = progress->databaseTime;
+			lastPlayerSaveStats = progress->stats;
+			BlackTek::Console::Print("Saved {} players: snapshot {}ms, database {}ms ({} batches, {} failed)",
+				lastPlayerSaveStats.playerCount, lastPlayerSaveStats.snapshotTime, lastPlayerSaveStats.databaseTime,
+				lastPlayerSaveStats.batchCount, lastPlayerSaveStats.failedBatchCount);
+		}, DatabaseTasks::PLAYER_SAVE_ORDER_KEY);
 	}
 
 	Map::save();
-	g_databaseTasks.flush();
+
+	// nothing may be left queued when the database thread is about to stop
+	if (gameState == GAME_STATE_SHUTDOWN)
+		g_databaseTasks.flush();
 
 	if (gameState == GAME_STATE_MAINTAIN)
 		setGameState(GAME_STATE_NORMAL);
@@ -634,6 +695,9 @@ bool Game::placeCreature(CreaturePtr creature, const Position& pos, bool extende
 			static_cast<Monster*>(c.get())->setIdle(false);
 	}
 
+	if (creature->getCreatureSubType() == CreatureSubType::Player)
+		map.wakeMonstersNear(creature->getPosition());
+
 	if (const auto tile = creature->getTile())
 	{
 		tile->notifyCreatureAdded(creature, nullptr, spectators_span);
@@ -5960,13 +6024,17 @@ void Game::playerWhisper(const PlayerPtr& player, const std::string& text)
 	              Map::maxClientViewportX, Map::maxClientViewportX,
 	              Map::maxClientViewportY, Map::maxClientViewportY);
 
+	NetworkMessage nearbyMsg, distantMsg;
+	ProtocolGame::AddCreatureSay(nearbyMsg, player, TALKTYPE_WHISPER, text, player->getPosition());
+	ProtocolGame::AddCreatureSay(distantMsg, player, TALKTYPE_WHISPER, "pspsps", player->getPosition());
+
 	//send to client + trigger event callback
 	for (const auto& c : spectators.players()) {
-		const auto spectatorPlayer = std::static_pointer_cast<Player>(c);
+		auto* spectatorPlayer = static_cast<Player*>(c.get());
 		if (!Position::areInRange<1, 1>(player->getPosition(), spectatorPlayer->getPosition())) {
-			spectatorPlayer->sendCreatureSay(player, TALKTYPE_WHISPER, "pspsps");
+			spectatorPlayer->writeToOutputBuffer(distantMsg);
 		} else {
-			spectatorPlayer->sendCreatureSay(player, TALKTYPE_WHISPER, text);
+			spectatorPlayer->writeToOutputBuffer(nearbyMsg);
 		}
 	}
 	for (const auto& spectator : spectators) {
@@ -6131,11 +6199,12 @@ bool Game::internalCreatureSay(const CreaturePtr& creature, const SpeakClasses t
 		return not ghostMode or player->canSeeCreature(creature);
 	};
 
-	for (auto player : spectators.players()
-		| std::views::filter(can_see_interaction)
-		| std::views::transform([](auto& c) { return std::static_pointer_cast<Player>(c); }))
+	NetworkMessage msg;
+	ProtocolGame::AddCreatureSay(msg, creature, type, text, *pos);
+
+	for (const auto& spectator : spectators.players() | std::views::filter(can_see_interaction))
 	{
-		player->sendCreatureSay(creature, type, text, pos);
+		static_cast<Player*>(spectator.get())->writeToOutputBuffer(msg);
 	}
 	if (not echo)
 	{
@@ -6240,60 +6309,121 @@ void Game::playerParryCounter(const uint32_t playerId, const uint32_t attackerId
 
 void Game::addCreatureCheck(const CreaturePtr& creature) noexcept
 {
-    auto c_check = creature->creatureCheck;
-    auto v_check = creature->inCheckCreaturesVector;
-    auto reinit = (not c_check and not v_check);
-    creature->creatureCheck = true;
+    think_wheel.Schedule(creature);
+}
 
-    if (creature->inCheckCreaturesVector)
-    {
-        return;
-    }
+void Game::removeCreatureCheck(const CreaturePtr& creature) noexcept
+{
+    g_game.think_wheel.Unschedule(*creature);
+}
 
-    creature->inCheckCreaturesVector = true;
+void Game::holdCreatureThink(Creature& creature, const uint32_t turns) noexcept
+{
+    think_wheel.HoldThink(creature, turns);
+}
 
-	if (reinit)
-    {
-        slots_[uniform_random(0, MaxCreatureThinkSlots - 1)].push_back(creature);
-    }
-    else
-    {
-        slots_[(current_slot_ + 1) % MaxCreatureThinkSlots].push_back(creature);
-    }
+void Game::setCreatureAttacking(Creature& creature, const bool attacking) noexcept
+{
+    think_wheel.SetAttacking(creature, attacking);
 }
 
-void Game::removeCreatureCheck(const CreaturePtr& creature) noexcept
+void Game::updateCreatureConditionDeadline(Creature& creature) noexcept
 {
-    if (creature->inCheckCreaturesVector)
-    {
-        creature->creatureCheck = false;
-    }
+    think_wheel.SetConditionDeadline(creature, creature.getConditionDeadline());
+}
+
+uint32_t Game::settleCreatureConditions(Creature& creature) noexcept
+{
+    return think_wheel.SettleConditions(creature);
 }
 
 void Game::creature_think_cycle() noexcept
 {
-    auto& checkCreatureList = slots_[current_slot_];
-    current_slot_ = (current_slot_ + 1) % MaxCreatureThinkSlots;
-	auto valid_creatures = checkCreatureList
-		| std::views::filter([](const auto& creature) { return creature and creature->creatureCheck; })
-		| std::views::filter([](const auto& creature) { return creature->getHealth() > 0; });
+    using Due = BlackTek::ThinkWheel::Due;
+
+    const int64_t now = OTSYS_TIME();
+    think_wheel.Cycle(now, [this, now](Creature& creature, const uint8_t due, const uint32_t thinkTurns, uint32_t conditionTurns) {
+        if (creature.getHealth() <= 0)
+            return;
+
+        if (due & Due::Think)
+        {
+            creature.onThink(thinkTurns * EVENT_CREATURE_THINK_INTERVAL);
+            think_wheel.HoldThink(creature, creature.getThinkHold());
+        }
+
+        // a target picked in onThink is attacked right away
+        if (due & (Due::Think | Due::Attack))
+            creature.onAttacking(EVENT_CREATURE_THINK_INTERVAL);
+
+        // and conditions it gave itself start counting in this think too
+        if (not (due & Due::Conditions) and creature.getConditionDeadline() <= now)
+            conditionTurns = think_wheel.ClaimConditions(creature);
+
+        if (conditionTurns > 0)
+            creature.executeConditions(conditionTurns * EVENT_CREATURE_THINK_INTERVAL);
+    });
+}
+
+void Game::runThinkBenchmark(const uint32_t creatureCount, std::string monsterName, const uint32_t turns)
+{
+    if (monsterName.empty() and not g_monsters.monsters.empty())
+        monsterName = g_monsters.monsters.begin()->first;
 
-    for (auto& creature : valid_creatures)
+    std::vector<CreaturePtr> creatures;
+    creatures.reserve(creatureCount);
+    for (uint32_t i = 0; i < creatureCount; ++i)
     {
-        creature->onThink(1000);
-        creature->onAttacking(1000);
-        creature->executeConditions(1000);
+        CreaturePtr monster = Monster::createMonster(monsterName);
+        if (not monster)
+        {
+            fmt::print("\n    Think benchmark: unknown monster \"{}\"\n\n", monsterName);
+            return;
+        }
+        creatures.push_back(std::move(monster));
     }
 
-    std::erase_if(checkCreatureList, [](const auto& creature) 
-	{
-        if (not creature->creatureCheck) 
-		{
-            creature->inCheckCreaturesVector = false;
-            return true;
+    std::array<std::list<CreaturePtr>, BlackTek::ThinkWheel::Slots> buckets;
+    BlackTek::ThinkWheel wheel;
+    for (const auto& creature : creatures)
+    {
+        buckets[uniform_random(0, BlackTek::ThinkWheel::Slots - 1)].push_back(creature);
+        wheel.Schedule(creature);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const uint32_t cycles = turns * BlackTek::ThinkWheel::Slots;
+    auto microsPerTurn = [turns](Clock::duration elapsed) {
+        return std::chrono::duration<double, std::micro>(elapsed).count() / turns;
+    };
+
+    uint64_t listDue = 0;
+    auto start = Clock::now();
+    for (uint32_t cycle = 0; cycle < cycles; ++cycle)
+    {
+        for (const auto& creature : buckets[cycle % BlackTek::ThinkWheel::Slots])
+        {
+            if (creature and creature->getHealth() > 0)
+                ++listDue;
         }
-        return false;
-    });
+    }
+    const double listMicros = microsPerTurn(Clock::now() - start);
+
+    uint64_t wheelDue = 0;
+    const int64_t now = OTSYS_TIME();
+    start = Clock::now();
+    for (uint32_t cycle = 0; cycle < cycles; ++cycle)
+    {
+        wheel.Cycle(now, [&wheelDue](Creature& creature, uint8_t, uint32_t, uint32_t) {
+            if (creature.getHealth() > 0)
+                ++wheelDue;
+        });
+    }
+    const double wheelMicros = microsPerTurn(Clock::now() - start);
+
+    fmt::print("\n    Think benchmark: {} creatures ({}), {} turns of {} cycles\n\n", creatures.size(), monsterName, turns, BlackTek::ThinkWheel::Slots);
+    fmt::print("    {:<28} {:>12.1f} us per turn, {} due\n", "list buckets", listMicros, listDue / turns);
+    fmt::print("    {:<28} {:>12.1f} us per turn, {} due {:>7.2f}x\n\n", "think wheel", wheelMicros, wheelDue / turns, listMicros / wheelMicros);
 }
 
 void Game::changeSpeed(const CreaturePtr& creature, const int32_t varSpeedDelta)
@@ -6307,8 +6437,15 @@ void Game::changeSpeed(const CreaturePtr& creature, const int32_t varSpeedDelta)
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), false, true);
 
-	for (const auto& spectator : spectators.players())
-		std::static_pointer_cast<Player>(spectator)->sendChangeSpeed(creature, creature->getStepSpeed());
+	const auto players = spectators.players();
+	if (players.empty())
+		return;
+
+	NetworkMessage msg;
+	ProtocolGame::AddCreatureSpeed(msg, creature, creature->getStepSpeed());
+
+	for (const auto& spectator : players)
+		static_cast<Player*>(spectator.get())->writeToOutputBuffer(msg);
 }
 
 void Game::internalCreatureChangeOutfit(const CreaturePtr& creature, const Outfit_t& outfit)
@@ -6325,8 +6462,22 @@ void Game::internalCreatureChangeOutfit(const CreaturePtr& creature, const Outfi
 	SpectatorVec spectators;
 	map.getSpectators(spectators, creature->getPosition(), true, true);
 
-	for (const auto& spectator : spectators.players())
-		std::static_pointer_cast<Player>(spectator)->sendCreatureChangeOutfit(creature, outfit);
+	const auto players = spectators.players();
+	if (players.empty() or creature->isRemoved())
+		return;
+
+	NetworkMessage msg;
+	ProtocolGame::AddCreatureOutfit(msg, creature, outfit);
+
+	// same visibility rules as ProtocolGame::sendCreatureOutfit
+	const Position& position = creature->getPosition();
+	for (const auto& spectator : players)
+	{
+		auto* player = static_cast<Player*>(spectator.get());
+
+		if (player->canSeeCreature(creature) and player->canSee(position))
+			player->writeToOutputBuffer(msg);
+	}
 }
 
 void Game::internalCreatureChangeVisible(const CreaturePtr& creature, bool visible)
@@ -6728,6 +6879,7 @@ void Game::shutdown()
 
 	g_scheduler.shutdown();
 	g_databaseTasks.shutdown();
+	g_pathWorkers.shutdown();
 	g_dispatcher.shutdown();
 	g_utility_boss.shutdown();
 	Zones::ZoneManager::Clear();
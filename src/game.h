@@ -20,6 +20,8 @@
 #include "wildcardtree.h"
 #include "quests.h"
 #include "console.h"
+#include "timerwheel.h"
+#include "thinkwheel.h"
 
 #include <gtl/phmap.hpp>
 #include <memory_resource>
@@ -79,11 +81,11 @@ static constexpr int32_t RANGE_REQUEST_TRADE_INTERVAL = 400;
 
 static constexpr uint32_t EquipmentDecayMaxInterval = 100;
 static constexpr uint32_t MapDecayMaxInterval = 250;
-static constexpr size_t MaxCreatureThinkSlots = 20;
 
 #include "objectpoolconfig.h"
 
 #include <coroutine>
+#include <deque>
 #include <chrono>
 #include <functional>
 #include <optional>
@@ -104,45 +106,68 @@ struct CoroTask
 // and reuse this for all the timer wheel tasks, and spawns too
 // possibly eliminate entire usage of dispatcher/scheduler for game tasks
 // only excluding possible things that can benefit to being offloaded from main loop
+//
+// Runs on the same TimerWheel as the Scheduler, in ms ticks since the queue was created.
+// Entries are recycled through a free list, so a sleeping coroutine costs no allocation
+// once the pool has warmed up.
 struct TimerQueue
 {
     using Clock = std::chrono::steady_clock;
     using TimePoint = Clock::time_point;
 
-    struct Entry
+    struct Entry : BlackTek::TimerWheelNode
 	{
-        TimePoint wake;
         std::coroutine_handle<> handle;
 
         std::function<bool()> stillValid;
-
-        bool operator>(const Entry& other) const { return wake > other.wake; }
     };
 
-    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
-
     std::optional<std::coroutine_handle<>> currentlyResuming;
 
     void add(TimePoint when, std::coroutine_handle<> handle, std::function<bool()> stillValid = nullptr)
 	{
-        queue.push({when, handle, std::move(stillValid)});
+        Entry* entry;
+        if (freeEntries.empty())
+        {
+            entry = &entries.emplace_back();
+        }
+        else
+        {
+            entry = freeEntries.back();
+            freeEntries.pop_back();
+        }
+
+        entry->handle = handle;
+        entry->stillValid = std::move(stillValid);
+        // round up, a sleeper must never wake early
+        wheel.schedule(entry, when > epoch ? static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(when - epoch).count()) : 0);
     }
 
     void tick() {
-        auto now = Clock::now();
-        while (not queue.empty() and queue.top().wake <= now)
-		{
-            auto entry = queue.top();
-            queue.pop();
-
-            if (not entry.stillValid or entry.stillValid())
+        const auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count());
+        wheel.advance(now, [this](BlackTek::TimerWheelNode* node)
+        {
+            // hand the entry back before resuming, the coroutine will most likely sleep again right away
+            auto entry = static_cast<Entry*>(node);
+            const auto handle = entry->handle;
+            auto stillValid = std::move(entry->stillValid);
+            entry->stillValid = nullptr;
+            freeEntries.push_back(entry);
+
+            if (not stillValid or stillValid())
             {
-                currentlyResuming = entry.handle;
-                entry.handle.resume();
+                currentlyResuming = handle;
+                handle.resume();
                 currentlyResuming.reset();
             }
-        }
+        });
     }
+
+private:
+    const TimePoint epoch = Clock::now();
+    BlackTek::TimerWheel wheel;
+    std::deque<Entry> entries;
+    std::vector<Entry*> freeEntries;
 };
 
 inline TimerQueue g_timer_queue;
@@ -198,6 +223,16 @@ namespace std
 }
 using DecayList = std::priority_queue<Expirable, std::vector<Expirable>, std::greater<Expirable>>;
 
+struct PlayerSaveStats
+{
+	uint32_t playerCount = 0;
+	uint32_t batchCount = 0;
+	uint32_t failedBatchCount = 0;
+	// in milliseconds; the snapshot runs on the dispatcher, the database part summed over all batches
+	int64_t snapshotTime = 0;
+	int64_t databaseTime = 0;
+};
+
 /**
   * Main Game class.
   * This class is responsible to control everything that happens
@@ -361,8 +396,15 @@ class Game
 
 		void addCreatureCheck(const CreaturePtr& creature) noexcept;
         static void removeCreatureCheck(const CreaturePtr& creature) noexcept;
+        // what a scheduled creature has due, mirrored into the think wheel
+        void holdCreatureThink(Creature& creature, uint32_t turns) noexcept;
+        void setCreatureAttacking(Creature& creature, bool attacking) noexcept;
+        void updateCreatureConditionDeadline(Creature& creature) noexcept;
+        [[nodiscard]] uint32_t settleCreatureConditions(Creature& creature) noexcept;
 
         void creature_think_cycle() noexcept;
+        // times picking the creatures due in a cycle, list buckets as creature_think_cycle used to walk them vs the think wheel
+        void runThinkBenchmark(uint32_t creatureCount, std::string monsterName, uint32_t turns = 50);
 
         void addEquippedItemDecay(Expirable entry) noexcept;
 		void addMapItemDecay(Expirable entry) noexcept;
@@ -679,6 +721,8 @@ class Game
 	public:
 		Groups groups;
 		Map map;
+		// of the last saveGameState whose batches all finished
+		PlayerSaveStats lastPlayerSaveStats{};
 		Mounts mounts;
 		Raids raids;
 		Quests quests;
@@ -748,6 +792,7 @@ class Game
 
         std::vector<std::byte>& getRawMapBlock() { return raw_map_block; }
         std::optional<std::pmr::monotonic_buffer_resource>& getMapBlock() { return map_block; }
+        std::deque<std::pmr::unsynchronized_pool_resource>& getMapLoadPools() { return map_load_pools; }
         std::pmr::unsynchronized_pool_resource& getItemPool() { return item_pool; }
 
 		void initializeSpawnPool();
@@ -763,6 +808,8 @@ class Game
 		// Todo : the entire game class's memory layout needs rearranged
         std::vector<std::byte> raw_map_block;
         std::optional<std::pmr::monotonic_buffer_resource> map_block;
+        // one arena per parallel map loading worker; tiles and items built there keep pointing into them
+        std::deque<std::pmr::unsynchronized_pool_resource> map_load_pools;
 		std::pmr::unsynchronized_pool_resource player_pool;
 		std::pmr::unsynchronized_pool_resource monster_pool;
 		std::pmr::unsynchronized_pool_resource npc_pool;
@@ -782,8 +829,7 @@ class Game
 		DecayList map_expirables;
 		DecayList equipped_expirables;
 
-		std::array<std::list<CreaturePtr>, MaxCreatureThinkSlots> slots_;
-        size_t current_slot_ = 0;
+		BlackTek::ThinkWheel think_wheel;
 
 		std::list<ItemPtr> decayItems[EVENT_DECAY_BUCKETS];
 		std::vector<TilePtr> loaded_tiles;
@@ -16,10 +16,54 @@ extern Game g_game;
 
 #include <chrono>
 #include <thread>
+#include <unordered_set>
 
 const size_t MAX_AUGMENT_DATA_SIZE = 1024 * 64; // 64 KB is the limit for BLOB
 const uint32_t MAX_AUGMENT_COUNT = 100; // Augments should not break size limit if we limit how many can go on a single player or item
 
+PlayerSaveCounters IOLoginData::saveCounters{};
+
+namespace {
+
+// Newest snapshot version per player with a save in flight. Saves of one player can be written on
+// different connections (periodic saves on DatabaseTasks, logout saves on the dispatcher), so a
+// snapshot is only written while no newer one of the same player has been taken. The entry stays
+// until every snapshot of the player is done, a newer one finishing first must not let an older
+// one that is still queued through.
+struct SaveVersions
+{
+	uint64_t latest = 0;
+	uint32_t inFlight = 0;
+};
+
+std::mutex saveVersionLock;
+std::unordered_map<uint32_t, SaveVersions> latestSaveVersions;
+uint64_t lastSaveVersion = 0;
+
+bool isSuperseded(const PlayerSaveSnapshot& snapshot)
+{
+	std::lock_guard<std::mutex> lockGuard(saveVersionLock);
+	auto it = latestSaveVersions.find(snapshot.guid);
+	return it != latestSaveVersions.end() && snapshot.version < it->second.latest;
+}
+
+struct SaveVersionRelease
+{
+	std::span<const PlayerSaveSnapshot> snapshots;
+
+	~SaveVersionRelease() {
+		std::lock_guard<std::mutex> lockGuard(saveVersionLock);
+		for (const auto& snapshot : snapshots) {
+			auto it = latestSaveVersions.find(snapshot.guid);
+			if (it != latestSaveVersions.end() && --it->second.inFlight == 0) {
+				latestSaveVersions.erase(it);
+			}
+		}
+	}
+};
+
+} // namespace
+
 
 // perfect use case for std::expected <Account, bool>
 Account IOLoginData::loadAccount(uint32_t accno)
@@ -67,10 +111,8 @@ std::string decodeSecret(const std::string_view secret)
 	return key;
 }
 
-bool IOLoginData::loginserverAuthentication(const std::string& name, const std::string& password, Account& account)
+bool IOLoginData::loginserverAuthentication(Database& db, const std::string& name, const std::string& password, Account& account)
 {
-	Database& db = Database::getInstance();
-
 	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, `name`, `password`, `secret`, `type`, `premium_ends_at` FROM `accounts` WHERE `name` = {:s}", db.escapeString(name)));
 	if (!result) {
 		return false;
@@ -540,6 +582,10 @@ bool IOLoginData::loadPlayer(const PlayerPtr& player, DBResult_ptr result, std::
 	Account acc = loadAccount(accno);
 
 	player->setGUID(result->getNumber<uint32_t>("id"));
+	{
+		std::lock_guard<std::mutex> lockGuard(saveVersionLock);
+		player->loginSaveVersion = lastSaveVersion;
+	}
 	player->name = result->getString("name");
 	player->accountNumber = accno;
 
@@ -1302,7 +1348,7 @@ bool IOLoginData::addRewardItems(uint32_t playerID, const ItemBlockList& itemLis
 }
 
 
-bool IOLoginData::savePlayer(const PlayerPtr& player)
+bool IOLoginData::snapshotPlayer(const PlayerPtr& player, PlayerSaveSnapshot& snapshot)
 {
 	if (player->getHealth() <= 0) {
 		player->changeHealth(1);
@@ -1310,14 +1356,12 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 
 	Database& db = Database::getInstance();
 
-	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", player->getGUID()));
-	if (!result) {
-		return false;
-	}
+	snapshot.guid = player->getGUID();
+	snapshot.player = player;
+	snapshot.loginQuery = fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = {:d} WHERE `id` = {:d}", player->lastLoginSaved, player->lastIP, player->getGUID());
 
-	if (result->getNumber<uint16_t>("save") == 0) {
-		return db.executeQuery(fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = {:d} WHERE `id` = {:d}", player->lastLoginSaved, player->lastIP, player->getGUID()));
-	}
+	auto& queries = snapshot.queries;
+	queries.clear();
 
 	//serialize conditions
 	PropWriteStream propWriteStream;
@@ -1413,21 +1457,18 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	query << "`blessings` = " << player->blessings.to_ulong();
 	query << " WHERE `id` = " << player->getGUID();
 
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
+	queries.push_back(query.str());
 
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
+	// Every section is rendered, but it only stays in the snapshot when its fingerprint differs
+	// from what the database holds. While another save is in flight that is not known yet.
+	const bool incremental = player->savedSectionVersion != 0 && player->pendingSaves == 0;
+	size_t firstQuery;
 
 	// learned spells
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ");
+	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name` ) VALUES ", queries);
 	for (const std::string& spellName : player->learnedInstantSpellList) {
 		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", player->getGUID(), db.escapeString(spellName)))) {
 			return false;
@@ -1437,13 +1478,13 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!spellsQuery.execute()) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_SPELLS, firstQuery, incremental);
 
 	//item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+	DBInsert itemsQuery("INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ", queries);
 
 	ItemBlockList itemList;
 	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
@@ -1455,13 +1496,13 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_INVENTORY, firstQuery, incremental);
 
 	//save depot items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+	DBInsert depotQuery("INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ", queries);
 	itemList.clear();
 
 	if (player->depotChests)
@@ -1476,13 +1517,13 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_DEPOT, firstQuery, incremental);
 
 	// save reward items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_rewarditems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_rewarditems` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert rewardQuery("INSERT INTO `player_rewarditems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+	DBInsert rewardQuery("INSERT INTO `player_rewarditems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ", queries);
 	itemList.clear();
 
 	for (auto item : player->getRewardChest()->getItemList()) {
@@ -1492,14 +1533,14 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!saveItems(player, itemList, rewardQuery, propWriteStream)) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_REWARD, firstQuery, incremental);
 
 
 	//save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+	DBInsert inboxQuery("INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ", queries);
 	itemList.clear();
 
 	for (auto item : player->getInbox()->getItemList()) {
@@ -1509,13 +1550,13 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_INBOX, firstQuery, incremental);
 
 	//save store inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert storeInboxQuery("INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ");
+	DBInsert storeInboxQuery("INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`, `augments`, `skills`, `stats`) VALUES ", queries);
 	itemList.clear();
 
 	for (auto item : player->getStoreInbox()->getItemList()) {
@@ -1525,12 +1566,12 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_STORE_INBOX, firstQuery, incremental);
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
+	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", queries);
 	player->genReservedStorageRange();
 
 	for (const auto& it : player->storageMap) {
@@ -1542,37 +1583,198 @@ bool IOLoginData::savePlayer(const PlayerPtr& player)
 	if (!storageQuery.execute()) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_STORAGE, firstQuery, incremental);
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_augments` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_augments` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert augmentQuery("INSERT INTO `player_augments` (`player_id`, `augments`) VALUES ");
+	DBInsert augmentQuery("INSERT INTO `player_augments` (`player_id`, `augments`) VALUES ", queries);
 	PropWriteStream augmentStream;
 
 	// Size check before proceeding
 	if (!saveAugments(player, augmentQuery, augmentStream)) {
 		return false;
 	}
+	finishSaveSection(player, snapshot, PLAYER_SAVE_AUGMENTS, firstQuery, incremental);
 
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_custom_skills` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_custom_skills` WHERE `player_id` = {:d}", player->getGUID()));
 
-	DBInsert skill_query("INSERT INTO `player_custom_skills` (`player_id`, `skills`) VALUES ");
+	DBInsert skill_query("INSERT INTO `player_custom_skills` (`player_id`, `skills`) VALUES ", queries);
 	PropWriteStream skills_stream;
 
 	savePlayerCustomSkills(player, skill_query, skills_stream);
+	finishSaveSection(player, snapshot, PLAYER_SAVE_CUSTOM_SKILLS, firstQuery, incremental);
 
-	DBInsert stats_query("INSERT INTO `player_custom_stats` (`player_id`, `stats`) VALUES ");
+	firstQuery = queries.size();
+	queries.push_back(fmt::format("DELETE FROM `player_custom_stats` WHERE `player_id` = {:d}", player->getGUID()));
+
+	DBInsert stats_query("INSERT INTO `player_custom_stats` (`player_id`, `stats`) VALUES ", queries);
 	PropWriteStream stats_stream;
 
 	savePlayerCustomStats(player, stats_query, stats_stream);
+	finishSaveSection(player, snapshot, PLAYER_SAVE_CUSTOM_STATS, firstQuery, incremental);
+
+	++player->pendingSaves;
+
+	// from here on, older snapshots of this player that are still queued are skipped
+	std::lock_guard<std::mutex> lockGuard(saveVersionLock);
+	snapshot.version = ++lastSaveVersion;
+	auto& versions = latestSaveVersions[snapshot.guid];
+	versions.latest = snapshot.version;
+	++versions.inFlight;
+	return true;
+}
+
+void IOLoginData::finishSaveSection(const PlayerConstPtr& player, PlayerSaveSnapshot& snapshot, PlayerSaveSection section, size_t firstQuery, bool incremental)
+{
+	auto& queries = snapshot.queries;
+	uint64_t hash = 0x9E3779B97F4A7C15ull;
+	uint64_t bytes = 0;
+	for (size_t i = firstQuery; i < queries.size(); ++i) {
+		hash = (hash ^ std::hash<std::string_view>{}(queries[i])) * 0xBF58476D1CE4E5B9ull;
+		bytes += queries[i].size();
+	}
+
+	// never 0, so a section can't match the hashes of a player that hasn't been saved yet
+	hash |= 1;
+	snapshot.sectionHashes[section] = hash;
+
+	auto& counters = saveCounters[section];
+	if (incremental && player->savedSectionHashes[section] == hash) {
+		queries.resize(firstQuery);
+		++counters.skipped;
+		counters.bytesSkipped += bytes;
+		return;
+	}
+
+	++counters.written;
+	counters.bytesWritten += bytes;
+}
+
+void IOLoginData::finishPlayerSave(const PlayerPtr& player, const PlayerSaveSnapshot& snapshot)
+{
+	// taken of an earlier session, this instance neither counted it as pending nor has its hashes
+	if (snapshot.version <= player->loginSaveVersion) {
+		return;
+	}
+
+	if (player->pendingSaves != 0) {
+		--player->pendingSaves;
+	}
+
+	// a failed or skipped save changed nothing in the database
+	if (!snapshot.written) {
+		return;
+	}
+
+	// An older save that still got written landed over a newer one, so the hashes no longer
+	// describe the database. Nothing is trusted until the next save wrote every section again.
+	if (snapshot.version <= player->savedSectionVersion) {
+		player->savedSectionHashes = {};
+		player->savedSectionVersion = 0;
+		return;
+	}
+
+	player->savedSectionHashes = snapshot.sectionHashes;
+	player->savedSectionVersion = snapshot.version;
+}
+
+std::string_view IOLoginData::getSaveSectionName(PlayerSaveSection section)
+{
+	switch (section) {
+		case PLAYER_SAVE_SPELLS: return "spells";
+		case PLAYER_SAVE_INVENTORY: return "inventory";
+		case PLAYER_SAVE_DEPOT: return "depot";
+		case PLAYER_SAVE_REWARD: return "reward";
+		case PLAYER_SAVE_INBOX: return "inbox";
+		case PLAYER_SAVE_STORE_INBOX: return "storeinbox";
+		case PLAYER_SAVE_STORAGE: return "storage";
+		case PLAYER_SAVE_AUGMENTS: return "augments";
+		case PLAYER_SAVE_CUSTOM_SKILLS: return "customskills";
+		case PLAYER_SAVE_CUSTOM_STATS: return "customstats";
+		default: return "unknown";
+	}
+}
+
+bool IOLoginData::writePlayerSnapshots(Database& db, std::span<PlayerSaveSnapshot> snapshots)
+{
+	if (snapshots.empty()) {
+		return true;
+	}
+
+	// declared before the transaction, so the versions are released after it committed or rolled back
+	SaveVersionRelease release{ snapshots };
+
+	DBTransaction transaction(db);
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	std::string ids;
+	for (const auto& snapshot : snapshots) {
+		if (!ids.empty()) {
+			ids.push_back(',');
+		}
+		ids += std::to_string(snapshot.guid);
+	}
+
+	// Locks the rows of the whole batch. A newer save of one of these players either bumped its
+	// version before the check below, or blocks on the row until this transaction is done.
+	DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id`, `save` FROM `players` WHERE `id` IN ({:s}) FOR UPDATE", ids));
+	if (!result) {
+		return false;
+	}
+
+	std::unordered_set<uint32_t> fullSave;
+	do {
+		if (result->getNumber<uint16_t>("save") != 0) {
+			fullSave.insert(result->getNumber<uint32_t>("id"));
+		}
+	} while (result->next());
 
+	std::vector<PlayerSaveSnapshot*> written;
+	for (auto& snapshot : snapshots) {
+		if (isSuperseded(snapshot)) {
+			continue;
+		}
+
+		if (!fullSave.contains(snapshot.guid)) {
+			if (!db.executeQuery(snapshot.loginQuery)) {
+				return false;
+			}
+			continue;
+		}
+
+		for (const auto& query : snapshot.queries) {
+			if (!db.executeQuery(query)) {
+				return false;
+			}
+		}
+		written.push_back(&snapshot);
+	}
+
+	if (!transaction.commit()) {
+		return false;
+	}
+
+	for (auto snapshot : written) {
+		snapshot->written = true;
+	}
+	return true;
+}
+
+bool IOLoginData::savePlayer(const PlayerPtr& player)
+{
+	PlayerSaveSnapshot snapshot;
+	if (!snapshotPlayer(player, snapshot)) {
+		return false;
+	}
 
-	//End the transaction
-	return transaction.commit();
+	const bool success = writePlayerSnapshots(Database::getInstance(), { &snapshot, 1 });
+	finishPlayerSave(player, snapshot);
+	return success;
 }
 
 std::string IOLoginData::getNameByGuid(uint32_t guid)
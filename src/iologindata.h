@@ -10,12 +10,40 @@
 
 using ItemBlockList = std::list<std::pair<int32_t, ItemPtr>>;
 
+// Everything a save of one player writes, rendered to SQL on the dispatcher so the statements can
+// run on another connection while the player keeps changing.
+struct PlayerSaveSnapshot
+{
+	uint32_t guid = 0;
+	// the instance the snapshot was taken of; after a relog the guid names another one
+	PlayerWeakPtr player;
+	uint64_t version = 0;
+	// written instead of the full save while the `save` flag of the player is off
+	std::string loginQuery;
+	std::vector<std::string> queries;
+	// fingerprints of every section, including the unchanged ones that were left out of `queries`
+	std::array<uint64_t, PLAYER_SAVE_SECTION_COUNT> sectionHashes{};
+	// set by writePlayerSnapshots once the full save is committed
+	bool written = false;
+};
+
+struct PlayerSaveSectionCounters
+{
+	uint64_t written = 0;
+	uint64_t skipped = 0;
+	uint64_t bytesWritten = 0;
+	uint64_t bytesSkipped = 0;
+};
+
+using PlayerSaveCounters = std::array<PlayerSaveSectionCounters, PLAYER_SAVE_SECTION_COUNT>;
+
 class IOLoginData
 {
 	public:
 		static Account loadAccount(uint32_t accno);
 
-		static bool loginserverAuthentication(const std::string& name, const std::string& password, Account& account);
+		// runs on a DatabaseTasks worker, only touches the connection it is given
+		static bool loginserverAuthentication(Database& db, const std::string& name, const std::string& password, Account& account);
 		static std::pair<uint32_t, uint32_t> gameworldAuthentication(std::string_view accountName, std::string_view password, std::string_view characterName, std::string_view token, uint32_t tokenTime);
 		static uint32_t getAccountIdByPlayerName(const std::string& playerName);
 		static uint32_t getAccountIdByPlayerId(uint32_t playerId);
@@ -30,6 +58,16 @@ class IOLoginData
 		static bool loadPlayerByName(const PlayerPtr& player, const std::string& name);
 		static bool loadPlayer(const PlayerPtr& player, DBResult_ptr result, std::vector<ConditionHandle>* outConditions = nullptr);
 		static bool savePlayer(const PlayerPtr& player);
+		// Renders the save to SQL. Sections whose fingerprint matches what the last finished save
+		// wrote are left out, unless another save of the player is still in flight.
+		static bool snapshotPlayer(const PlayerPtr& player, PlayerSaveSnapshot& snapshot);
+		// Writes the snapshots in one transaction on `db`, skipping those a newer save of the same
+		// player has superseded in the meantime.
+		static bool writePlayerSnapshots(Database& db, std::span<PlayerSaveSnapshot> snapshots);
+		// Dispatcher side of a snapshot that went through writePlayerSnapshots (or was dropped).
+		static void finishPlayerSave(const PlayerPtr& player, const PlayerSaveSnapshot& snapshot);
+		static const PlayerSaveCounters& getSaveCounters() { return saveCounters; }
+		static std::string_view getSaveSectionName(PlayerSaveSection section);
 		static uint32_t getGuidByName(const std::string& name);
 		static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 		static std::string getNameByGuid(uint32_t guid);
@@ -51,6 +89,10 @@ class IOLoginData
 	private:
 		using ItemMap = std::map<uint32_t, std::pair<ItemPtr, uint32_t>>;
 
+		static void finishSaveSection(const PlayerConstPtr& player, PlayerSaveSnapshot& snapshot, PlayerSaveSection section, size_t firstQuery, bool incremental);
+
+		static PlayerSaveCounters saveCounters;
+
 		static void loadItems(ItemMap& itemMap, const DBResult_ptr& result);
 		static bool saveItems(const PlayerConstPtr& player, const ItemBlockList& itemList, DBInsert& query_insert, PropWriteStream& propWriteStream);
 		static bool saveAugments(const PlayerConstPtr& player, DBInsert& query_insert, PropWriteStream& augmentStream);
@@ -5,6 +5,7 @@
 #include "iomap.h"
 #include "console.h"
 #include <fmt/format.h>
+#include <thread>
 
 /*
 	OTBM_ROOTV1
@@ -30,6 +31,196 @@
 	|--- OTBM_ITEM_DEF (not implemented)
 */
 
+// Tile areas parsed by a worker. Everything that reaches outside the tile itself (the map, decay
+// lists, unique items, the legacy zone list) is held back here and applied by the commit phase in file order.
+struct IOMap::TileAreaStage
+{
+	struct Entry
+	{
+		// set when the tile has to be built by the commit phase instead, see requiresSerialLoad
+		const OTB::Node* node = nullptr;
+		TilePtr tile;
+		uint32_t decayCount = 0;
+		uint32_t uniqueIdCount = 0;
+		bool legacyZone = false;
+	};
+
+	const OTB::Node* areaNode = nullptr;
+	uint16_t base_x = 0;
+	uint16_t base_y = 0;
+	uint8_t z = 0;
+
+	std::vector<Entry> tiles;
+	std::vector<ItemPtr> decaying;
+	Item::UniqueIdQueue uniqueIds;
+	std::vector<Zones::LegacyZoneFlagTile> legacyZoneFlagTiles;
+	std::string error;
+};
+
+// Builds one tile from its items in file order. A ground item that comes before anything else is
+// held back until the tile is created, so the tile starts out with it in place. Used by parseTile
+// and by the snapshot loader, which must place items exactly the same way.
+struct IOMap::TileBuilder
+{
+	std::pmr::polymorphic_allocator<Tile>& allocator;
+	TileAreaStage* stage;
+	TilePtr& tile;
+	uint16_t x;
+	uint16_t y;
+	uint8_t z;
+	bool isHouseTile = false;
+	ItemPtr ground = nullptr;
+
+	bool startHouseTile(Map& map, uint32_t houseId)
+	{
+		const auto house = map.houses.addHouse(houseId);
+
+		if (not house)
+			return false;
+
+		// possibly the fact that here, house tiles.. are the only tiles which don't use the dedicated "create tile" method
+		// is the reason for the doors and beds not wanting to register properly (without some hackish code in place) at startup
+		auto houseTile = std::allocate_shared<Tile>(allocator, x, y, z, house);
+		tile = houseTile;
+		house->addTile(houseTile);
+		isHouseTile = true;
+		return true;
+	}
+
+	// staged parses (workers) must not touch the decay lists, the commit phase starts their items
+	void startDecaying(const ItemPtr& item) const
+	{
+		if (stage)
+			stage->decaying.push_back(item);
+		else
+			item->startDecaying();
+	}
+
+	void place(ItemPtr item)
+	{
+		if (isHouseTile and item->isMoveable())
+		{
+			std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
+			return;
+		}
+
+		if (item->getItemCount() == 0)
+			item->setItemCount(1);
+
+		if (not tile and item->isGroundTile())
+		{
+			ground = std::move(item);
+			return;
+		}
+
+		if (not tile)
+		{
+			tile = createTile(allocator, ground, x, y, z);
+			if (ground)
+				startDecaying(ground);
+		}
+
+		tile->addItemSilently(item);
+		startDecaying(item);
+		item->setLoadedFromMap(true);
+	}
+
+	void finish()
+	{
+		if (tile)
+			return;
+
+		tile = createTile(allocator, ground, x, y, z);
+		if (ground)
+			startDecaying(ground);
+	}
+};
+
+namespace {
+
+constexpr size_t per_tile_bytes = sizeof(Tile) + 64;
+
+bool peekItemId(const OTB::Node& itemNode, uint16_t& id)
+{
+	std::array<char, sizeof(uint16_t)> raw;
+	const char* cursor = itemNode.propsBegin;
+
+	for (auto& byte : raw)
+	{
+		if (cursor >= itemNode.propsEnd)
+			return false;
+
+		if (static_cast<uint8_t>(*cursor) == OTB::Node::ESCAPE and ++cursor >= itemNode.propsEnd)
+			return false;
+
+		byte = *cursor++;
+	}
+
+	std::memcpy(&id, raw.data(), sizeof(id));
+	return true;
+}
+
+// Beds look their sleeper up in the database and register it with the game, and item types with
+// augments fire Lua item events while being created; neither may run on a worker thread.
+bool requiresSerialLoad(uint16_t itemId)
+{
+	const ItemType& it = Item::items[itemId];
+	return it.isBed() or not it.augments.empty();
+}
+
+bool requiresSerialLoad(const OTB::Node& parentNode)
+{
+	for (const auto& itemNode : parentNode.children)
+	{
+		uint16_t id;
+		if (peekItemId(itemNode, id) and requiresSerialLoad(id))
+			return true;
+
+		if (requiresSerialLoad(itemNode))
+			return true;
+	}
+	return false;
+}
+
+// House tiles register doors, beds and the tile itself with their house, so they are always built
+// by the commit phase; the same goes for any tile holding an item from requiresSerialLoad(itemId).
+// Malformed tiles are left to the worker, which reports them exactly like the sequential loader.
+bool requiresSerialLoad(OTB::Loader& loader, const OTB::Node& tileNode)
+{
+	if (tileNode.type == OTBM_HOUSETILE)
+		return true;
+
+	PropStream propStream;
+	if (not loader.getProps(tileNode, propStream) or not propStream.skip(sizeof(OTBM_Tile_coords)))
+		return false;
+
+	uint8_t attribute;
+	while (propStream.read<uint8_t>(attribute))
+	{
+		if (attribute == OTBM_ATTR_TILE_FLAGS)
+		{
+			if (not propStream.skip(sizeof(uint32_t)))
+				return false;
+		}
+		else if (attribute == OTBM_ATTR_ITEM)
+		{
+			uint16_t id;
+			if (not propStream.read<uint16_t>(id))
+				return false;
+
+			if (requiresSerialLoad(id))
+				return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return requiresSerialLoad(tileNode);
+}
+
+} // namespace
+
 TilePtr IOMap::createTile(std::pmr::polymorphic_allocator<Tile>& allocator, ItemPtr& ground, uint16_t x, uint16_t y, uint8_t z)
 {
 	if (not ground)
@@ -37,25 +228,38 @@ TilePtr IOMap::createTile(std::pmr::polymorphic_allocator<Tile>& allocator, Item
 
 	auto tile = std::allocate_shared<Tile>(allocator, x, y, z);
 	tile->addItemSilently(ground);
-	ground->startDecaying();
 	return tile;
 }
 
 
-std::expected<MapLoadStats, MapErrorCode> IOMap::loadMap(Map* map, const std::filesystem::path& fileName, std::vector<std::byte>& buffer, std::optional<std::pmr::monotonic_buffer_resource>& block)
+std::expected<MapLoadStats, MapErrorCode> IOMap::loadMap(Map* map, const std::filesystem::path& fileName, std::vector<std::byte>& buffer, std::optional<std::pmr::monotonic_buffer_resource>& block, std::deque<std::pmr::unsynchronized_pool_resource>& workerPools)
 {
 	const auto start = OTSYS_TIME();
 	using Error = MapErrorCode;
 	uint32_t map_size = 0;
 	uint32_t tile_count = 0;
+	MapLoadStats stats{};
 
 	map->otbmFilePath = fileName;
 	Item::resetLoadedItemCount();
 
+	using BlackTek::World::MapSnapshot;
+	std::optional<BlackTek::World::SnapshotKey> snapshotKey;
+
+	if (g_config.GetBoolean(ConfigManager::MAP_SNAPSHOT))
+	{
+		snapshotKey = MapSnapshot::ComputeKey(fileName);
+
+		MapSnapshot snapshot;
+		if (snapshotKey and snapshot.Open(MapSnapshot::PathFor(fileName), *snapshotKey))
+			return loadSnapshot(map, snapshot, buffer, block);
+	}
+
 	try
 	{
 		OTB::Loader loader{ fileName.string(), OTB::Identifier{{'O', 'T', 'B', 'M'}} };
 		const auto& root = loader.parseTree();
+		stats.treeTime = OTSYS_TIME() - start;
 		PropStream propStream;
 
 		if (not loader.getProps(root, propStream))
@@ -108,33 +312,53 @@ std::expected<MapLoadStats, MapErrorCode> IOMap::loadMap(Map* map, const std::fi
 			return std::unexpected(Error::DataParse);
 		}
 
+		uint32_t tile_area_count = 0;
 		for (const auto& node_data : mapNode.children)
         {
             if (node_data.type == OTBM_TILE_AREA)
+            {
                 tile_count += static_cast<uint32_t>(node_data.children.size());
+                ++tile_area_count;
+            }
         }
 
-		try
-        {
-			constexpr size_t per_tile_bytes = sizeof(Tile) + 64;
-			buffer.resize(tile_count * per_tile_bytes);
-            block.emplace(buffer.data(), buffer.size());
-		}
-        catch (std::bad_alloc&)
+		int32_t workerCount = g_config.GetNumber(ConfigManager::MAP_LOAD_THREADS);
+		if (workerCount <= 0)
+			workerCount = static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
+
+		workerCount = std::min<int32_t>(workerCount, static_cast<int32_t>(tile_area_count));
+		const bool parallel = workerCount > 1;
+
+		if (not parallel)
 		{
-			setLastErrorString("Not enough memory to load the map.");
-			return std::unexpected(Error::InvalidFormat); // make an OOM option
+			// workers allocate from their own pools instead
+			try
+			{
+				buffer.resize(tile_count * per_tile_bytes);
+				block.emplace(buffer.data(), buffer.size());
+			}
+			catch (std::bad_alloc&)
+			{
+				setLastErrorString("Not enough memory to load the map.");
+				return std::unexpected(Error::InvalidFormat); // make an OOM option
+			}
 		}
 
-        std::pmr::polymorphic_allocator<Tile> allocator(&block.value());
+		const auto parseStart = OTSYS_TIME();
+
+		if (parallel and not parseTileAreasParallel(loader, mapNode, *map, static_cast<uint32_t>(workerCount), workerPools, stats))
+			return std::unexpected(Error::TileArea);
 
 		for (const auto& mapDataNode : mapNode.children)
 		{
 			switch (mapDataNode.type)
 			{
 			case OTBM_TILE_AREA:
+				if (parallel)
+					break;
+
 				[[unlikely]]
-				if (not parseTileArea(loader, mapDataNode, *map, allocator))
+				if (not parseTileArea(loader, mapDataNode, *map, std::pmr::polymorphic_allocator<Tile>(&block.value())))
 					return std::unexpected(Error::TileArea);
 				break;
 
@@ -156,6 +380,17 @@ std::expected<MapLoadStats, MapErrorCode> IOMap::loadMap(Map* map, const std::fi
 				return std::unexpected(Error::Unknown);
 			}
 		}
+
+		if (not parallel)
+			stats.tileParseTime = OTSYS_TIME() - parseStart;
+
+		// missing or stale: bake a fresh one while the tree is still around
+		if (snapshotKey)
+		{
+			std::string snapshotError;
+			if (not MapSnapshot::Write(MapSnapshot::PathFor(fileName), *snapshotKey, loader, root, *map, snapshotError))
+				std::cout << "[Warning - IOMap::loadMap] Could not write the map snapshot: " << snapshotError << std::endl;
+		}
 	}
 	catch (const OTB::InvalidOTBFormat& err)
 	{
@@ -163,7 +398,196 @@ std::expected<MapLoadStats, MapErrorCode> IOMap::loadMap(Map* map, const std::fi
 		return std::unexpected(Error::InvalidFormat);
 	}
 
-	return MapLoadStats { (OTSYS_TIME() - start) / (1000), map_size, tile_count, Item::getLoadedItemCount() };
+	stats.time = (OTSYS_TIME() - start) / (1000);
+	stats.dimensions = map_size;
+	stats.tileCount = tile_count;
+	stats.itemCount = Item::getLoadedItemCount();
+	return stats;
+}
+
+std::expected<MapLoadStats, MapErrorCode> IOMap::loadSnapshot(Map* map, const BlackTek::World::MapSnapshot& snapshot, std::vector<std::byte>& buffer, std::optional<std::pmr::monotonic_buffer_resource>& block)
+{
+	// Open() has already checked the structure, so a failure here means the snapshot does not
+	// match the item definitions after all; the map is half built by then, so it is fatal.
+	const auto start = OTSYS_TIME();
+	using Error = MapErrorCode;
+	const auto& header = snapshot.Header();
+	MapLoadStats stats{};
+	stats.fromSnapshot = true;
+
+	auto corrupt = [this]() {
+		setLastErrorString("Map snapshot is damaged, delete it to rebuild it from the OTBM file.");
+		return std::unexpected(Error::InvalidFormat);
+	};
+
+	map->width = header.width;
+	map->height = header.height;
+	map->chunk_grid.Reserve(header.width, header.height);
+
+	PropStream meta = snapshot.Meta();
+
+	auto [spawnFile, spawnOk] = meta.readString();
+	auto [houseFile, houseOk] = meta.readString();
+	if (not spawnOk or not houseOk)
+		return corrupt();
+
+	map->spawnfile = spawnFile;
+	map->housefile = houseFile;
+
+	uint32_t count;
+	if (not meta.read(count))
+		return corrupt();
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint32_t townId;
+		OTBM_Destination_coords temple;
+		if (not meta.read(townId))
+			return corrupt();
+
+		auto [townName, ok] = meta.readString();
+		if (not ok or not meta.read(temple))
+			return corrupt();
+
+		auto town = map->towns.getTown(townId);
+		if (not town)
+		{
+			town = new Town(townId);
+			map->towns.addTown(townId, town);
+		}
+
+		town->setName(townName);
+		town->setTemplePos(Position(temple.x, temple.y, temple.z));
+	}
+
+	if (not meta.read(count))
+		return corrupt();
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		auto [name, ok] = meta.readString();
+		OTBM_Destination_coords waypoint;
+		if (not ok or not meta.read(waypoint))
+			return corrupt();
+
+		map->waypoints[std::string{ name }] = Position(waypoint.x, waypoint.y, waypoint.z);
+	}
+
+	if (not meta.read(count))
+		return corrupt();
+
+	map->legacyZoneFlagTiles.reserve(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		OTBM_Destination_coords pos;
+		Zones::LegacyZoneFlagTile legacyTile;
+		uint8_t patchable;
+		if (not meta.read(pos) or not meta.read(legacyTile.legacy_bits) or not meta.read(patchable))
+			return corrupt();
+
+		for (auto& offset : legacyTile.raw_byte_offsets)
+		{
+			uint64_t raw;
+			if (not meta.read(raw))
+				return corrupt();
+			offset = static_cast<size_t>(raw);
+		}
+
+		legacyTile.position = Position(pos.x, pos.y, pos.z);
+		legacyTile.patchable = patchable != 0;
+		map->legacyZoneFlagTiles.push_back(std::move(legacyTile));
+	}
+
+	try
+	{
+		buffer.resize(header.tileCount * per_tile_bytes);
+		block.emplace(buffer.data(), buffer.size());
+	}
+	catch (std::bad_alloc&)
+	{
+		setLastErrorString("Not enough memory to load the map.");
+		return std::unexpected(Error::InvalidFormat);
+	}
+
+	std::pmr::polymorphic_allocator<Tile> allocator(&block.value());
+	PropStream tiles = snapshot.Tiles();
+
+	for (uint32_t i = 0; i < header.tileCount; ++i)
+	{
+		uint16_t x, y, itemCount;
+		uint8_t z;
+		uint32_t houseId;
+		if (not tiles.read(x) or not tiles.read(y) or not tiles.read(z) or not tiles.read(houseId) or not tiles.read(itemCount))
+			return corrupt();
+
+		TilePtr tile;
+		TileBuilder builder{ allocator, nullptr, tile, x, y, z };
+
+		if (houseId != 0 and not builder.startHouseTile(*map, houseId))
+		{
+			setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, houseId));
+			return std::unexpected(Error::TileArea);
+		}
+
+		for (uint16_t j = 0; j < itemCount; ++j)
+		{
+			ItemPtr item;
+			if (not loadSnapshotItem(tiles, item))
+			{
+				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load an item from the map snapshot, delete it to rebuild it from the OTBM file.", x, y, z));
+				return std::unexpected(Error::TileArea);
+			}
+
+			builder.place(std::move(item));
+		}
+
+		builder.finish();
+		map->setTile(x, y, z, tile);
+	}
+
+	stats.tileParseTime = OTSYS_TIME() - start;
+	stats.time = stats.tileParseTime / 1000;
+	stats.dimensions = pack_map_size(header.width, header.height);
+	stats.tileCount = header.tileCount;
+	stats.itemCount = Item::getLoadedItemCount();
+	return stats;
+}
+
+bool IOMap::loadSnapshotItem(PropStream& stream, ItemPtr& item)
+{
+	uint32_t recordSize;
+	PropStream record;
+	if (not stream.read(recordSize) or not stream.readStream(recordSize, record))
+		return false;
+
+	uint32_t propsSize;
+	PropStream props;
+	if (not record.read(propsSize) or not record.readStream(propsSize, props))
+		return false;
+
+	item = Item::CreateItem(props);
+	if (not item or not item->unserializeAttr(props))
+		return false;
+
+	uint16_t childCount;
+	if (not record.read(childCount))
+		return false;
+
+	// like Item::unserializeItemNode, children of anything but a container are dropped
+	const auto container = item->getContainer();
+	if (not container)
+		return true;
+
+	for (uint16_t i = 0; i < childCount; ++i)
+	{
+		ItemPtr child;
+		if (not loadSnapshotItem(record, child))
+			return false;
+
+		container->addItem(child);
+		container->updateItemWeight(item, child->getWeight());
+	}
+	return true;
 }
 
 bool IOMap::parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map,	const std::filesystem::path& fileName)
@@ -272,226 +696,283 @@ bool IOMap::locateLegacyTileFlagsOffsets(const OTB::Loader& loader, const OTB::N
 	return true;
 }
 
-bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map, std::pmr::polymorphic_allocator<Tile> allocator)
+bool IOMap::parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map, std::pmr::polymorphic_allocator<Tile> allocator, TileAreaStage* stage)
 {
 	PropStream propStream;
-
-	if (not loader.getProps(tileAreaNode, propStream))
-	{
-		setLastErrorString("Invalid map node.");
-		return false;
-	}
-
 	OTBM_Destination_coords area_coord;
 
-	if (not propStream.read(area_coord))
+	if (not loader.getProps(tileAreaNode, propStream) or not propStream.read(area_coord))
 	{
-		setLastErrorString("Invalid map node.");
+		if (stage)
+			stage->error = "Invalid map node.";
+		else
+			setLastErrorString("Invalid map node.");
 		return false;
 	}
 
 	const uint16_t base_x = area_coord.x;
 	const uint16_t base_y = area_coord.y;
-	const uint16_t z = area_coord.z;
+	const uint8_t z = area_coord.z;
+
+	if (stage)
+	{
+		stage->base_x = base_x;
+		stage->base_y = base_y;
+		stage->z = z;
+		stage->tiles.reserve(tileAreaNode.children.size());
+	}
 
 	for (const auto& tileNode : tileAreaNode.children | std::views::all)
 	{
-		if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE)
+		if (stage and requiresSerialLoad(loader, tileNode))
 		{
-			setLastErrorString("Unknown tile node.");
-			return false;
+			stage->tiles.push_back({ .node = &tileNode });
+			continue;
 		}
 
-		if (not loader.getProps(tileNode, propStream))
-		{
-			setLastErrorString("Could not read node data.");
-			return false;
-		}
+		const size_t decayedBefore = stage ? stage->decaying.size() : 0;
+		const size_t uniqueIdsBefore = stage ? stage->uniqueIds.size() : 0;
+		const size_t legacyBefore = stage ? stage->legacyZoneFlagTiles.size() : 0;
 
-		OTBM_Tile_coords tile_coord;
+		TilePtr tile;
+		if (not parseTile(loader, tileNode, base_x, base_y, z, map, allocator, tile, stage))
+			return false;
 
-		if (not propStream.read(tile_coord))
+		if (stage)
 		{
-			setLastErrorString("Could not read tile position.");
-			return false;
+			stage->tiles.push_back({
+				.tile = std::move(tile),
+				.decayCount = static_cast<uint32_t>(stage->decaying.size() - decayedBefore),
+				.uniqueIdCount = static_cast<uint32_t>(stage->uniqueIds.size() - uniqueIdsBefore),
+				.legacyZone = stage->legacyZoneFlagTiles.size() != legacyBefore,
+			});
+			continue;
 		}
 
-		uint16_t x = base_x + tile_coord.x;
-		uint16_t y = base_y + tile_coord.y;
+		const Position& tilePos = tile->getPosition();
+		map.setTile(tilePos.x, tilePos.y, tilePos.z, tile);
+	}
+	return true;
+}
+
+bool IOMap::parseTile(OTB::Loader& loader, const OTB::Node& tileNode, uint16_t base_x, uint16_t base_y, uint8_t z, Map& map, std::pmr::polymorphic_allocator<Tile> allocator, TilePtr& tile, TileAreaStage* stage)
+{
+	// staged parses (workers) never see house tiles, see requiresSerialLoad, and must not touch
+	// anything shared: errors, decay registration and legacy zone tiles all go to the stage
+	auto fail = [&](std::string error) {
+		if (stage)
+			stage->error = std::move(error);
+		else
+			setLastErrorString(error);
+		return false;
+	};
+
+	PropStream propStream;
+
+	if (tileNode.type != OTBM_TILE && tileNode.type != OTBM_HOUSETILE)
+		return fail("Unknown tile node.");
+
+	if (not loader.getProps(tileNode, propStream))
+		return fail("Could not read node data.");
+
+	OTBM_Tile_coords tile_coord;
 
-		bool isHouseTile = (tileNode.type == OTBM_HOUSETILE);
-		TilePtr tile = nullptr;
-		ItemPtr ground_item = nullptr;
+	if (not propStream.read(tile_coord))
+		return fail("Could not read tile position.");
 
-		uint32_t legacyZoneBits = 0;
+	uint16_t x = base_x + tile_coord.x;
+	uint16_t y = base_y + tile_coord.y;
 
-		if (isHouseTile)
+	TileBuilder builder{ allocator, stage, tile, x, y, z };
+
+	uint32_t legacyZoneBits = 0;
+
+	if (tileNode.type == OTBM_HOUSETILE)
+	{
+		uint32_t houseId;
+		if (not propStream.read<uint32_t>(houseId))
+			return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z));
+
+		if (not builder.startHouseTile(map, houseId))
+			return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, houseId));
+	}
+
+	uint8_t attribute;
+	//read tile attributes
+	while (propStream.read<uint8_t>(attribute))
+	{
+		switch (attribute)
 		{
-			uint32_t houseId;
-			if (not propStream.read<uint32_t>(houseId))
+			case OTBM_ATTR_TILE_FLAGS:
 			{
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not read house id.", x, y, z));
-				return false;
-			}
+				uint32_t flags;
+
+				if (not propStream.read<uint32_t>(flags))
+					return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z));
+
+				constexpr uint32_t legacyZoneMask = OTBM_TILEFLAG_PROTECTIONZONE | OTBM_TILEFLAG_NOPVPZONE
+					| OTBM_TILEFLAG_PVPZONE | OTBM_TILEFLAG_NOLOGOUT;
+
+				legacyZoneBits = flags & legacyZoneMask;
+
+				if (legacyZoneBits != 0)
+				{
+					Zones::LegacyZoneFlagTile legacyTile;
+					legacyTile.position    = Position(x, y, static_cast<uint8_t>(z));
+					legacyTile.legacy_bits = legacyZoneBits;
+					legacyTile.patchable   = locateLegacyTileFlagsOffsets(loader, tileNode, builder.isHouseTile, legacyTile.raw_byte_offsets);
+					(stage ? stage->legacyZoneFlagTiles : map.legacyZoneFlagTiles).push_back(std::move(legacyTile));
+				}
 
-			const auto house = map.houses.addHouse(houseId);
+				break;
+			}
 
-			if (not house)
+			case OTBM_ATTR_ITEM:
 			{
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Could not create house id: {:d}", x, y, z, houseId));
-				return false;
+				auto item = Item::CreateItem(propStream);
+
+				if (not item)
+					return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
+
+				builder.place(std::move(item));
+				break;
 			}
-			
-			// possibly the fact that here, house tiles.. are the only tiles which don't use the dedicated "create tile" method
-			// is the reason for the doors and beds not wanting to register properly (without some hackish code in place) at startup
-			auto houseTile = std::allocate_shared<Tile>(allocator, x, y, z, house);
-			tile = houseTile;
-			house->addTile(houseTile);
+
+			default:
+				return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z));
 		}
+	}
 
-		uint8_t attribute;
-		//read tile attributes
-		while (propStream.read<uint8_t>(attribute))
-		{
-			switch (attribute)
-			{
-				case OTBM_ATTR_TILE_FLAGS:
-				{
-					uint32_t flags;
+	for (const auto& itemNode : tileNode.children | std::views::all)
+	{
+		if (itemNode.type != OTBM_ITEM)
+			return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z));
 
-					if (not propStream.read<uint32_t>(flags))
-					{
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to read tile flags.", x, y, z));
-						return false;
-					}
+		PropStream stream;
 
-					constexpr uint32_t legacyZoneMask = OTBM_TILEFLAG_PROTECTIONZONE | OTBM_TILEFLAG_NOPVPZONE
-						| OTBM_TILEFLAG_PVPZONE | OTBM_TILEFLAG_NOLOGOUT;
+		if (not loader.getProps(itemNode, stream))
+			return fail("Invalid item node.");
 
-					legacyZoneBits = flags & legacyZoneMask;
+		auto item = Item::CreateItem(stream);
 
-					if (legacyZoneBits != 0)
-					{
-						Zones::LegacyZoneFlagTile legacyTile;
-						legacyTile.position    = Position(x, y, static_cast<uint8_t>(z));
-						legacyTile.legacy_bits = legacyZoneBits;
-						legacyTile.patchable   = locateLegacyTileFlagsOffsets(loader, tileNode, isHouseTile, legacyTile.raw_byte_offsets);
-						map.legacyZoneFlagTiles.push_back(std::move(legacyTile));
-					}
+		if (not item)
+			return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
 
-					break;
-				}
+		if (not item->unserializeItemNode(loader, itemNode, stream))
+			return fail(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID()));
 
-				case OTBM_ATTR_ITEM:
-				{
-					auto item = Item::CreateItem(propStream);
+		builder.place(std::move(item));
+	}
 
-					if (not item)
-					{
-						setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
-						return false;
-					}
+	builder.finish();
+	return true;
+}
+
+bool IOMap::parseTileAreasParallel(OTB::Loader& loader, const OTB::Node& mapNode, Map& map, uint32_t workerCount, std::deque<std::pmr::unsynchronized_pool_resource>& workerPools, MapLoadStats& stats)
+{
+	std::vector<TileAreaStage> stages;
+	for (const auto& mapDataNode : mapNode.children)
+	{
+		if (mapDataNode.type == OTBM_TILE_AREA)
+			stages.emplace_back().areaNode = &mapDataNode;
+	}
+
+	// the pools outlive the load: every tile and item built by a worker stays allocated from its pool
+	const size_t firstPool = workerPools.size();
+	for (uint32_t i = 0; i < workerCount; ++i)
+		workerPools.emplace_back();
+
+	const auto parseStart = OTSYS_TIME();
+
+	// Areas are claimed in file order, and a worker only stops claiming once some area failed.
+	// Every area before the first failing one is therefore fully staged when the workers are done.
+	std::atomic<size_t> nextArea{ 0 };
+	std::atomic<bool> failed{ false };
+	{
+		std::vector<std::jthread> workers;
+		workers.reserve(workerCount);
+
+		for (uint32_t i = 0; i < workerCount; ++i)
+		{
+			workers.emplace_back([&, pool = &workerPools[firstPool + i]]() {
+				Item::setLoadResource(pool);
+				std::pmr::polymorphic_allocator<Tile> allocator(pool);
+
+				while (not failed.load(std::memory_order_relaxed))
+				{
+					const size_t index = nextArea.fetch_add(1, std::memory_order_relaxed);
+					if (index >= stages.size())
+						break;
 
-					if (isHouseTile and item->isMoveable())
+					auto& stage = stages[index];
+					Item::setUniqueIdQueue(&stage.uniqueIds);
+					try
 					{
-						std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
+						if (not parseTileArea(loader, *stage.areaNode, map, allocator, &stage))
+							failed = true;
 					}
-					else
+					catch (const std::exception& e)
 					{
-						if (item->getItemCount() == 0)
-							item->setItemCount(1);
-
-						if (tile)
-						{
-							tile->addItemSilently(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						}
-						else if (item->isGroundTile())
-						{
-							ground_item = std::move(item);
-						}
-						else
-						{
-                            tile = createTile(allocator, ground_item, x, y, z);
-							tile->addItemSilently(item);
-							item->startDecaying();
-							item->setLoadedFromMap(true);
-						}
+						stage.error = e.what();
+						failed = true;
 					}
-					break;
 				}
 
-				default:
-					setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown tile attribute.", x, y, z));
-					return false;
-			}
+				Item::setUniqueIdQueue(nullptr);
+				Item::setLoadResource(nullptr);
+			});
 		}
+	}
 
-		for (const auto& itemNode : tileNode.children | std::views::all)
-		{
-			if (itemNode.type != OTBM_ITEM)
-			{
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Unknown node type.", x, y, z));
-				return false;
-			}
-
-			PropStream stream;
+	const auto commitStart = OTSYS_TIME();
+	stats.tileParseTime = commitStart - parseStart;
+	stats.workerCount = workerCount;
 
-			if (not loader.getProps(itemNode, stream))
-			{
-				setLastErrorString("Invalid item node.");
-				return false;
-			}
+	// Commit in file order, so the map, unique items, decay lists and legacy zone tiles end up exactly
+	// as the sequential loader leaves them. The workers are gone, so their first pool is free to use here.
+	std::pmr::polymorphic_allocator<Tile> allocator(&workerPools[firstPool]);
 
-			auto item = Item::CreateItem(stream);
+	for (auto& stage : stages)
+	{
+		if (not stage.error.empty())
+		{
+			setLastErrorString(stage.error);
+			return false;
+		}
 
-			if (not item)
-			{
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to create item.", x, y, z));
-				return false;
-			}
+		auto decaying = stage.decaying.begin();
+		auto uniqueId = stage.uniqueIds.begin();
+		auto legacyZone = stage.legacyZoneFlagTiles.begin();
 
-			if (not item->unserializeItemNode(loader, itemNode, stream))
-			{
-				setLastErrorString(fmt::format("[x:{:d}, y:{:d}, z:{:d}] Failed to load item {:d}.", x, y, z, item->getID()));
-				return false;
-			}
+		for (auto& entry : stage.tiles)
+		{
+			TilePtr tile = std::move(entry.tile);
 
-			if (isHouseTile && item->isMoveable())
+			if (entry.node)
 			{
-				std::cout << "[Warning - IOMap::loadMap] Moveable item with ID: " << item->getID() << ", at position [x: " << x << ", y: " << y << ", z: " << z << "]." << std::endl;
+				++stats.serialTileCount;
+				if (not parseTile(loader, *entry.node, stage.base_x, stage.base_y, stage.z, map, allocator, tile, nullptr))
+					return false;
 			}
 			else
 			{
-				if (item->getItemCount() == 0)
-					item->setItemCount(1);
+				// registered before decaying starts, the order the sequential loader does both in
+				for (uint32_t i = 0; i < entry.uniqueIdCount; ++i, ++uniqueId)
+					uniqueId->second->setUniqueId(uniqueId->first);
 
-				if (tile)
-				{
-					tile->addItemSilently(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				}
-				else if (item->isGroundTile())
-				{
-					ground_item = std::move(item);
-				}
-				else
-				{
-					tile = createTile(allocator, ground_item, x, y, z);
-					tile->addItemSilently(item);
-					item->startDecaying();
-					item->setLoadedFromMap(true);
-				}
-			}
-		}
+				for (uint32_t i = 0; i < entry.decayCount; ++i, ++decaying)
+					(*decaying)->startDecaying();
 
-		if (not tile)
-			tile = createTile(allocator, ground_item, x, y, z);
+				if (entry.legacyZone)
+					map.legacyZoneFlagTiles.push_back(std::move(*legacyZone++));
+			}
 
-		map.setTile(x, y, z, tile);
+			const Position& tilePos = tile->getPosition();
+			map.setTile(tilePos.x, tilePos.y, tilePos.z, tile);
+		}
 	}
+
+	stats.commitTime = OTSYS_TIME() - commitStart;
 	return true;
 }
 
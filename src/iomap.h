@@ -8,9 +8,11 @@
 #include "map.h"
 #include "house.h"
 #include "configmanager.h"
+#include "mapsnapshot.h"
 #include <expected>
 #include <memory_resource>
 #include <array>
+#include <deque>
 
 extern ConfigManager g_config;
 
@@ -121,20 +123,12 @@ constexpr uint16_t unpack_y(uint32_t packed) noexcept
     return static_cast<uint16_t>(packed & 0xFFFF);
 }
 
-struct MapLoadStats
-{
-	int64_t time;
-	uint32_t dimensions;
-	uint32_t tileCount;
-	uint64_t itemCount;
-};
-
 class IOMap
 {
     static TilePtr createTile(std::pmr::polymorphic_allocator<Tile>& allocator, ItemPtr& ground, uint16_t x, uint16_t y, uint8_t z);
 
 	public:
-        std::expected<MapLoadStats, MapErrorCode> loadMap(Map* map, const std::filesystem::path& fileName, std::vector<std::byte>& buffer, std::optional<std::pmr::monotonic_buffer_resource>& block);
+        std::expected<MapLoadStats, MapErrorCode> loadMap(Map* map, const std::filesystem::path& fileName, std::vector<std::byte>& buffer, std::optional<std::pmr::monotonic_buffer_resource>& block, std::deque<std::pmr::unsynchronized_pool_resource>& workerPools);
 
 		static void resolveLegacySpawnFile(Map* map) {
 			if (map->spawnfile.empty()) {
@@ -169,10 +163,18 @@ class IOMap
 		}
 
 	private:
+		struct TileAreaStage;
+		struct TileBuilder;
+
 		bool parseMapDataAttributes(OTB::Loader& loader, const OTB::Node& mapNode, Map& map, const std::filesystem::path& fileName);
 		bool parseWaypoints(OTB::Loader& loader, const OTB::Node& waypointsNode, Map& map);
 		bool parseTowns(OTB::Loader& loader, const OTB::Node& townsNode, Map& map);
-        bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map, std::pmr::polymorphic_allocator<Tile> allocator);
+        bool parseTileArea(OTB::Loader& loader, const OTB::Node& tileAreaNode, Map& map, std::pmr::polymorphic_allocator<Tile> allocator, TileAreaStage* stage = nullptr);
+		bool parseTile(OTB::Loader& loader, const OTB::Node& tileNode, uint16_t base_x, uint16_t base_y, uint8_t z, Map& map, std::pmr::polymorphic_allocator<Tile> allocator, TilePtr& tile, TileAreaStage* stage);
+		bool parseTileAreasParallel(OTB::Loader& loader, const OTB::Node& mapNode, Map& map, uint32_t workerCount, std::deque<std::pmr::unsynchronized_pool_resource>& workerPools, MapLoadStats& stats);
+
+		std::expected<MapLoadStats, MapErrorCode> loadSnapshot(Map* map, const BlackTek::World::MapSnapshot& snapshot, std::vector<std::byte>& buffer, std::optional<std::pmr::monotonic_buffer_resource>& block);
+		static bool loadSnapshotItem(PropStream& stream, ItemPtr& item);
 
 		static bool locateLegacyTileFlagsOffsets(const OTB::Loader& loader, const OTB::Node& tileNode, bool isHouseTile, std::array<size_t, 4>& outOffsets);
 
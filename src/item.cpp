@@ -34,6 +34,11 @@ void handleStatsPercentDescription(std::ostringstream& s, const ItemType& it, bo
 void handleAbilitiesDescription(std::ostringstream& s, const ItemType& it, bool& begin);
 void handleMiscDescription(std::ostringstream& s, const ItemType& it, bool& begin);
 
+std::pmr::memory_resource* Item::itemResource()
+{
+	return t_loadResource ? t_loadResource : &g_game.getItemPool();
+}
+
 ItemPtr Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 {
     const ItemType& it = Item::items[type];
@@ -48,7 +53,7 @@ ItemPtr Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 	ItemPtr item;
 
 	bool allowAugments = false;
-	std::pmr::polymorphic_allocator<Item> allocator(&g_game.getItemPool());
+	std::pmr::polymorphic_allocator<Item> allocator(itemResource());
 
 	if (it.isDepot()) {
 		item = std::allocate_shared<Item>(allocator, type, count);
@@ -105,7 +110,7 @@ ItemPtr Item::CreateContainerItem(const uint16_t type, uint16_t size)
 		return nullptr;
 	}
 
-	std::pmr::polymorphic_allocator<Item> allocator(&g_game.getItemPool());
+	std::pmr::polymorphic_allocator<Item> allocator(itemResource());
 	auto newItem = std::allocate_shared<Item>(allocator, type, 0);
 	newItem->attachContainer(size, true, false, ContainerSubType::None);
 	return newItem;
@@ -2309,6 +2314,11 @@ void Item::setUniqueId(uint16_t n)
 		return;
 	}
 
+	if (t_uniqueIdQueue) {
+		t_uniqueIdQueue->emplace_back(n, getItem());
+		return;
+	}
+
 	if (g_game.addUniqueItem(n, getItem())) {
 		getAttributes()->setUniqueId(n);
 	}
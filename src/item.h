@@ -18,7 +18,9 @@
 #include <typeinfo>
 #include <boost/variant.hpp>
 #include <bitset>
+#include <atomic>
 #include <deque>
+#include <memory_resource>
 #include <gtl/phmap.hpp>
 
 class Creature;
@@ -652,6 +654,14 @@ class Item : public SharedObject
 
 		static void resetLoadedItemCount() noexcept { s_loadedItemCount = 0; }
 		static uint64_t getLoadedItemCount() noexcept { return s_loadedItemCount; }
+
+		// Parallel map loading workers build items into their own arena instead of the game item pool,
+		// which is not synchronized. nullptr restores the default for the calling thread.
+		static void setLoadResource(std::pmr::memory_resource* resource) noexcept { t_loadResource = resource; }
+		// Unique ids those workers read are queued instead of registered with the game, whose unique
+		// item map is not synchronized either; the map loader registers them in file order.
+		using UniqueIdQueue = std::vector<std::pair<uint16_t, ItemPtr>>;
+		static void setUniqueIdQueue(UniqueIdQueue* queue) noexcept { t_uniqueIdQueue = queue; }
 		static std::string getDescription(const ItemType& it, int32_t lookDistance, const ItemPtr& item = nullptr, int32_t subType = -1, bool addArticle = true);
 		static std::string getNameDescription(const ItemType& it, const ItemConstPtr& item = nullptr, int32_t subType = -1, bool addArticle = true);
 		static std::string getWeightDescription(const ItemType& it, uint32_t weight, uint32_t count = 1);
@@ -1375,7 +1385,11 @@ class Item : public SharedObject
 		ContainerPtr containerAlias;
 
 	private:
-        static inline uint64_t s_loadedItemCount = 0;
+        static inline std::atomic<uint64_t> s_loadedItemCount = 0;
+        static inline thread_local std::pmr::memory_resource* t_loadResource = nullptr;
+        static inline thread_local UniqueIdQueue* t_uniqueIdQueue = nullptr;
+
+        static std::pmr::memory_resource* itemResource();
 
         std::unique_ptr<ItemAttributes> attributes;
 		std::unique_ptr<std::vector<std::shared_ptr<BlackTek::Augment>>> augments;
@@ -147,5 +147,6 @@ class ItemContainer final
 
 		friend class ContainerIterator;
 		friend class IOMapSerialize;
+		friend class IOMap;
 		friend class Item;
 };
@@ -224,6 +224,81 @@ namespace BlackTek::Memory
         std::size_t size{ 0 };
     };
 
+    struct MPSCNode
+    {
+        std::atomic<MPSCNode*> mpsc_next{ nullptr };
+    };
+
+    // Unbounded intrusive multi-producer/single-consumer queue (Vyukov). Producers are wait-free:
+    // one exchange on the head plus one store, no CAS loop and no lock. Only the owning consumer
+    // thread may call try_pop()/empty(). Nodes are linked through MPSCNode::mpsc_next, so the
+    // queue itself never allocates; whoever pops a node owns it.
+    class MPSCQueue
+    {
+    public:
+        MPSCQueue() noexcept : head(&stub), tail(&stub) {}
+
+        MPSCQueue(const MPSCQueue&) = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        void push(MPSCNode* node) noexcept
+        {
+            node->mpsc_next.store(nullptr, std::memory_order_relaxed);
+            MPSCNode* previous = head.exchange(node, std::memory_order_seq_cst);
+            previous->mpsc_next.store(node, std::memory_order_release);
+        }
+
+        // Returns nullptr when the queue is empty, or when a producer has swapped the head but
+        // not yet linked its node; in the latter case the node becomes visible momentarily.
+        [[nodiscard]] MPSCNode* try_pop() noexcept
+        {
+            MPSCNode* current = tail;
+            MPSCNode* next = current->mpsc_next.load(std::memory_order_acquire);
+
+            if (current == &stub)
+            {
+                if (not next)
+                    return nullptr;
+
+                tail = next;
+                current = next;
+                next = next->mpsc_next.load(std::memory_order_acquire);
+            }
+
+            if (next)
+            {
+                tail = next;
+                return current;
+            }
+
+            if (current != head.load(std::memory_order_acquire))
+                return nullptr;
+
+            push(&stub);
+            next = current->mpsc_next.load(std::memory_order_acquire);
+
+            if (next)
+            {
+                tail = next;
+                return current;
+            }
+
+            return nullptr;
+        }
+
+        // True only when no producer has published (or started publishing) anything the consumer
+        // hasn't popped. Whenever tail is not the stub it points at a node still waiting to be popped.
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return tail == &stub and head.load(std::memory_order_seq_cst) == &stub;
+        }
+
+    private:
+        alignas(CacheSlot) std::atomic<MPSCNode*> head;
+        alignas(CacheSlot) MPSCNode* tail;
+        MPSCNode stub;
+    };
+
 }
 
 template <typename T, std::size_t Capacity>
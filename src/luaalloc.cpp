@@ -0,0 +1,210 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaalloc.h"
+
+#include "configmanager.h"
+#include "lockfree.h"
+#include "luascript.h"
+
+#include <cstdlib>
+#include <cstring>
+
+extern ConfigManager g_config;
+
+namespace BlackTek::LuaAlloc
+{
+    namespace
+    {
+        constexpr std::size_t ClassCount = SizeClasses.size();
+        constexpr std::size_t LargestClass = SizeClasses.back();
+        constexpr std::size_t BlockAlign = alignof(std::max_align_t);
+        // blocks a size class keeps in the central pool before freed ones go back to operator delete
+        constexpr std::size_t PoolCapacity = 8192;
+        constexpr std::size_t MagazineCapacity = 256;
+
+        static_assert(LargestClass % 16 == 0);
+
+        // size class for every 16 byte step up to the largest class
+        constexpr auto ClassIndex = []()
+        {
+            std::array<uint8_t, LargestClass / 16 + 1> index{};
+            std::size_t sizeClass = 0;
+            for (std::size_t step = 0; step < index.size(); ++step)
+            {
+                while (SizeClasses[sizeClass] < step * 16)
+                    ++sizeClass;
+                index[step] = static_cast<uint8_t>(sizeClass);
+            }
+            return index;
+        }();
+
+        [[nodiscard]] constexpr std::size_t ClassOf(std::size_t size) noexcept
+        {
+            return ClassIndex[(size + 15) / 16];
+        }
+
+        Stats g_stats = []()
+        {
+            Stats stats;
+            for (std::size_t i = 0; i < ClassCount; ++i)
+                stats.classes[i].size = SizeClasses[i];
+            return stats;
+        }();
+
+        bool g_pooled = false;
+
+        template <std::size_t Index>
+        using ClassMagazine = Memory::ThreadLocalMagazine<SizeClasses[Index], BlockAlign, PoolCapacity, MagazineCapacity>;
+
+        template <std::size_t Index>
+        ClassMagazine<Index>& LocalMagazine() noexcept
+        {
+            thread_local ClassMagazine<Index> magazine;
+            return magazine;
+        }
+
+        template <std::size_t Index>
+        void* AllocateBlock() noexcept
+        {
+            auto& stats = g_stats.classes[Index];
+            void* block = LocalMagazine<Index>().allocate();
+            if (not block) [[unlikely]]
+            {
+                block = ::operator new(SizeClasses[Index], std::nothrow);
+                if (not block)
+                    return nullptr;
+                ++stats.fresh;
+            }
+
+            ++stats.allocations;
+            ++stats.live;
+            return block;
+        }
+
+        template <std::size_t Index>
+        void FreeBlock(void* block) noexcept
+        {
+            auto& stats = g_stats.classes[Index];
+            ++stats.frees;
+            --stats.live;
+            LocalMagazine<Index>().deallocate(block);
+        }
+
+        using AllocateFn = void* (*)() noexcept;
+        using FreeFn = void (*)(void*) noexcept;
+
+        constexpr auto Allocators = []<std::size_t... I>(std::index_sequence<I...>)
+        {
+            return std::array<AllocateFn, ClassCount>{ &AllocateBlock<I>... };
+        }(std::make_index_sequence<ClassCount>{});
+
+        constexpr auto Freers = []<std::size_t... I>(std::index_sequence<I...>)
+        {
+            return std::array<FreeFn, ClassCount>{ &FreeBlock<I>... };
+        }(std::make_index_sequence<ClassCount>{});
+
+        void Free(void* ptr, std::size_t size) noexcept
+        {
+            if (size <= LargestClass)
+            {
+                Freers[ClassOf(size)](ptr);
+                return;
+            }
+
+            ++g_stats.large_frees;
+            g_stats.large_live_bytes -= static_cast<int64_t>(size);
+            std::free(ptr);
+        }
+
+        void* Allocate(void*, void* ptr, std::size_t osize, std::size_t nsize) noexcept
+        {
+            // with ptr == nullptr osize only tells the type of the new object
+            if (not ptr)
+                osize = 0;
+
+            if (nsize == 0)
+            {
+                if (ptr)
+                    Free(ptr, osize);
+                return nullptr;
+            }
+
+            if (nsize > LargestClass and (not ptr or osize > LargestClass))
+            {
+                void* block = std::realloc(ptr, nsize);
+                if (not block)
+                    return nullptr;
+
+                if (not ptr)
+                    ++g_stats.large_allocations;
+                g_stats.large_live_bytes += static_cast<int64_t>(nsize) - static_cast<int64_t>(osize);
+                return block;
+            }
+
+            if (ptr and osize <= LargestClass and nsize <= LargestClass and ClassOf(osize) == ClassOf(nsize))
+                return ptr;
+
+            void* block;
+            if (nsize <= LargestClass)
+            {
+                block = Allocators[ClassOf(nsize)]();
+            }
+            else
+            {
+                block = std::malloc(nsize);
+                if (block)
+                {
+                    ++g_stats.large_allocations;
+                    g_stats.large_live_bytes += static_cast<int64_t>(nsize);
+                }
+            }
+
+            // Lua expects a shrinking block to never fail, a pooled one that is at least as large will
+            // do. A large block can't stand in for a pooled one, it would be handed to the wrong free.
+            if (not block)
+                return (nsize <= osize and osize <= LargestClass) ? ptr : nullptr;
+
+            if (ptr)
+            {
+                std::memcpy(block, ptr, std::min(osize, nsize));
+                Free(ptr, osize);
+            }
+            return block;
+        }
+
+        int Panic(lua_State* L)
+        {
+            const char* message = lua_tostring(L, -1);
+            Console::Error("PANIC: unprotected error in call to Lua API ({})", message ? message : "error object is not a string");
+            return 0;
+        }
+    }
+
+    lua_State* NewState()
+    {
+        g_pooled = false;
+        if (g_config.GetBoolean(ConfigManager::LUA_POOLED_ALLOCATOR))
+        {
+            if (lua_State* L = lua_newstate(Allocate, nullptr))
+            {
+                lua_atpanic(L, Panic);
+                g_pooled = true;
+                return L;
+            }
+        }
+        return luaL_newstate();
+    }
+
+    bool IsPooled() noexcept
+    {
+        return g_pooled;
+    }
+
+    const Stats& GetStats() noexcept
+    {
+        return g_stats;
+    }
+}
@@ -0,0 +1,41 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct lua_State;
+
+namespace BlackTek::LuaAlloc
+{
+    // Lua strings, tables, closures and our userdata (mostly a shared_ptr) are small, everything up
+    // to the last class comes from per class block pools, larger blocks go to realloc/free
+    inline constexpr std::array<std::size_t, 8> SizeClasses{ 16, 32, 48, 64, 96, 128, 192, 256 };
+
+    struct ClassStats
+    {
+        std::size_t size = 0;
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        // blocks that had to come from operator new because the pool was empty
+        uint64_t fresh = 0;
+        int64_t live = 0;
+    };
+
+    struct Stats
+    {
+        std::array<ClassStats, SizeClasses.size()> classes{};
+        uint64_t large_allocations = 0;
+        uint64_t large_frees = 0;
+        int64_t large_live_bytes = 0;
+    };
+
+    // A state using the pooled allocator when config/scripts.toml [allocator] pooled is set, the
+    // default one otherwise or when this Lua build doesn't take a custom allocator (LuaJIT without GC64).
+    [[nodiscard]] lua_State* NewState();
+    [[nodiscard]] bool IsPooled() noexcept;
+    [[nodiscard]] const Stats& GetStats() noexcept;
+}
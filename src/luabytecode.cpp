@@ -0,0 +1,199 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luabytecode.h"
+
+#include "configmanager.h"
+#include "luascript.h"
+
+#include <fstream>
+#include <iterator>
+
+extern ConfigManager g_config;
+
+namespace BlackTek::LuaBytecode
+{
+    namespace
+    {
+        constexpr uint32_t Magic = 0x4243544Bu; // "KTCB"
+        constexpr uint32_t FormatVersion = 1;
+
+#if defined(LUAJIT_VERSION_NUM)
+        constexpr uint32_t LuaBuild = 0x80000000u | LUAJIT_VERSION_NUM;
+#elif defined(LUA_VERSION_RELEASE_NUM)
+        constexpr uint32_t LuaBuild = LUA_VERSION_RELEASE_NUM;
+#else
+        constexpr uint32_t LuaBuild = LUA_VERSION_NUM;
+#endif
+
+        struct Header
+        {
+            uint32_t magic = Magic;
+            uint32_t format = FormatVersion;
+            uint32_t lua_build = LuaBuild;
+            uint32_t pointer_size = sizeof(void*);
+            int64_t mtime = 0;
+            uint64_t source_size = 0;
+            uint64_t source_hash = 0;
+            int64_t parse_ns = 0;
+            uint64_t bytecode_size = 0;
+        };
+
+        Stats g_stats;
+
+        [[nodiscard]] uint64_t Hash(std::string_view data) noexcept
+        {
+            // FNV-1a
+            uint64_t hash = 0xCBF29CE484222325ull;
+            for (const unsigned char c : data)
+            {
+                hash ^= c;
+                hash *= 0x100000001B3ull;
+            }
+            return hash;
+        }
+
+        [[nodiscard]] int64_t Elapsed(std::chrono::steady_clock::time_point start) noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        int Writer(lua_State*, const void* data, size_t size, void* out)
+        {
+            static_cast<std::string*>(out)->append(static_cast<const char*>(data), size);
+            return 0;
+        }
+
+        [[nodiscard]] bool ReadEntry(const std::filesystem::path& path, const Header& expected, std::string& bytecode, int64_t& parseNs)
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (not in.is_open())
+                return false;
+
+            Header header;
+            if (not in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+                return false;
+
+            if (header.magic != expected.magic or header.format != expected.format or header.lua_build != expected.lua_build
+                    or header.pointer_size != expected.pointer_size or header.mtime != expected.mtime
+                    or header.source_size != expected.source_size or header.source_hash != expected.source_hash)
+                return false;
+
+            bytecode.resize(header.bytecode_size);
+            if (not in.read(bytecode.data(), static_cast<std::streamsize>(bytecode.size())))
+                return false;
+
+            parseNs = header.parse_ns;
+            return true;
+        }
+
+        void WriteEntry(const std::filesystem::path& path, Header header, const std::string& bytecode)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+
+            // written aside and renamed, a crash halfway never leaves a truncated entry behind
+            std::filesystem::path tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                header.bytecode_size = bytecode.size();
+                if (not out.is_open() or not out.write(reinterpret_cast<const char*>(&header), sizeof(header))
+                        or not out.write(bytecode.data(), static_cast<std::streamsize>(bytecode.size())))
+                {
+                    ++g_stats.write_failures;
+                    return;
+                }
+            }
+
+            std::filesystem::rename(tmp, path, ec);
+            if (ec)
+            {
+                ++g_stats.write_failures;
+                std::filesystem::remove(tmp, ec);
+            }
+        }
+
+        int LoadSource(lua_State* L, std::string_view source, const std::string& chunkName)
+        {
+            // what luaL_loadfile skips: a UTF-8 BOM and a first line starting with '#', the newline stays for the line numbers
+            if (source.starts_with("\xEF\xBB\xBF"))
+                source.remove_prefix(3);
+            if (source.starts_with('#'))
+                source.remove_prefix(std::min(source.find('\n'), source.size()));
+
+            return luaL_loadbuffer(L, source.data(), source.size(), chunkName.c_str());
+        }
+    }
+
+    int LoadFile(lua_State* L, const std::string& file)
+    {
+        if (not g_config.GetBoolean(ConfigManager::LUA_BYTECODE_CACHE))
+            return luaL_loadfile(L, file.c_str());
+
+        std::ifstream in(file, std::ios::binary);
+        if (not in.is_open())
+            return luaL_loadfile(L, file.c_str());
+
+        const std::string source{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+        const std::string chunkName = "@" + file;
+
+        std::error_code ec;
+        const auto mtime = std::filesystem::last_write_time(file, ec);
+
+        Header header;
+        header.mtime = ec ? 0 : static_cast<int64_t>(mtime.time_since_epoch().count());
+        header.source_size = source.size();
+        header.source_hash = Hash(source);
+
+        // one entry per script path, a changed file overwrites its own entry
+        const std::filesystem::path entryPath = std::filesystem::path(g_config.GetString(ConfigManager::LUA_BYTECODE_CACHE_DIRECTORY))
+            / fmt::format("{:016x}.luac", Hash(file));
+
+        std::string bytecode;
+        int64_t parseNs = 0;
+        if (ReadEntry(entryPath, header, bytecode, parseNs))
+        {
+            const auto start = std::chrono::steady_clock::now();
+            if (luaL_loadbuffer(L, bytecode.data(), bytecode.size(), chunkName.c_str()) == 0)
+            {
+                const int64_t loadNs = Elapsed(start);
+                ++g_stats.hits;
+                g_stats.load_ns += loadNs;
+                g_stats.saved_ns += std::max<int64_t>(parseNs - loadNs, 0);
+                return 0;
+            }
+
+            // entry from another build of Lua that slipped through the header, parse and replace it
+            lua_pop(L, 1);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const int status = LoadSource(L, source, chunkName);
+        header.parse_ns = Elapsed(start);
+        ++g_stats.misses;
+        g_stats.parse_ns += header.parse_ns;
+        if (status != 0)
+            return status;
+
+        bytecode.clear();
+#if LUA_VERSION_NUM >= 503
+        const int dumped = lua_dump(L, Writer, &bytecode, 0);
+#else
+        const int dumped = lua_dump(L, Writer, &bytecode);
+#endif
+        if (dumped == 0)
+            WriteEntry(entryPath, header, bytecode);
+        else
+            ++g_stats.write_failures;
+
+        return 0;
+    }
+
+    const Stats& GetStats() noexcept
+    {
+        return g_stats;
+    }
+}
@@ -0,0 +1,32 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct lua_State;
+
+namespace BlackTek::LuaBytecode
+{
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // entries that couldn't be written, those files get parsed again next time
+        uint64_t write_failures = 0;
+        // parsing and compiling the source of missed files
+        int64_t parse_ns = 0;
+        // loading the cached chunks of hits
+        int64_t load_ns = 0;
+        // parse time of the hit files (as measured when their entry was written) minus their load time
+        int64_t saved_ns = 0;
+    };
+
+    // luaL_loadfile with the cache of config/scripts.toml [bytecode_cache] in front of it. Same
+    // result: 0 and the chunk on top of the stack, or the error status and message.
+    int LoadFile(lua_State* L, const std::string& file);
+
+    [[nodiscard]] const Stats& GetStats() noexcept;
+}
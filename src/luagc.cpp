@@ -0,0 +1,159 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luagc.h"
+
+#include "configmanager.h"
+#include "luascript.h"
+#include "tasks.h"
+#include "tools.h"
+
+extern ConfigManager g_config;
+extern LuaEnvironment g_luaEnvironment;
+
+namespace BlackTek::LuaGC
+{
+    namespace
+    {
+        Stats g_stats;
+        bool g_generational = false;
+
+        // heap size after the last cycle the idle steps finished
+        int64_t g_baseline_bytes = 0;
+        bool g_in_cycle = false;
+        bool g_requested = false;
+
+        uint64_t g_idle_cycle = 0;
+        std::chrono::steady_clock::time_point g_idle_deadline;
+
+#if LUA_VERSION_NUM >= 504
+        void SetGenerational(lua_State* L)
+        {
+            lua_gc(L, LUA_GCGEN, g_config.GetNumber(ConfigManager::LUA_GC_MINOR_MULTIPLIER), g_config.GetNumber(ConfigManager::LUA_GC_MAJOR_MULTIPLIER));
+        }
+
+        // switching is a pass over the whole heap, back to generational mode even a full mark
+        void SetIncremental(lua_State* L)
+        {
+            lua_gc(L, LUA_GCINC, g_config.GetNumber(ConfigManager::LUA_GC_PAUSE), g_config.GetNumber(ConfigManager::LUA_GC_STEP_MULTIPLIER), 0);
+        }
+#endif
+
+        bool IdleStep()
+        {
+            lua_State* L = g_luaEnvironment.getLuaState();
+            const int32_t stepKb = g_config.GetNumber(ConfigManager::LUA_GC_IDLE_STEP_KB);
+            if (not L or stepKb <= 0)
+                return false;
+
+            const auto now = std::chrono::steady_clock::now();
+            if (g_idle_cycle != g_dispatcher.getDispatcherCycle())
+            {
+                g_idle_cycle = g_dispatcher.getDispatcherCycle();
+                g_idle_deadline = now + std::chrono::microseconds(g_config.GetNumber(ConfigManager::LUA_GC_IDLE_BUDGET_US));
+            }
+
+            if (now >= g_idle_deadline)
+                return false;
+
+            // nothing to do until the heap grew by a step since the last cycle we finished
+            if (not g_requested and not g_in_cycle and HeapBytes(L) - g_baseline_bytes < int64_t{stepKb} * 1024)
+                return false;
+
+#if LUA_VERSION_NUM >= 504
+            // What a reload leaves behind (replaced closures and tables) is mostly old, and a minor
+            // collection never frees old objects. A requested cycle therefore runs incrementally, and
+            // the collector stays incremental afterwards: entering generational mode again is a full
+            // mark of the heap in one call, the very pause the idle steps are there to avoid.
+            if (g_generational and g_requested)
+            {
+                SetIncremental(L);
+                g_generational = false;
+                ++g_stats.mode_switches;
+            }
+#endif
+
+            // a generational step is a whole minor collection, it never reports the end of a cycle
+            const bool cycleDone = lua_gc(L, LUA_GCSTEP, stepKb) != 0 or g_generational;
+
+            const int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - now).count();
+            ++g_stats.idle_steps;
+            g_stats.idle_step_ns += elapsed;
+            g_stats.max_idle_step_ns = std::max(g_stats.max_idle_step_ns, elapsed);
+
+            g_in_cycle = not cycleDone;
+            if (cycleDone)
+            {
+                ++g_stats.idle_cycles;
+                g_requested = false;
+                g_baseline_bytes = HeapBytes(L);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    void Configure(lua_State* L)
+    {
+        const std::string& mode = g_config.GetString(ConfigManager::LUA_GC_MODE);
+        g_generational = false;
+
+#if LUA_VERSION_NUM >= 504
+        if (caseInsensitiveEqual(mode, "generational"))
+        {
+            SetGenerational(L);
+            g_generational = true;
+        }
+        else
+        {
+            SetIncremental(L);
+        }
+#else
+        if (caseInsensitiveEqual(mode, "generational"))
+            Console::Warn("Lua gc mode \"generational\" needs Lua 5.4, using incremental.");
+
+        lua_gc(L, LUA_GCSETPAUSE, g_config.GetNumber(ConfigManager::LUA_GC_PAUSE));
+        lua_gc(L, LUA_GCSETSTEPMUL, g_config.GetNumber(ConfigManager::LUA_GC_STEP_MULTIPLIER));
+#endif
+
+        g_in_cycle = false;
+        g_baseline_bytes = HeapBytes(L);
+    }
+
+    void Initialize()
+    {
+        g_dispatcher.setIdleHandler(IdleStep);
+    }
+
+    void RequestCycle()
+    {
+        ++g_stats.requested_cycles;
+
+        // without idle steps nobody would run it, collect right away like before
+        if (g_config.GetNumber(ConfigManager::LUA_GC_IDLE_STEP_KB) <= 0)
+        {
+            if (lua_State* L = g_luaEnvironment.getLuaState())
+                lua_gc(L, LUA_GCCOLLECT, 0);
+            return;
+        }
+
+        g_requested = true;
+    }
+
+    bool IsGenerational() noexcept
+    {
+        return g_generational;
+    }
+
+    int64_t HeapBytes(lua_State* L)
+    {
+        return static_cast<int64_t>(lua_gc(L, LUA_GCCOUNT, 0)) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    }
+
+    const Stats& GetStats() noexcept
+    {
+        return g_stats;
+    }
+}
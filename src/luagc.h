@@ -0,0 +1,36 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstdint>
+
+struct lua_State;
+
+namespace BlackTek::LuaGC
+{
+    struct Stats
+    {
+        uint64_t idle_steps = 0;
+        // cycles (or minor collections in generational mode) finished by idle steps
+        uint64_t idle_cycles = 0;
+        int64_t idle_step_ns = 0;
+        int64_t max_idle_step_ns = 0;
+        uint64_t requested_cycles = 0;
+        // generational to incremental for a requested cycle, counted in the idle step time
+        uint64_t mode_switches = 0;
+    };
+
+    // collector mode and parameters from config/scripts.toml [gc], for every newly created state
+    void Configure(lua_State* L);
+    // hooks the idle steps into the dispatcher, has to run on the dispatcher thread
+    void Initialize();
+    // Instead of a LUA_GCCOLLECT after reloads: the idle steps keep going until a full collection
+    // cycle is done. In generational mode that switches the collector to incremental for good (see
+    // IdleStep).
+    void RequestCycle();
+
+    [[nodiscard]] bool IsGenerational() noexcept;
+    [[nodiscard]] int64_t HeapBytes(lua_State* L);
+    [[nodiscard]] const Stats& GetStats() noexcept;
+}
@@ -0,0 +1,307 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaprofiler.h"
+
+#include "configmanager.h"
+#include "luaalloc.h"
+#include "luabytecode.h"
+#include "luagc.h"
+#include "luascript.h"
+#include "metrics_format.h"
+#include "scheduler.h"
+#include "tools.h"
+
+#include <gtl/phmap.hpp>
+
+#include <ctime>
+#include <fstream>
+
+extern ConfigManager g_config;
+extern LuaEnvironment g_luaEnvironment;
+
+namespace BlackTek::LuaProfiler
+{
+    namespace
+    {
+        struct Entry
+        {
+            CallbackRow row;
+            // identity the hash key was built from, a key can come back for another function after a reload
+            const LuaScriptInterface* scriptInterface = nullptr;
+            int32_t scriptId = 0;
+            bool timerEvent = false;
+            std::string source;
+        };
+
+        struct Sample
+        {
+            SampleRow row;
+            std::string source;
+        };
+
+        std::vector<Entry> g_entries;
+        gtl::flat_hash_map<uint64_t, size_t> g_entry_index;
+        gtl::flat_hash_map<uint64_t, Sample> g_samples;
+        // bumped by Reset so scopes that are still running don't write into a cleared table
+        uint32_t g_generation = 0;
+
+        [[nodiscard]] uint64_t Mix(uint64_t hash, uint64_t value) noexcept
+        {
+            hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+
+        [[nodiscard]] std::string FunctionName(const lua_Debug& ar)
+        {
+            if (ar.what and std::string_view(ar.what) == "C")
+                return "[C]";
+
+            if (ar.linedefined == 0)
+                return fmt::format("{}:main", ar.short_src);
+
+            return fmt::format("{}:{}", ar.short_src, ar.linedefined);
+        }
+
+        void SampleHook(lua_State* L, lua_Debug* ar)
+        {
+            if (not lua_getinfo(L, "S", ar) or not ar->source)
+                return;
+
+            const uint64_t key = Mix(reinterpret_cast<uintptr_t>(ar->source), static_cast<uint64_t>(ar->linedefined));
+            auto& sample = g_samples[key];
+            if (sample.source != ar->source)
+            {
+                sample.source = ar->source;
+                sample.row = { FunctionName(*ar), 0 };
+            }
+            ++sample.row.samples;
+        }
+    }
+
+    void Initialize()
+    {
+        g_enabled = g_config.GetBoolean(ConfigManager::LUA_PROFILER);
+        Attach(g_luaEnvironment.getLuaState());
+
+        const int32_t intervalMinutes = g_config.GetNumber(ConfigManager::LUA_PROFILER_DUMP_MINUTES);
+        if (intervalMinutes > 0)
+            g_scheduler.addEvent(createSchedulerTask(intervalMinutes * 60 * 1000, []() { RunRollingDump(); }));
+    }
+
+    void Attach(lua_State* L)
+    {
+        if (not L)
+            return;
+
+        const int32_t instructions = g_config.GetNumber(ConfigManager::LUA_PROFILER_SAMPLE_INSTRUCTIONS);
+        if (g_enabled and instructions > 0)
+            lua_sethook(L, SampleHook, LUA_MASKCOUNT, instructions);
+        else
+            lua_sethook(L, nullptr, 0, 0);
+    }
+
+    void SetEnabled(bool enabled)
+    {
+        g_enabled = enabled;
+        Attach(g_luaEnvironment.getLuaState());
+    }
+
+    std::vector<CallbackRow> Callbacks(SortBy sortBy, size_t limit)
+    {
+        std::vector<CallbackRow> rows;
+        rows.reserve(g_entries.size());
+        for (const auto& entry : g_entries)
+        {
+            if (entry.row.calls > 0)
+                rows.push_back(entry.row);
+        }
+
+        std::ranges::sort(rows, [sortBy](const CallbackRow& a, const CallbackRow& b)
+        {
+            switch (sortBy)
+            {
+                case SortBy::Calls: return a.calls > b.calls;
+                case SortBy::Alloc: return a.alloc_bytes > b.alloc_bytes;
+                default:            return a.total_ns > b.total_ns;
+            }
+        });
+
+        if (limit > 0 and rows.size() > limit)
+            rows.resize(limit);
+
+        return rows;
+    }
+
+    std::vector<SampleRow> Samples(size_t limit)
+    {
+        std::vector<SampleRow> rows;
+        rows.reserve(g_samples.size());
+        for (const auto& [key, sample] : g_samples)
+            rows.push_back(sample.row);
+
+        std::ranges::sort(rows, [](const SampleRow& a, const SampleRow& b) { return a.samples > b.samples; });
+
+        if (limit > 0 and rows.size() > limit)
+            rows.resize(limit);
+
+        return rows;
+    }
+
+    void Reset()
+    {
+        g_entries.clear();
+        g_entry_index.clear();
+        g_samples.clear();
+        ++g_generation;
+    }
+
+    std::string Dump()
+    {
+        const std::string& directory = g_config.GetString(ConfigManager::LUA_PROFILER_DIRECTORY);
+        const std::time_t dumpTime = static_cast<std::time_t>(OTSYS_TIME() / 1000);
+        const std::string timestamp = fmt::format("{:%Y-%m-%d_%H-%M-%S}", *std::localtime(&dumpTime));
+
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        const std::string path = directory + "/profile_" + timestamp + ".json";
+
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if (not file.is_open())
+            return {};
+
+        using Metrics::JsonEscape;
+
+        file << "{\n  \"meta\": {\"dump_time\": \"" << timestamp << "\"},\n  \"callbacks\": [\n";
+        const auto callbacks = Callbacks(SortBy::Time, 0);
+        for (size_t i = 0; i < callbacks.size(); ++i)
+        {
+            const auto& row = callbacks[i];
+            file << fmt::format("    {{\"script\":\"{}\",\"function\":\"{}\",\"event\":\"{}\",\"calls\":{},\"total_us\":{},"
+                "\"avg_us\":{:.2f},\"max_us\":{},\"alloc_bytes\":{}}}{}\n",
+                JsonEscape(row.script), JsonEscape(row.function), JsonEscape(row.event), row.calls, row.total_ns / 1000,
+                row.total_ns / 1000.0 / row.calls, row.max_ns / 1000, row.alloc_bytes, (i + 1 < callbacks.size()) ? "," : "");
+        }
+        file << "  ],\n  \"samples\": [\n";
+
+        const auto samples = Samples(0);
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            file << fmt::format("    {{\"function\":\"{}\",\"samples\":{}}}{}\n",
+                JsonEscape(samples[i].function), samples[i].samples, (i + 1 < samples.size()) ? "," : "");
+        }
+        file << "  ],\n";
+
+        const auto& gc = LuaGC::GetStats();
+        lua_State* L = g_luaEnvironment.getLuaState();
+        file << fmt::format("  \"gc\": {{\"heap_bytes\":{},\"generational\":{},\"idle_steps\":{},\"idle_cycles\":{},"
+            "\"idle_step_us\":{},\"max_idle_step_us\":{},\"requested_cycles\":{},\"mode_switches\":{}}},\n",
+            L ? LuaGC::HeapBytes(L) : 0, LuaGC::IsGenerational(), gc.idle_steps, gc.idle_cycles,
+            gc.idle_step_ns / 1000, gc.max_idle_step_ns / 1000, gc.requested_cycles, gc.mode_switches);
+
+        const auto& alloc = LuaAlloc::GetStats();
+        file << fmt::format("  \"allocator\": {{\"pooled\":{},\"large_allocations\":{},\"large_frees\":{},\"large_live_bytes\":{},\"classes\": [\n",
+            LuaAlloc::IsPooled(), alloc.large_allocations, alloc.large_frees, alloc.large_live_bytes);
+        for (size_t i = 0; i < alloc.classes.size(); ++i)
+        {
+            const auto& sizeClass = alloc.classes[i];
+            file << fmt::format("    {{\"size\":{},\"allocations\":{},\"frees\":{},\"fresh\":{},\"live\":{}}}{}\n",
+                sizeClass.size, sizeClass.allocations, sizeClass.frees, sizeClass.fresh, sizeClass.live, (i + 1 < alloc.classes.size()) ? "," : "");
+        }
+        file << "  ]},\n";
+
+        const auto& bytecode = LuaBytecode::GetStats();
+        file << fmt::format("  \"bytecode_cache\": {{\"hits\":{},\"misses\":{},\"write_failures\":{},\"parse_us\":{},\"load_us\":{},\"saved_us\":{}}}\n}}\n",
+            bytecode.hits, bytecode.misses, bytecode.write_failures, bytecode.parse_ns / 1000, bytecode.load_ns / 1000, bytecode.saved_ns / 1000);
+
+        const auto keepDumps = static_cast<size_t>(std::max(g_config.GetNumber(ConfigManager::LUA_PROFILER_KEEP_DUMPS), 0));
+        if (keepDumps > 0)
+        {
+            std::vector<std::filesystem::path> dumps;
+            for (const auto& dirEntry : std::filesystem::directory_iterator(directory, ec))
+            {
+                if (dirEntry.is_regular_file() and dirEntry.path().filename().string().starts_with("profile_"))
+                    dumps.push_back(dirEntry.path());
+            }
+
+            std::ranges::sort(dumps);
+            while (dumps.size() > keepDumps)
+            {
+                std::filesystem::remove(dumps.front(), ec);
+                dumps.erase(dumps.begin());
+            }
+        }
+
+        return path;
+    }
+
+    void RunRollingDump()
+    {
+        if (g_enabled)
+            Dump();
+
+        const int32_t intervalMinutes = g_config.GetNumber(ConfigManager::LUA_PROFILER_DUMP_MINUTES);
+        if (intervalMinutes > 0)
+        {
+            static auto nextTick = std::chrono::steady_clock::now();
+            g_scheduler.addEvent(createSchedulerTask(BlackTek::NextResyncDelay(nextTick, intervalMinutes * 60 * 1000), []() { RunRollingDump(); }));
+        }
+    }
+
+    void Scope::Begin(lua_State* state, int params)
+    {
+        int32_t scriptId;
+        LuaScriptInterface* scriptInterface;
+        int32_t callbackId;
+        bool timerEvent;
+        LuaScriptInterface::getScriptEnv()->getEventInfo(scriptId, scriptInterface, callbackId, timerEvent);
+
+        lua_Debug ar;
+        lua_pushvalue(state, -(params + 1));
+        if (not lua_getinfo(state, ">S", &ar) or not ar.source)
+            return;
+
+        uint64_t key = Mix(reinterpret_cast<uintptr_t>(ar.source), static_cast<uint64_t>(ar.linedefined));
+        key = Mix(key, reinterpret_cast<uintptr_t>(scriptInterface));
+        key = Mix(key, (static_cast<uint64_t>(static_cast<uint32_t>(scriptId)) << 1) | (timerEvent ? 1 : 0));
+
+        auto [it, inserted] = g_entry_index.try_emplace(key, g_entries.size());
+        if (inserted)
+            g_entries.emplace_back();
+
+        auto& current = g_entries[it->second];
+        if (inserted or current.source != ar.source or current.scriptInterface != scriptInterface
+                or current.scriptId != scriptId or current.timerEvent != timerEvent)
+        {
+            current.scriptInterface = scriptInterface;
+            current.scriptId = scriptId;
+            current.timerEvent = timerEvent;
+            current.source = ar.source;
+            current.row = {};
+            current.row.script = scriptInterface ? scriptInterface->getFileById(scriptId) : "(Unknown scriptfile)";
+            current.row.function = FunctionName(ar);
+            current.row.event = timerEvent ? "addEvent" : (scriptInterface ? scriptInterface->getInterfaceName() : "");
+        }
+
+        L = state;
+        entry = it->second;
+        generation = g_generation;
+        alloc_start = LuaGC::HeapBytes(state);
+        start = std::chrono::steady_clock::now();
+    }
+
+    void Scope::End()
+    {
+        const int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (generation != g_generation)
+            return;
+
+        auto& row = g_entries[entry].row;
+        ++row.calls;
+        row.total_ns += elapsed;
+        row.max_ns = std::max(row.max_ns, elapsed);
+        row.alloc_bytes += LuaGC::HeapBytes(L) - alloc_start;
+    }
+}
@@ -0,0 +1,88 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct lua_State;
+
+namespace BlackTek::LuaProfiler
+{
+    // one script callback, every call of the same Lua function from the same event adds up here
+    struct CallbackRow
+    {
+        std::string script;   // file (and event name for non revscripts) the event was registered from
+        std::string function; // source:line the called function was defined at
+        std::string event;    // interface the event belongs to, "addEvent" for timers
+        uint64_t calls = 0;
+        // inclusive, nested callbacks are counted in their caller too
+        int64_t total_ns = 0;
+        int64_t max_ns = 0;
+        // net growth of the Lua heap, negative when a collection step ran during the calls
+        int64_t alloc_bytes = 0;
+    };
+
+    // count hook samples, attributed to the function that was running (self time)
+    struct SampleRow
+    {
+        std::string function;
+        uint64_t samples = 0;
+    };
+
+    enum class SortBy : uint8_t
+    {
+        Time,
+        Calls,
+        Alloc,
+    };
+
+    // false until Initialize read config/scripts.toml, also toggled at runtime through SetEnabled
+    inline bool g_enabled = false;
+
+    void Initialize();
+    // (re)installs or removes the count hook on a freshly created state
+    void Attach(lua_State* L);
+    void SetEnabled(bool enabled);
+
+    [[nodiscard]] std::vector<CallbackRow> Callbacks(SortBy sortBy, size_t limit);
+    [[nodiscard]] std::vector<SampleRow> Samples(size_t limit);
+    void Reset();
+    // writes profile_<timestamp>.json into the dump directory, returns its path or an empty string
+    std::string Dump();
+    void RunRollingDump();
+
+    // Wraps one LuaScriptInterface::callFunction/callVoidFunction, the function and its params have to be
+    // on top of the stack when it is constructed.
+    class Scope
+    {
+    public:
+        Scope(lua_State* L, int params)
+        {
+            if (g_enabled)
+                Begin(L, params);
+        }
+
+        ~Scope()
+        {
+            if (L)
+                End();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        void Begin(lua_State* state, int params);
+        void End();
+
+        lua_State* L = nullptr;
+        size_t entry = 0;
+        uint32_t generation = 0;
+        int64_t alloc_start = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+}
@@ -34,6 +34,10 @@
 #include "zones.h"
 #include "metrics.h"
 #include "metrics_format.h"
+#include "luaprofiler.h"
+#include "luagc.h"
+#include "luaalloc.h"
+#include "luabytecode.h"
 #include "storewindow.h"
 
 using BlackTek::Augment;
@@ -330,7 +334,7 @@ int LuaScriptInterface::protectedCall(lua_State* L, int nargs, int nresults)
 int32_t LuaScriptInterface::loadFile(const std::string& file, NpcPtr npc /* = std::nullopt*/)
 {
 	//loads file as a chunk at stack top
-	int ret = luaL_loadfile(luaState, file.c_str());
+	int ret = BlackTek::LuaBytecode::LoadFile(luaState, file);
 	if (ret != 0) {
 		lastLuaError = popString(luaState);
 		return -1;
@@ -551,6 +555,7 @@ bool LuaScriptInterface::callFunction(int params) const
 {
 	bool result = false;
 	int size = lua_gettop(luaState);
+	BlackTek::LuaProfiler::Scope profile(luaState, params);
 	if (protectedCall(luaState, params, 1) != 0) {
 		LuaScriptInterface::reportError(nullptr, LuaScriptInterface::getString(luaState, -1));
 	} else {
@@ -569,6 +574,7 @@ bool LuaScriptInterface::callFunction(int params) const
 void LuaScriptInterface::callVoidFunction(int params) const
 {
 	int size = lua_gettop(luaState);
+	BlackTek::LuaProfiler::Scope profile(luaState, params);
 	if (protectedCall(luaState, params, 0) != 0) {
 		LuaScriptInterface::reportError(nullptr, LuaScriptInterface::popString(luaState));
 	}
@@ -922,6 +928,26 @@ GameModel LuaScriptInterface::getGameModel(lua_State* L, int32_t arg)
 	return thing;
 }
 
+BlackTek::CreatureHandle LuaScriptInterface::getCreatureHandle(const Creature* creature)
+{
+	return creature->getLuaHandle();
+}
+
+BlackTek::CreatureHandle LuaScriptInterface::getCreatureHandle(const Player* player)
+{
+	return player->getLuaHandle();
+}
+
+BlackTek::CreatureHandle LuaScriptInterface::getCreatureHandle(const Monster* monster)
+{
+	return monster->getLuaHandle();
+}
+
+BlackTek::CreatureHandle LuaScriptInterface::getCreatureHandle(const Npc* npc)
+{
+	return npc->getLuaHandle();
+}
+
 CreaturePtr LuaScriptInterface::getCreature(lua_State* L, int32_t arg)
 {
 	if (isUserdata(L, arg)) {
@@ -2240,6 +2266,17 @@ void LuaScriptInterface::registerFunctions()
 	registerMethod("Game", "getWorldType", luaGameGetWorldType);
 	registerMethod("Game", "setWorldType", luaGameSetWorldType);
 
+	registerMethod("Game", "getPlayerSaveStats", luaGameGetPlayerSaveStats);
+	registerMethod("Game", "getSpectatorCacheStats", luaGameGetSpectatorCacheStats);
+	registerMethod("Game", "getSightCacheStats", luaGameGetSightCacheStats);
+	registerMethod("Game", "getScriptProfile", luaGameGetScriptProfile);
+	registerMethod("Game", "resetScriptProfile", luaGameResetScriptProfile);
+	registerMethod("Game", "dumpScriptProfile", luaGameDumpScriptProfile);
+	registerMethod("Game", "setScriptProfiling", luaGameSetScriptProfiling);
+	registerMethod("Game", "getLuaGcStats", luaGameGetLuaGcStats);
+	registerMethod("Game", "getLuaAllocStats", luaGameGetLuaAllocStats);
+	registerMethod("Game", "getScriptCacheStats", luaGameGetScriptCacheStats);
+
 	registerMethod("Game", "getItemAttributeByName", luaGameGetItemAttributeByName);
 	registerMethod("Game", "getReturnMessage", luaGameGetReturnMessage);
 
@@ -2568,7 +2605,6 @@ void LuaScriptInterface::registerFunctions()
 	// Creature
 	registerClass("Creature", "", luaCreatureCreate);
 	registerMetaMethod("Creature", "__eq", luaUserdataCompare);
-	registerMetaMethod("Creature", "__gc", destroySharedUserData<Creature>);
 
 	registerMethod("Creature", "getEvents", luaCreatureGetEvents);
 	registerMethod("Creature", "registerEvent", luaCreatureRegisterEvent);
@@ -2693,7 +2729,6 @@ void LuaScriptInterface::registerFunctions()
 	// Player
 	registerClass("Player", "Creature", luaPlayerCreate);
 	registerMetaMethod("Player", "__eq", luaUserdataCompare);
-	registerMetaMethod("Player", "__gc", destroySharedUserData<Player>);
 
 	registerMethod("Player", "isPlayer", luaPlayerIsPlayer);
 
@@ -2883,7 +2918,6 @@ void LuaScriptInterface::registerFunctions()
 	// Monster
 	registerClass("Monster", "Creature", luaMonsterCreate);
 	registerMetaMethod("Monster", "__eq", luaUserdataCompare);
-	registerMetaMethod("Monster", "__gc", destroySharedUserData<Monster>);
 
 	registerMethod("Monster", "getId", luaMonsterGetId);
 	registerMethod("Monster", "isMonster", luaMonsterIsMonster);
@@ -2921,7 +2955,6 @@ void LuaScriptInterface::registerFunctions()
 	// Npc
 	registerClass("Npc", "Creature", luaNpcCreate);
 	registerMetaMethod("Npc", "__eq", luaUserdataCompare);
-	registerMetaMethod("Npc", "__gc", destroySharedUserData<Npc>);
 
 	registerMethod("Npc", "isNpc", luaNpcIsNpc);
 
@@ -4897,7 +4930,8 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 			luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(getString(L, -1), callback, true);
+	// reads don't wait behind the writes of other scripts, nor the other way around
+	g_databaseTasks.addTask(getString(L, -1), callback, true, DatabaseTasks::UNORDERED);
 	return 0;
 }
 
@@ -5435,6 +5469,188 @@ int LuaScriptInterface::luaGameSetWorldType(lua_State* L)
 	return 1;
 }
 
+int LuaScriptInterface::luaGameGetPlayerSaveStats(lua_State* L)
+{
+	// Game.getPlayerSaveStats()
+	const auto& stats = g_game.lastPlayerSaveStats;
+	lua_createtable(L, 0, 6);
+	setField(L, "players", stats.playerCount);
+	setField(L, "batches", stats.batchCount);
+	setField(L, "failedBatches", stats.failedBatchCount);
+	setField(L, "snapshotTime", stats.snapshotTime);
+	setField(L, "databaseTime", stats.databaseTime);
+
+	// totals since startup, per section
+	const auto& counters = IOLoginData::getSaveCounters();
+	lua_createtable(L, 0, counters.size());
+	for (size_t section = 0; section < counters.size(); ++section) {
+		const auto& counter = counters[section];
+		lua_createtable(L, 0, 4);
+		setField(L, "written", counter.written);
+		setField(L, "skipped", counter.skipped);
+		setField(L, "bytesWritten", counter.bytesWritten);
+		setField(L, "bytesSkipped", counter.bytesSkipped);
+		lua_setfield(L, -2, IOLoginData::getSaveSectionName(static_cast<PlayerSaveSection>(section)).data());
+	}
+	lua_setfield(L, -2, "sections");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetSpectatorCacheStats(lua_State* L)
+{
+	// Game.getSpectatorCacheStats()
+	const auto& stats = g_game.map.getSpectatorCacheStats();
+	lua_createtable(L, 0, 3);
+	setField(L, "hits", stats.hits);
+	setField(L, "misses", stats.misses);
+	setField(L, "invalidations", stats.invalidations);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetSightCacheStats(lua_State* L)
+{
+	// Game.getSightCacheStats()
+	const auto& stats = g_game.map.getSightCacheStats();
+	lua_createtable(L, 0, 3);
+	setField(L, "hits", stats.hits);
+	setField(L, "misses", stats.misses);
+	setField(L, "invalidations", stats.invalidations);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetScriptProfile(lua_State* L)
+{
+	// Game.getScriptProfile([limit = 20[, sortBy = "time"]]), times in microseconds
+	using namespace BlackTek::LuaProfiler;
+
+	const std::string& sortName = getString(L, 2);
+	SortBy sortBy = SortBy::Time;
+	if (sortName == "calls") {
+		sortBy = SortBy::Calls;
+	} else if (sortName == "alloc") {
+		sortBy = SortBy::Alloc;
+	}
+
+	const size_t limit = getNumber<size_t>(L, 1, 20);
+	lua_createtable(L, 0, 3);
+	pushBoolean(L, g_enabled);
+	lua_setfield(L, -2, "enabled");
+
+	const auto callbacks = Callbacks(sortBy, limit);
+	lua_createtable(L, callbacks.size(), 0);
+	int index = 0;
+	for (const auto& row : callbacks) {
+		lua_createtable(L, 0, 7);
+		setField(L, "script", row.script);
+		setField(L, "func", row.function);
+		setField(L, "event", row.event);
+		setField(L, "calls", row.calls);
+		setField(L, "totalTime", row.total_ns / 1000);
+		setField(L, "maxTime", row.max_ns / 1000);
+		setField(L, "allocBytes", row.alloc_bytes);
+		lua_rawseti(L, -2, ++index);
+	}
+	lua_setfield(L, -2, "callbacks");
+
+	const auto samples = Samples(limit);
+	lua_createtable(L, samples.size(), 0);
+	index = 0;
+	for (const auto& row : samples) {
+		lua_createtable(L, 0, 2);
+		setField(L, "func", row.function);
+		setField(L, "samples", row.samples);
+		lua_rawseti(L, -2, ++index);
+	}
+	lua_setfield(L, -2, "samples");
+	return 1;
+}
+
+int LuaScriptInterface::luaGameResetScriptProfile(lua_State* L)
+{
+	// Game.resetScriptProfile()
+	BlackTek::LuaProfiler::Reset();
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameDumpScriptProfile(lua_State* L)
+{
+	// Game.dumpScriptProfile()
+	const std::string path = BlackTek::LuaProfiler::Dump();
+	if (path.empty()) {
+		lua_pushnil(L);
+	} else {
+		pushString(L, path);
+	}
+	return 1;
+}
+
+int LuaScriptInterface::luaGameSetScriptProfiling(lua_State* L)
+{
+	// Game.setScriptProfiling(enabled)
+	BlackTek::LuaProfiler::SetEnabled(getBoolean(L, 1));
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLuaGcStats(lua_State* L)
+{
+	// Game.getLuaGcStats(), times in microseconds
+	const auto& stats = BlackTek::LuaGC::GetStats();
+	lua_createtable(L, 0, 8);
+	setField(L, "heapBytes", BlackTek::LuaGC::HeapBytes(L));
+	pushBoolean(L, BlackTek::LuaGC::IsGenerational());
+	lua_setfield(L, -2, "generational");
+	setField(L, "idleSteps", stats.idle_steps);
+	setField(L, "idleCycles", stats.idle_cycles);
+	setField(L, "idleStepTime", stats.idle_step_ns / 1000);
+	setField(L, "maxIdleStepTime", stats.max_idle_step_ns / 1000);
+	setField(L, "requestedCycles", stats.requested_cycles);
+	setField(L, "modeSwitches", stats.mode_switches);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLuaAllocStats(lua_State* L)
+{
+	// Game.getLuaAllocStats()
+	const auto& stats = BlackTek::LuaAlloc::GetStats();
+	lua_createtable(L, 0, 5);
+	pushBoolean(L, BlackTek::LuaAlloc::IsPooled());
+	lua_setfield(L, -2, "pooled");
+
+	lua_createtable(L, stats.classes.size(), 0);
+	int index = 0;
+	for (const auto& sizeClass : stats.classes) {
+		lua_createtable(L, 0, 5);
+		setField(L, "size", sizeClass.size);
+		setField(L, "allocations", sizeClass.allocations);
+		setField(L, "frees", sizeClass.frees);
+		setField(L, "fresh", sizeClass.fresh);
+		setField(L, "live", sizeClass.live);
+		lua_rawseti(L, -2, ++index);
+	}
+	lua_setfield(L, -2, "classes");
+
+	setField(L, "largeAllocations", stats.large_allocations);
+	setField(L, "largeFrees", stats.large_frees);
+	setField(L, "largeLiveBytes", stats.large_live_bytes);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetScriptCacheStats(lua_State* L)
+{
+	// Game.getScriptCacheStats()
+	const auto& stats = BlackTek::LuaBytecode::GetStats();
+	lua_createtable(L, 0, 6);
+	setField(L, "hits", stats.hits);
+	setField(L, "misses", stats.misses);
+	setField(L, "writeFailures", stats.write_failures);
+	setField(L, "parseTime", stats.parse_ns / 1000);
+	setField(L, "loadTime", stats.load_ns / 1000);
+	setField(L, "savedTime", stats.saved_ns / 1000);
+	return 1;
+}
+
 int LuaScriptInterface::luaGameGetReturnMessage(lua_State* L)
 {
 	// Game.getReturnMessage(value)
@@ -5690,11 +5906,11 @@ int LuaScriptInterface::luaGameReload(lua_State* L)
 	if (reloadType == RELOAD_TYPE_GLOBAL) {
 		pushBoolean(L, g_luaEnvironment.loadFile("data/global.lua") == 0);
 		pushBoolean(L, g_scripts->loadScripts("scripts/lib", true, true));
-		lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+		BlackTek::LuaGC::RequestCycle();
 		return 2;
 	}
 	pushBoolean(L, g_game.reload(reloadType));
-	lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+	BlackTek::LuaGC::RequestCycle();
 	return 1;
 }
 
@@ -9789,9 +10005,7 @@ int LuaScriptInterface::luaCreatureCreate(lua_State* L)
 
 int LuaScriptInterface::luaCreatureDelete(lua_State* L)
 {
-	if (auto& creature = getSharedPtr<Creature>(L, 1)) {
-		creature.reset();
-	}
+	clearCreatureHandle(L, 1);
 	return 0;
 }
 
@@ -10123,7 +10337,7 @@ int LuaScriptInterface::luaCreatureSetLight(lua_State* L)
 int LuaScriptInterface::luaCreatureGetSpeed(lua_State* L)
 {
 	// creature:getSpeed()
-	if (const auto creature = getUserdata<const Creature>(L, 1)) {
+	if (const auto creature = getSharedPtr<const Creature>(L, 1)) {
 		lua_pushinteger(L, creature->getSpeed());
 	} else {
 		lua_pushnil(L);
@@ -10745,7 +10959,7 @@ int LuaScriptInterface::luaCreatureGiveCustomSkill(lua_State* L)
 	
 	auto make_new = (isBoolean(L, 3)) ? getBoolean(L, 3) : true;
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1)) 
+	if (const auto creature = getSharedPtr<Creature>(L, 1)) 
 	{
 		if (isString(L, 2) and isUserdata(L, 3))
 		{
@@ -10836,7 +11050,7 @@ int LuaScriptInterface::luaCreatureAddCustomSkill(lua_State* L)
 {
 	// creature:addSkill("SkillName")
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2) and isNumber(L, 3))
 		{
@@ -10883,7 +11097,7 @@ int LuaScriptInterface::luaCreatureSubtractCustomSkill(lua_State* L)
 {
 	// creature:subtractSkill("SkillName", levels)
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2) and isNumber(L, 3))
 		{
@@ -10929,7 +11143,7 @@ int LuaScriptInterface::luaCreatureAddBonusCustomSkill(lua_State* L)
 {
 	// creature:addBonusSkill("SkillName")
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2) and isNumber(L, 3))
 		{
@@ -10976,7 +11190,7 @@ int LuaScriptInterface::luaCreatureSubtractBonusSkill(lua_State* L)
 {
 	// creature:subtractBonusSkill("SkillName", levels)
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2) and isNumber(L, 3))
 		{
@@ -11022,7 +11236,7 @@ int LuaScriptInterface::luaCreatureClearBonusSkill(lua_State* L)
 {
 	// creature:clearBonusSkill("SkillName")
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2))
 		{
@@ -11056,7 +11270,7 @@ int LuaScriptInterface::luaCreatureRemoveCustomSkill(lua_State* L)
 {
 	// creature:removeSkill("SkillName")
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2))
 		{
@@ -11080,7 +11294,7 @@ int LuaScriptInterface::luaCreatureHasCustomSkill(lua_State* L)
 {
 	// creature:hasSkill("SkillName")
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2))
 		{
@@ -11104,7 +11318,7 @@ int LuaScriptInterface::luaCreatureCanGainSkillLevels(lua_State* L)
 {
 	// creature:canSkill("SkillName")
 	// returns bool
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2))
 		{
@@ -11138,7 +11352,7 @@ int LuaScriptInterface::luaCreatureGetCustomSkillLevel(lua_State* L)
 {
 	// creature:getSkillLevel("SkillName", bonus = true)
 	// returns number value
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2))
 		{
@@ -11172,7 +11386,7 @@ int LuaScriptInterface::luaCreatureGetCustomSkillUserData(lua_State* L)
 {
 	// creature:getSkill("SkillName")
 	// returns userdata (shared pointer)
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		if (isString(L, 2))
 		{
@@ -11208,7 +11422,7 @@ int LuaScriptInterface::luaCreatureGiveStat(lua_State* L)
 	// creature:giveStat(id, max_points, <optional> current_points)
 	// creature:giveStat(id, stat)
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		const auto stat_id = getNumber<uint32_t>(L, 2);
 		const auto max_points = getNumber<uint32_t>(L, 3);
@@ -11234,7 +11448,7 @@ int LuaScriptInterface::luaCreatureRemoveStat(lua_State* L)
 	// creature:removeStat(id)
 	// -- returns bool
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		const auto stat_id = getNumber<uint32_t>(L, 2);
 		pushBoolean(L, creature->removeCustomStat(stat_id));
@@ -11256,7 +11470,7 @@ int LuaScriptInterface::luaCreatureIncreaseStat(lua_State* L)
 	// creature:increaseStat(id, number)
 	// -- returns bool
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		const auto stat_id = getNumber<uint32_t>(L, 2);
 		const auto amount = getNumber<uint32_t>(L, 3);
@@ -11279,7 +11493,7 @@ int LuaScriptInterface::luaCreatureDecreaseStat(lua_State* L)
 	// creature:decreaseStat(id, number)
 	// -- returns bool
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		const auto stat_id = getNumber<uint32_t>(L, 2);
 		const auto amount = getNumber<uint32_t>(L, 3);
@@ -11302,7 +11516,7 @@ int LuaScriptInterface::luaCreatureHasStat(lua_State* L)
 	// creature:hasStat(id)
 	// -- returns bool
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		const auto stat_id = getNumber<uint32_t>(L, 2);
 		pushBoolean(L, creature->hasCustomStat(stat_id));
@@ -11324,7 +11538,7 @@ int LuaScriptInterface::luaCreatureGetStat(lua_State* L)
 	// creature:getStat(id)
 	// -- returns bool
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 		const auto stat_id = getNumber<uint32_t>(L, 2);
 		const auto has_stat = creature->getCustomStat(stat_id) ? true : false;
@@ -11347,7 +11561,7 @@ int LuaScriptInterface::luaCreatureGetStats(lua_State* L)
 	// creature:getStats()
 	// -- returns false if there are none, or a table of all the stats the creature has if any exist
 
-	if (auto& creature = getSharedPtr<Creature>(L, 1))
+	if (const auto creature = getSharedPtr<Creature>(L, 1))
 	{
 
 		if (not creature->hasCustomStats())
@@ -11839,9 +12053,7 @@ int LuaScriptInterface::luaPlayerCreate(lua_State* L)
 
 int LuaScriptInterface::luaPlayerDelete(lua_State* L)
 {
-	if (auto& player = getSharedPtr<Player>(L, 1)) {
-		player.reset();
-	}
+	clearCreatureHandle(L, 1);
 	return 0;
 }
 
@@ -12834,7 +13046,7 @@ int LuaScriptInterface::luaPlayerSetBankBalance(lua_State* L)
 int LuaScriptInterface::luaPlayerGetStorageValue(lua_State* L)
 {
 	// player:getStorageValue(key)
-	const auto player = getSharedPtr<Player>(L, 1);
+	const auto player = getSharedPtr<const Player>(L, 1);
 	if (!player) {
 		lua_pushnil(L);
 		return 1;
@@ -14168,16 +14380,14 @@ int LuaScriptInterface::luaMonsterCreate(lua_State* L)
 
 int LuaScriptInterface::luaMonsterDelete(lua_State* L)
 {
-	if (auto& monster = getSharedPtr<Monster>(L, 1)) {
-		monster.reset();
-	}
+	clearCreatureHandle(L, 1);
 	return 0;
 }
 
 int LuaScriptInterface::luaMonsterGetId(lua_State* L)
 {
 	// monster:getId()
-	if (auto& monster = getSharedPtr<Monster>(L, 1)) {
+	if (const auto monster = getSharedPtr<Monster>(L, 1)) {
 		// Set monster id if it's not set yet (only for onSpawn event)
 		if (getScriptEnv()->getScriptId() == g_events->getScriptId(EventInfoId::MONSTER_ONSPAWN)) {
 			monster->setID();
@@ -14193,7 +14403,7 @@ int LuaScriptInterface::luaMonsterGetId(lua_State* L)
 int LuaScriptInterface::luaMonsterIsMonster(lua_State* L)
 {
 	// monster:isMonster()
-	pushBoolean(L, getUserdata<const Monster>(L, 1) != nullptr);
+	pushBoolean(L, getSharedPtr<const Monster>(L, 1) != nullptr);
 	return 1;
 }
 
@@ -14445,7 +14655,7 @@ int LuaScriptInterface::luaMonsterRemoveTarget(lua_State* L)
 int LuaScriptInterface::luaMonsterGetTargetList(lua_State* L)
 {
 	// monster:getTargetList()
-	const auto monster = getUserdata<Monster>(L, 1);
+	const auto monster = getSharedPtr<Monster>(L, 1);
 	if (!monster) {
 		lua_pushnil(L);
 		return 1;
@@ -14562,9 +14772,7 @@ int LuaScriptInterface::luaNpcCreate(lua_State* L)
 
 int LuaScriptInterface::luaNpcDelete(lua_State* L)
 {
-	if (auto& npc = getSharedPtr<Npc>(L, 1)) {
-		npc.reset();
-	}
+	clearCreatureHandle(L, 1);
 	return 0;
 }
 
@@ -16187,10 +16395,15 @@ int LuaScriptInterface::luaZoneGetPositions(lua_State* L)
 		return 1;
 	}
 
-	lua_newtable(L);
+	// zones given as a range only keep their corners, the tiles are listed on request
+	const auto& positions = zone->positions.empty() and zone->area_range
+		? Zones::ZoneManager::FillRectangle(zone->area_range->first, zone->area_range->second)
+		: zone->positions;
+
+	lua_createtable(L, static_cast<int>(positions.size()), 0);
 	int index = 0;
 
-	for (const auto& position : zone->positions)
+	for (const auto& position : positions)
 	{
 		pushPosition(L, position);
 		lua_rawseti(L, -2, ++index);
@@ -24828,7 +25041,7 @@ LuaEnvironment::~LuaEnvironment()
 
 bool LuaEnvironment::initState()
 {
-	luaState = luaL_newstate();
+	luaState = BlackTek::LuaAlloc::NewState();
 	if (!luaState) {
 		return false;
 	}
@@ -24836,6 +25049,8 @@ bool LuaEnvironment::initState()
 	luaL_openlibs(luaState);
 	LuaScriptInterface::initSharedPtrCache(luaState);
 	registerFunctions();
+	BlackTek::LuaGC::Configure(luaState);
+	BlackTek::LuaProfiler::Attach(luaState);
 
 	runningEventId = EVENT_ID_USER;
 	return true;
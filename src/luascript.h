@@ -20,6 +20,7 @@
 #endif
 
 #include "console.h"
+#include "creatureregistry.h"
 #include "database.h"
 #include "enums.h"
 #include "position.h"
@@ -77,6 +78,11 @@ concept SharedPtr = requires(T t)
 	{ t.operator->() } -> std::convertible_to<typename T::element_type*>;
 };
 
+// userdata of these holds a BlackTek::CreatureHandle instead of a shared_ptr
+template <typename T>
+concept LuaCreatureType = std::is_same_v<std::remove_const_t<T>, Creature> || std::is_same_v<std::remove_const_t<T>, Player>
+	|| std::is_same_v<std::remove_const_t<T>, Monster> || std::is_same_v<std::remove_const_t<T>, Npc>;
+
 enum {
 	EVENT_ID_LOADING = 1,
 	EVENT_ID_USER = 1000,
@@ -293,13 +299,64 @@ class LuaScriptInterface
 			lua_pushvalue(L, -1);
 			lua_setfield(L, LUA_REGISTRYINDEX, "sp_cache");
 			spCacheRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+			// creature userdata by slot index, so pushing the same creature twice gives the same
+			// userdata (scripts use them as table keys)
+			lua_newtable(L);
+			lua_newtable(L);
+			lua_pushstring(L, "v");
+			lua_setfield(L, -2, "__mode");
+			lua_setmetatable(L, -2);
+			creatureCacheRef = luaL_ref(L, LUA_REGISTRYINDEX);
+		}
+
+		static inline int creatureCacheRef = LUA_NOREF;
+
+		static BlackTek::CreatureHandle getCreatureHandle(const Creature* creature);
+		static BlackTek::CreatureHandle getCreatureHandle(const Player* player);
+		static BlackTek::CreatureHandle getCreatureHandle(const Monster* monster);
+		static BlackTek::CreatureHandle getCreatureHandle(const Npc* npc);
+
+		static void pushCreatureHandle(lua_State* L, BlackTek::CreatureHandle handle, int nuvalue)
+		{
+			if (not handle.IsValid())
+			{
+				new (lua_newuserdatauv(L, sizeof(BlackTek::CreatureHandle), nuvalue)) BlackTek::CreatureHandle(handle);
+				return;
+			}
+
+			const lua_Integer key = lua_Integer{ handle.slot_index } + 1;
+			lua_rawgeti(L, LUA_REGISTRYINDEX, creatureCacheRef);
+			if (lua_rawgeti(L, -1, key) == LUA_TUSERDATA and *static_cast<BlackTek::CreatureHandle*>(lua_touserdata(L, -1)) == handle)
+			{
+				lua_remove(L, -2);
+				return;
+			}
+			lua_pop(L, 1);
+
+			new (lua_newuserdatauv(L, sizeof(BlackTek::CreatureHandle), nuvalue)) BlackTek::CreatureHandle(handle);
+			lua_pushvalue(L, -1);
+			lua_rawseti(L, -3, key);
+			lua_remove(L, -2);
 		}
 
-		// todo: refine all the userdata in the future to just go by an embedded GUID for lookup
-		// thereby reducing size of userdata, C++ maintains ownership and lifecycle responsibility of the objects
-		// and with those two things comes better performance and stability
+		// Creatures are pushed as a handle into BlackTek::CreatureRegistry, everything else still
+		// as a shared_ptr copy
 		template <SharedPtr T>
 		static inline void pushSharedPtr(lua_State* L, const T& value, int nuvalue = 1)
+		{
+			if constexpr (LuaCreatureType<typename T::element_type>)
+			{
+				pushCreatureHandle(L, value ? getCreatureHandle(value.get()) : BlackTek::CreatureHandle{}, nuvalue);
+			}
+			else
+			{
+				pushSharedUserdata(L, value, nuvalue);
+			}
+		}
+
+		template <SharedPtr T>
+		static inline void pushSharedUserdata(lua_State* L, const T& value, int nuvalue)
 		{
 			const void* key = value.get();
 
@@ -411,10 +468,35 @@ class LuaScriptInterface
 			return static_cast<T**>(lua_touserdata(L, arg));
 		}
 	
+		// For creatures a const type gives a BlackTek::CreatureView (no reference taken, for plain
+		// accessors), a mutable one a shared_ptr copy that keeps the creature alive through the call.
 		template<class T>
-		static std::shared_ptr<T>& getSharedPtr(lua_State* L, int32_t arg)
+		static decltype(auto) getSharedPtr(lua_State* L, int32_t arg)
 		{
-			return *static_cast<std::shared_ptr<T>*>(lua_touserdata(L, arg));
+			if constexpr (LuaCreatureType<T>)
+			{
+				const auto* handle = static_cast<const BlackTek::CreatureHandle*>(lua_touserdata(L, arg));
+				T* creature = handle ? static_cast<T*>(BlackTek::CreatureRegistry::Resolve(*handle)) : nullptr;
+				if constexpr (std::is_const_v<T>)
+				{
+					return BlackTek::CreatureView<T>(creature);
+				}
+				else
+				{
+					return creature ? std::static_pointer_cast<T>(creature->weak_from_this().lock()) : std::shared_ptr<T>();
+				}
+			}
+			else
+			{
+				return *static_cast<std::shared_ptr<T>*>(lua_touserdata(L, arg));
+			}
+		}
+
+		// drops what a creature userdata points to, for the delete methods
+		static void clearCreatureHandle(lua_State* L, int32_t arg)
+		{
+			if (auto* handle = static_cast<BlackTek::CreatureHandle*>(lua_touserdata(L, arg)))
+				*handle = {};
 		}
 
 		template<class T>
@@ -714,6 +796,17 @@ class LuaScriptInterface
 		static int luaGameGetWorldType(lua_State* L);
 		static int luaGameSetWorldType(lua_State* L);
 
+		static int luaGameGetPlayerSaveStats(lua_State* L);
+		static int luaGameGetSpectatorCacheStats(lua_State* L);
+		static int luaGameGetSightCacheStats(lua_State* L);
+		static int luaGameGetScriptProfile(lua_State* L);
+		static int luaGameResetScriptProfile(lua_State* L);
+		static int luaGameDumpScriptProfile(lua_State* L);
+		static int luaGameSetScriptProfiling(lua_State* L);
+		static int luaGameGetLuaGcStats(lua_State* L);
+		static int luaGameGetLuaAllocStats(lua_State* L);
+		static int luaGameGetScriptCacheStats(lua_State* L);
+
 		static int luaGameGetItemAttributeByName(lua_State* L);
 		static int luaGameGetReturnMessage(lua_State* L);
 
@@ -10,9 +10,16 @@
 #include "creaturecontainer.h"
 #include "game.h"
 #include "monster.h"
+#include "monsters.h"
+#include "zones.h"
 #include "simd_kernels.h"
+#include "tasks.h"
+#include "walksnapshot.h"
+
+#include <fmt/format.h>
 
 extern Game g_game;
+extern Monsters g_monsters;
 
 namespace
 {
@@ -26,7 +33,7 @@ namespace
 bool Map::loadMap(const std::string& identifier, bool loadHouses)
 {
 	IOMap loader;
-    auto loadResult = loader.loadMap(this, identifier, g_game.getRawMapBlock(), g_game.getMapBlock());
+    auto loadResult = loader.loadMap(this, identifier, g_game.getRawMapBlock(), g_game.getMapBlock(), g_game.getMapLoadPools());
 
 	if (not loadResult)
 	{
@@ -34,9 +41,7 @@ bool Map::loadMap(const std::string& identifier, bool loadHouses)
 		return false;
 	}
 
-	lastLoadTimeSeconds = loadResult->time;
-	lastLoadTileCount   = loadResult->tileCount;
-	lastLoadItemCount   = loadResult->itemCount;
+	lastLoadStats = *loadResult;
 
 	IOMap::resolveLegacySpawnFile(this);
 
@@ -135,8 +140,13 @@ void Map::setTile(const uint16_t x, const uint16_t y, const uint8_t z, TilePtr&
 		return;
 	}
 
-	const ChunkHandle chunkHandle = chunk_grid.GetOrCreateChunk(ToChunkCoord(x, y));
+	const ChunkCoord chunkCoord = ToChunkCoord(x, y);
+	const bool newChunk = not chunk_grid.FindChunk(chunkCoord).IsValid();
+	const ChunkHandle chunkHandle = chunk_grid.GetOrCreateChunk(chunkCoord);
 	Chunk* chunk = chunk_grid.GetChunk(chunkHandle);
+
+	if (newChunk)
+		Zones::ZoneManager::StampChunkFlags(x, y);
 	FloorHandle floorHandle = chunk->floor_handles[z];
 
 	if (not floorHandle.IsValid()) 
@@ -171,7 +181,11 @@ void Map::setTile(const uint16_t x, const uint16_t y, const uint8_t z, TilePtr&
 		tile = newTile;
 
 		chunk->SetTileBlockState(offsetX, offsetY, z,
-			newTile->hasFlag(TILESTATE_BLOCKPATH), newTile->hasFlag(TILESTATE_BLOCKSOLID), newTile->hasProperty(CONST_PROP_BLOCKPROJECTILE));
+			newTile->hasFlag(TILESTATE_BLOCKPATH), newTile->hasFlag(TILESTATE_BLOCKSOLID), newTile->hasProperty(CONST_PROP_BLOCKPROJECTILE), newTile->blocksArea());
+		chunk->SetTileWalkState(offsetX, offsetY, z, newTile->getGround() != nullptr, newTile->needsWalkCheck());
+		invalidateSightCache();
+		// a new tile changes walkability even when none of its bits are set
+		++chunk->path_revision[z];
 	}
 }
 
@@ -319,7 +333,10 @@ bool Map::placeCreature(const Position& centerPos, CreaturePtr creature, bool ex
 
 	const Position& dest = destTile->getPosition();
     if (auto* chunk = getChunk(dest.x, dest.y))
+    {
         chunk->AddCreature(creature);
+        invalidateSpectatorCache(dest.x, dest.y);
+    }
     else
         BlackTek::Console::DebugLog("Creature placed on non-existent tile, and has escaped spectator tracking as a result!");
 
@@ -397,8 +414,12 @@ void Map::moveCreature(CreaturePtr& creature, const TilePtr& newTile, bool force
 
         else 
             BlackTek::Console::DebugLog("Creature placed on non-existent tile, and has escaped spectator tracking as a result!");
+
+		invalidateSpectatorCache(oldPos.x, oldPos.y);
 	}
 
+	invalidateSpectatorCache(newPos.x, newPos.y);
+
 	if (not teleport)
     {
 		if (oldPos.y > newPos.y)
@@ -434,6 +455,9 @@ void Map::moveCreature(CreaturePtr& creature, const TilePtr& newTile, bool force
             static_cast<Monster*>(c.get())->setIdle(false);
     }
 
+    if (oldChunkHandle != newChunkHandle and creature->getCreatureSubType() == CreatureSubType::Player)
+        wakeMonstersNear(newPos);
+
 	const std::span<const CreaturePtr> spectators_span(spectators.begin(), spectators.size());
 
 	for (const auto& spectator : spectators)
@@ -625,7 +649,145 @@ void Map::getSpectators(SpectatorVec& spectators, const Position& centerPos, con
         maxRangeZ = centerPos.z;
     }
 
-    getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+    // a cycle is one dispatcher task, so any caller outside of the dispatcher thread scans directly
+    if (not g_dispatcher.isCurrentThread())
+    {
+        getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+        return;
+    }
+
+    if (const uint64_t cycle = g_dispatcher.getDispatcherCycle(); cycle != spectatorCacheCycle)
+    {
+        spectatorCache.clear();
+        spectatorCacheCycle = cycle;
+    }
+
+    const auto it = std::ranges::find_if(spectatorCache, [&](const SpectatorCacheEntry& entry) {
+        return entry.centerPos == centerPos and entry.onlyPlayers == onlyPlayers and
+            entry.minRangeX == minRangeX and entry.maxRangeX == maxRangeX and
+            entry.minRangeY == minRangeY and entry.maxRangeY == maxRangeY and
+            entry.minRangeZ == minRangeZ and entry.maxRangeZ == maxRangeZ;
+    });
+
+    const SpectatorVec* result;
+    if (it != spectatorCache.end())
+    {
+        ++spectatorCacheStats.hits;
+        result = &it->spectators;
+    }
+    else
+    {
+        ++spectatorCacheStats.misses;
+        if (spectatorCache.size() >= maxSpectatorCacheEntries)
+        {
+            getSpectatorsInternal(spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+            return;
+        }
+
+        // same chunk rectangle getSpectatorsInternal walks
+        const int32_t minoffset = centerPos.getZ() - maxRangeZ;
+        const int32_t maxoffset = centerPos.getZ() - minRangeZ;
+        const auto start = BlackTek::World::ToChunkCoord(
+            std::clamp<int32_t>(centerPos.x + minRangeX + minoffset, 0, 0xFFFF),
+            std::clamp<int32_t>(centerPos.y + minRangeY + minoffset, 0, 0xFFFF));
+        const auto end = BlackTek::World::ToChunkCoord(
+            std::clamp<int32_t>(centerPos.x + maxRangeX + maxoffset, 0, 0xFFFF),
+            std::clamp<int32_t>(centerPos.y + maxRangeY + maxoffset, 0, 0xFFFF));
+
+        auto& entry = spectatorCache.emplace_back(SpectatorCacheEntry{
+            centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers,
+            start.chunk_x, start.chunk_y, end.chunk_x, end.chunk_y, {} });
+        getSpectatorsInternal(entry.spectators, centerPos, minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ, onlyPlayers);
+        result = &entry.spectators;
+    }
+
+    if (spectators.empty())
+    {
+        spectators = *result;
+        return;
+    }
+
+    // appending keeps the behaviour of a scan into a non-empty vector, the whole vector gets partitioned again
+    for (const auto& creature : *result)
+        spectators.emplace_back(creature);
+
+    if (onlyPlayers)
+        spectators.setPlayersOnlyMode();
+
+    else
+        spectators.partitionByType();
+}
+
+void Map::invalidateSpectatorCache(const uint16_t x, const uint16_t y)
+{
+    if (spectatorCache.empty())
+        return;
+
+    const auto coord = BlackTek::World::ToChunkCoord(x, y);
+    const size_t before = spectatorCache.size();
+
+    std::erase_if(spectatorCache, [&](const SpectatorCacheEntry& entry) {
+        return coord.chunk_x >= entry.startChunkX and coord.chunk_x <= entry.endChunkX and
+            coord.chunk_y >= entry.startChunkY and coord.chunk_y <= entry.endChunkY;
+    });
+
+    spectatorCacheStats.invalidations += before - spectatorCache.size();
+}
+
+bool Map::hasPlayersNear(const Position& pos)
+{
+    using namespace BlackTek::World;
+
+    const int32_t startChunkX = std::max<int32_t>(0, pos.x - dormancyRange) >> Floor::Bits;
+    const int32_t startChunkY = std::max<int32_t>(0, pos.y - dormancyRange) >> Floor::Bits;
+    const int32_t endChunkX = std::min<int32_t>(0xFFFF, pos.x + dormancyRange) >> Floor::Bits;
+    const int32_t endChunkY = std::min<int32_t>(0xFFFF, pos.y + dormancyRange) >> Floor::Bits;
+
+    for (int32_t chunkY = startChunkY; chunkY <= endChunkY; ++chunkY)
+    {
+        for (int32_t chunkX = startChunkX; chunkX <= endChunkX; ++chunkX)
+        {
+            if (const Chunk* chunk = chunk_grid.GetChunk(chunk_grid.FindChunk({ chunkX, chunkY })); chunk and chunk->player_count > 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+void Map::wakeMonstersNear(const Position& pos)
+{
+    using namespace BlackTek::World;
+
+    // every monster with the chunk of pos inside of its own hasPlayersNear range
+    const int32_t chunkStartX = pos.x & ~Floor::Mask;
+    const int32_t chunkStartY = pos.y & ~Floor::Mask;
+    const int32_t startChunkX = std::max<int32_t>(0, chunkStartX - dormancyRange) >> Floor::Bits;
+    const int32_t startChunkY = std::max<int32_t>(0, chunkStartY - dormancyRange) >> Floor::Bits;
+    const int32_t endChunkX = std::min<int32_t>(0xFFFF, chunkStartX + Floor::Mask + dormancyRange) >> Floor::Bits;
+    const int32_t endChunkY = std::min<int32_t>(0xFFFF, chunkStartY + Floor::Mask + dormancyRange) >> Floor::Bits;
+
+    // collected first, replaying conditions can kill a monster and take it out of its chunk
+    thread_local std::vector<CreaturePtr> monsters;
+    monsters.clear();
+
+    for (int32_t chunkY = startChunkY; chunkY <= endChunkY; ++chunkY)
+    {
+        for (int32_t chunkX = startChunkX; chunkX <= endChunkX; ++chunkX)
+        {
+            const Chunk* chunk = chunk_grid.GetChunk(chunk_grid.FindChunk({ chunkX, chunkY }));
+            if (not chunk or chunk->monster_count == 0)
+                continue;
+
+            const auto first = chunk->creature_ptrs.begin() + chunk->player_count;
+            monsters.insert(monsters.end(), first, first + chunk->monster_count);
+        }
+    }
+
+    for (const auto& monster : monsters)
+        monster->wakeUp();
+
+    monsters.clear();
 }
 
 // Todo: Handroll this implementation out, building custom constructors for the spectators if we must, which will allow us to utilize the 
@@ -690,71 +852,150 @@ bool Map::isTileClear(const uint16_t x, const uint16_t y, const uint8_t z, const
     return not tile->hasProperty(CONST_PROP_BLOCKPROJECTILE);
 }
 
-namespace {
-
-bool checkSteepLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z)
+template <auto Nudge>
+bool Map::isLineClear(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, const uint8_t z, const std::array<uint64_t, BlackTek::World::MaxLayers> BlackTek::World::Chunk::* layers)
 {
-	const float dx = x1 - x0;
-	const float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
-	float yi = y0 + slope;
+    using namespace BlackTek::World;
 
-	for (uint16_t x = x0 + 1; x < x1; ++x) {
-		//0.1 is necessary to avoid loss of precision during calculation
-		if (!g_game.map.isTileClear(std::floor(yi + 0.1), x, z)) {
-			return false;
-		}
-		yi += slope;
-	}
+    if (x0 == x1 and y0 == y1)
+        return true;
 
-	return true;
+    if (z >= MaxLayers)
+        return true;
+
+    // walked along the major axis from its lower end, a steep line swaps the roles of x and y
+    const bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    const float dx = x1 - x0;
+    const float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
+    float yi = y0 + slope;
+
+    ChunkCoord layerCoord{ -1, -1 };
+    uint64_t layer = 0;
+
+    for (uint16_t x = x0 + 1; x < x1; ++x, yi += slope)
+    {
+        //0.1 is necessary to avoid loss of precision during calculation
+        const uint16_t y = static_cast<uint16_t>(std::floor(yi + Nudge));
+        const uint16_t tileX = steep ? y : x;
+        const uint16_t tileY = steep ? x : y;
+
+        // one chunk lookup for every stretch of the line inside of the same chunk
+        if (const ChunkCoord coord = ToChunkCoord(tileX, tileY); coord != layerCoord)
+        {
+            const Chunk* chunk = chunk_grid.GetChunk(chunk_grid.FindChunk(coord));
+            layer = chunk ? (chunk->*layers)[z] : 0;
+            layerCoord = coord;
+        }
+
+        if ((layer >> ((tileY & Floor::Mask) * Floor::Size + (tileX & Floor::Mask))) & 1u)
+            return false;
+    }
+
+    return true;
 }
 
-bool checkSlightLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z)
+template bool Map::isLineClear<0.1>(uint16_t, uint16_t, uint16_t, uint16_t, uint8_t, const std::array<uint64_t, BlackTek::World::MaxLayers> BlackTek::World::Chunk::*);
+template bool Map::isLineClear<0.1f>(uint16_t, uint16_t, uint16_t, uint16_t, uint8_t, const std::array<uint64_t, BlackTek::World::MaxLayers> BlackTek::World::Chunk::*);
+
+bool Map::checkSightLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z)
 {
-	const float dx = x1 - x0;
-	const float slope = (dx == 0) ? 1 : (y1 - y0) / dx;
-	float yi = y0 + slope;
+	return isLineClear<0.1>(x0, y0, x1, y1, z, &BlackTek::World::Chunk::block_projectile_mask);
+}
 
-	for (uint16_t x = x0 + 1; x < x1; ++x) {
-		//0.1 is necessary to avoid loss of precision during calculation
-		if (!g_game.map.isTileClear(x, std::floor(yi + 0.1), z)) {
-			return false;
-		}
-		yi += slope;
-	}
+std::optional<uint64_t> Map::sightCacheKey(const Position& fromPos, const Position& toPos, const SightQuery query)
+{
+    if (not g_dispatcher.isCurrentThread())
+        return std::nullopt;
 
-	return true;
+    const int32_t dx = toPos.x - fromPos.x;
+    const int32_t dy = toPos.y - fromPos.y;
+    if (dx < -128 or dx > 127 or dy < -128 or dy > 127)
+        return std::nullopt;
+
+    if (const uint64_t cycle = g_dispatcher.getDispatcherCycle(); cycle != sightCacheCycle)
+    {
+        sightCache.clear();
+        sightCacheCycle = cycle;
+    }
+
+    // from x, y and z, the offset to to, to z and the query: 16 + 16 + 4 + 8 + 8 + 4 + 2 bits
+    return uint64_t{ fromPos.x } | (uint64_t{ fromPos.y } << 16) | (uint64_t{ fromPos.z & 0xFu } << 32)
+        | (uint64_t{ static_cast<uint8_t>(dx) } << 36) | (uint64_t{ static_cast<uint8_t>(dy) } << 44)
+        | (uint64_t{ toPos.z & 0xFu } << 52) | (static_cast<uint64_t>(query) << 56);
 }
 
+void Map::invalidateSightCache()
+{
+    if (sightCache.empty())
+        return;
+
+    sightCache.clear();
+    ++sightCacheStats.invalidations;
 }
 
-bool Map::checkSightLine(const uint16_t x0, const uint16_t y0, const uint16_t x1, const uint16_t y1, const uint8_t z)
+bool Map::isSightClear(const Position& fromPos, const Position& toPos, const bool sameFloor /*= false*/)
 {
-	if (x0 == x1 && y0 == y1) {
+	// Return immediately true if the destination is the same as the current location
+	if (fromPos == toPos) {
 		return true;
 	}
 
-	if (std::abs(y1 - y0) > std::abs(x1 - x0)) {
-		if (y1 > y0) {
-			return checkSteepLine(y0, x0, y1, x1, z);
+	const auto key = sightCacheKey(fromPos, toPos, sameFloor ? SightQuery::SameFloor : SightQuery::AnyFloor);
+	if (key) {
+		if (const auto it = sightCache.find(*key); it != sightCache.end()) {
+			++sightCacheStats.hits;
+			return it->second;
 		}
-		return checkSteepLine(y1, x1, y0, x0, z);
+		++sightCacheStats.misses;
 	}
 
-	if (x0 > x1) {
-		return checkSlightLine(x1, y1, x0, y0, z);
+	const bool clear = traceSight(fromPos, toPos, sameFloor);
+	if (key && sightCache.size() < maxSightCacheEntries) {
+		sightCache.emplace(*key, clear);
 	}
-
-	return checkSlightLine(x0, y0, x1, y1, z);
+	return clear;
 }
 
-bool Map::isSightClear(const Position& fromPos, const Position& toPos, const bool sameFloor /*= false*/)
+bool Map::isAreaSightClear(const Position& fromPos, const Position& toPos)
 {
-	// Return immediately true if the destination is the same as the current location
-	if (fromPos == toPos) {
+	if (fromPos == toPos or fromPos.z != toPos.z)
+		return true;
+
+	if (std::abs(fromPos.x - toPos.x) < 2 and std::abs(fromPos.y - toPos.y) < 2)
 		return true;
+
+	const auto key = sightCacheKey(fromPos, toPos, SightQuery::Area);
+	if (key)
+	{
+		if (const auto it = sightCache.find(*key); it != sightCache.end())
+		{
+			++sightCacheStats.hits;
+			return it->second;
+		}
+		++sightCacheStats.misses;
 	}
 
+	const bool clear = isLineClear<0.1f>(fromPos.x, fromPos.y, toPos.x, toPos.y, fromPos.z, &BlackTek::World::Chunk::block_area_mask);
+	if (key and sightCache.size() < maxSightCacheEntries)
+		sightCache.emplace(*key, clear);
+
+	return clear;
+}
+
+bool Map::traceSight(const Position& fromPos, const Position& toPos, const bool sameFloor)
+{
 	// Cache differences to reduce function calls to position::getDistance
 	const auto diffX = std::abs(fromPos.x - toPos.x);
 	const auto diffY = std::abs(fromPos.y - toPos.y);
@@ -909,220 +1150,609 @@ namespace
 
 bool Map::getPathMatching(CreaturePtr& creature, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp)
 {
-    Position end_position;
-    auto position = creature->getPosition();
-    auto nodes = AStarNodes(position.x, position.y);
-    const auto& target_position = pathCondition.getTargetPos();
-    const auto manhattan_heuristic = [&](const int_fast32_t nx, const int_fast32_t ny) -> int_fast32_t
-    {
-        return (std::abs(nx - static_cast<int_fast32_t>(target_position.x)) +
-                std::abs(ny - static_cast<int_fast32_t>(target_position.y))) * MAP_NORMALWALKCOST;
-    };
-
-    int32_t best_match = 0;
+    return getPathMatching(creature, creature->getPosition(), dirList, pathCondition, fpp);
+}
 
-    static int_fast32_t dirNeighbors[8][5][2] = 
+namespace
+{
+    // The A* behind getPathMatching. stepCost(position, known) returns the extra cost of entering a tile or a
+    // negative value when it can't be entered; known is set for tiles that were entered before in this search.
+    template <typename StepCost>
+    bool findPathMatching(const Position& startPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp, StepCost&& stepCost)
     {
-        {{-1, 0}, {0, 1}, {1, 0}, {1, 1}, {-1, 1}},
-        {{-1, 0}, {0, 1}, {0, -1}, {-1, -1}, {-1, 1}},
-        {{-1, 0}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}},
-        {{0, 1}, {1, 0}, {0, -1}, {1, -1}, {1, 1}},
-        {{1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}},
-        {{-1, 0}, {0, -1}, {-1, -1}, {1, -1}, {-1, 1}},
-        {{0, 1}, {1, 0}, {1, -1}, {1, 1}, {-1, 1}},
-        {{-1, 0}, {0, 1}, {-1, -1}, {1, 1}, {-1, 1}}
-    };
-
-    static int_fast32_t allNeighbors[8][2] = {
-        {-1, 0}, {0, 1}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}, {-1, 1}
-    };
+        Position end_position;
+        auto position = startPos;
+        auto nodes = AStarNodes(position.x, position.y);
+        const auto& target_position = pathCondition.getTargetPos();
+        const auto manhattan_heuristic = [&](const int_fast32_t nx, const int_fast32_t ny) -> int_fast32_t
+        {
+            return (std::abs(nx - static_cast<int_fast32_t>(target_position.x)) +
+                    std::abs(ny - static_cast<int_fast32_t>(target_position.y))) * MAP_NORMALWALKCOST;
+        };
 
-    const Position start_position = position;
+        int32_t best_match = 0;
 
-    AStarNode* found = nullptr;
-    while (fpp.maxSearchDist != 0 or nodes.GetClosedNodes() < 100)
-    {
-        auto* node = nodes.GetBestNode();
-        if (not node)
+        static int_fast32_t dirNeighbors[8][5][2] = 
+        {
+            {{-1, 0}, {0, 1}, {1, 0}, {1, 1}, {-1, 1}},
+            {{-1, 0}, {0, 1}, {0, -1}, {-1, -1}, {-1, 1}},
+            {{-1, 0}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}},
+            {{0, 1}, {1, 0}, {0, -1}, {1, -1}, {1, 1}},
+            {{1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}},
+            {{-1, 0}, {0, -1}, {-1, -1}, {1, -1}, {-1, 1}},
+            {{0, 1}, {1, 0}, {1, -1}, {1, 1}, {-1, 1}},
+            {{-1, 0}, {0, 1}, {-1, -1}, {1, 1}, {-1, 1}}
+        };
+
+        static int_fast32_t allNeighbors[8][2] = {
+            {-1, 0}, {0, 1}, {1, 0}, {0, -1}, {-1, -1}, {1, -1}, {1, 1}, {-1, 1}
+        };
+
+        const Position start_position = position;
+
+        AStarNode* found = nullptr;
+        while (fpp.maxSearchDist != 0 or nodes.GetClosedNodes() < 100)
         {
-            if (found)
+            auto* node = nodes.GetBestNode();
+            if (not node)
             {
-                break;
+                if (found)
+                {
+                    break;
+                }
+                return false;
             }
-            return false;
-        }
 
-        const int_fast32_t x = node->x;
-        const int_fast32_t y = node->y;
-        position.x = x;
-        position.y = y;
+            const int_fast32_t x = node->x;
+            const int_fast32_t y = node->y;
+            position.x = x;
+            position.y = y;
 
-        if (pathCondition(start_position, position, fpp, best_match))
-        {
-            found = node;
-            end_position = position;
-            if (best_match == 0)
+            if (pathCondition(start_position, position, fpp, best_match))
+            {
+                found = node;
+                end_position = position;
+                if (best_match == 0)
+                {
+                    break;
+                }
+            }
+
+            uint_fast32_t direction_count;
+            int_fast32_t* neighbors;
+
+            if (node->parent)
             {
-                break;
+                const int_fast32_t x_offset = node->parent->x - x;
+                const int_fast32_t y_offset = node->parent->y - y;
+
+                if (y_offset == 0)
+                {
+                    neighbors = (x_offset == -1) ? *dirNeighbors[DIRECTION_WEST]
+                                                : *dirNeighbors[DIRECTION_EAST];
+                }
+                else if (not fpp.allowDiagonal or x_offset == 0)
+                {
+                    neighbors = (y_offset == -1) ? *dirNeighbors[DIRECTION_NORTH]
+                                                : *dirNeighbors[DIRECTION_SOUTH];
+                }
+                else if (y_offset == -1)
+                {
+                    neighbors = (x_offset == -1) ? *dirNeighbors[DIRECTION_NORTHWEST]
+                                                : *dirNeighbors[DIRECTION_NORTHEAST];
+                }
+                else
+                {
+                    neighbors = (x_offset == -1) ? *dirNeighbors[DIRECTION_SOUTHWEST]
+                                                : *dirNeighbors[DIRECTION_SOUTHEAST];
+                }
+
+                direction_count = fpp.allowDiagonal ? 5 : 3;
+            }
+            else
+            {
+                direction_count = 8;
+                neighbors = *allNeighbors;
+            }
+
+            const int_fast32_t parent_g_score = node->g_score;
+
+            for (uint_fast32_t i = 0; i < direction_count; ++i)
+            {
+                position.x = x + *neighbors++;
+                position.y = y + *neighbors++;
+
+                if (fpp.maxSearchDist != 0
+                    and (Position::getDistanceX(start_position, position) > fpp.maxSearchDist
+                    or Position::getDistanceY(start_position, position) > fpp.maxSearchDist))
+                {
+                    continue;
+                }
+
+                if (fpp.keepDistance and not pathCondition.isInRange(start_position, position, fpp))
+                {
+                    continue;
+                }
+
+                auto* neighbor_node = nodes.GetNodeByPosition(position.x, position.y);
+                const int_fast32_t extra_cost = stepCost(position, neighbor_node != nullptr);
+
+                if (extra_cost < 0)
+                {
+                    continue;
+                }
+
+                const int_fast32_t cost = AStarNodes::GetMapWalkCost(node, position);
+                const int_fast32_t neighbor_g_score = parent_g_score + cost + extra_cost;
+                const int_fast32_t neighbor_h_score = manhattan_heuristic(position.x, position.y);
+                const int_fast32_t neighbor_f_score = neighbor_g_score + neighbor_h_score;
+
+                if (neighbor_node)
+                {
+                    if (neighbor_node->f <= neighbor_f_score)
+                    {
+                        // Existing path is at least as cheap so lets skip it
+                        continue;
+                    }
+                    neighbor_node->f = neighbor_f_score;
+                    neighbor_node->g_score = neighbor_g_score;
+                    neighbor_node->parent = node;
+                    // Sifts the node up in the min-heap
+                    nodes.OpenNode(neighbor_node);
+                }
+                else
+                {
+                    neighbor_node = nodes.CreateOpenNode(node, position.x, position.y, neighbor_f_score, neighbor_g_score);
+                    if (not neighbor_node)
+                    {
+                        if (found)
+                        {
+                            break;
+                        }
+                        return false;
+                    }
+                }
             }
+
+            nodes.CloseNode(node);
         }
 
-        uint_fast32_t direction_count;
-        int_fast32_t* neighbors;
+        if (not found)
+        {
+            return false;
+        }
 
-        if (node->parent)
+        int_fast32_t prevx = end_position.x;
+        int_fast32_t prevy = end_position.y;
+        found = found->parent;
+
+        while (found)
         {
-            const int_fast32_t x_offset = node->parent->x - x;
-            const int_fast32_t y_offset = node->parent->y - y;
+            position.x = found->x;
+            position.y = found->y;
+
+            const int_fast32_t dx = position.getX() - prevx;
+            const int_fast32_t dy = position.getY() - prevy;
+
+            prevx = position.x;
+            prevy = position.y;
 
-            if (y_offset == 0)
+            if (dx == 1 and dy == 1)
             {
-                neighbors = (x_offset == -1) ? *dirNeighbors[DIRECTION_WEST]
-                                            : *dirNeighbors[DIRECTION_EAST];
+                dirList.push_back(DIRECTION_NORTHWEST);
             }
-            else if (not fpp.allowDiagonal or x_offset == 0)
+            else if (dx == -1 and dy == 1)
             {
-                neighbors = (y_offset == -1) ? *dirNeighbors[DIRECTION_NORTH]
-                                            : *dirNeighbors[DIRECTION_SOUTH];
+                dirList.push_back(DIRECTION_NORTHEAST);
             }
-            else if (y_offset == -1)
+            else if (dx == 1 and dy == -1)
             {
-                neighbors = (x_offset == -1) ? *dirNeighbors[DIRECTION_NORTHWEST]
-                                            : *dirNeighbors[DIRECTION_NORTHEAST];
+                dirList.push_back(DIRECTION_SOUTHWEST);
             }
-            else
+            else if (dx == -1 and dy == -1)
+            {
+                dirList.push_back(DIRECTION_SOUTHEAST);
+            }
+            else if (dx == 1)
+            {
+                dirList.push_back(DIRECTION_WEST);
+            }
+            else if (dx == -1)
             {
-                neighbors = (x_offset == -1) ? *dirNeighbors[DIRECTION_SOUTHWEST]
-                                            : *dirNeighbors[DIRECTION_SOUTHEAST];
+                dirList.push_back(DIRECTION_EAST);
+            }
+            else if (dy == 1)
+            {
+                dirList.push_back(DIRECTION_NORTH);
+            }
+            else if (dy == -1)
+            {
+                dirList.push_back(DIRECTION_SOUTH);
             }
 
-            direction_count = fpp.allowDiagonal ? 5 : 3;
+            found = found->parent;
         }
-        else
+        return true;
+    }
+}
+
+bool Map::getPathMatching(CreaturePtr& creature, const Position& startPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp)
+{
+    return findPathMatching(startPos, dirList, pathCondition, fpp, [&](const Position& position, const bool known) -> int_fast32_t {
+        const TilePtr& tile = known ? getTile(position.x, position.y, position.z) : canWalkTo(creature, position);
+        return tile ? AStarNodes::GetTileWalkCost(creature, tile) : -1;
+    });
+}
+
+bool Map::getPathMatching(const BlackTek::World::WalkSnapshot& snapshot, const Position& startPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp)
+{
+    return findPathMatching(startPos, dirList, pathCondition, fpp, [&snapshot](const Position& position, bool) -> int_fast32_t {
+        return snapshot.IsBlocked(position.x, position.y) ? -1 : 0;
+    });
+}
+
+bool Map::getHierarchicalPath(CreaturePtr& creature, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp)
+{
+    using BlackTek::World::Floor;
+
+    // how far apart two waypoints may be for one refining search
+    static constexpr int32_t refineDistance = Floor::Size * 2;
+
+    const Position startPos = creature->getPosition();
+    const Position& targetPos = pathCondition.getTargetPos();
+
+    // anything up to two chunks away is left to the plain A*, as are targets already in range
+    const int32_t distance = std::max(Position::getDistanceX(startPos, targetPos), Position::getDistanceY(startPos, targetPos));
+    if (distance <= refineDistance or distance <= fpp.maxTargetDist)
+    {
+        return false;
+    }
+
+    thread_local std::vector<Position> waypoints;
+    if (not path_graph.FindRoute(*this, startPos, targetPos, fpp.maxSearchDist, waypoints))
+    {
+        return false;
+    }
+
+    FindPathParams segmentParams;
+    segmentParams.fullPathSearch = true;
+    segmentParams.clearSight = false;
+    segmentParams.allowDiagonal = fpp.allowDiagonal;
+    segmentParams.maxSearchDist = refineDistance;
+    segmentParams.minTargetDist = 0;
+    segmentParams.maxTargetDist = 0;
+
+    // segments come back destination first like every path, collect them in walking order
+    thread_local std::vector<Direction> route;
+    thread_local std::vector<Direction> segment;
+    route.clear();
+
+    Position current = startPos;
+    for (size_t next = 0; next < waypoints.size();)
+    {
+        // the furthest waypoint one search can still reach
+        size_t pick = next;
+        while (pick + 1 < waypoints.size()
+            and std::max(Position::getDistanceX(current, waypoints[pick + 1]), Position::getDistanceY(current, waypoints[pick + 1])) <= refineDistance)
+        {
+            ++pick;
+        }
+
+        segment.clear();
+        if (not getPathMatching(creature, current, segment, FrozenPathingConditionCall(waypoints[pick]), segmentParams))
+        {
+            return false;
+        }
+
+        route.insert(route.end(), segment.rbegin(), segment.rend());
+        current = waypoints[pick];
+        next = pick + 1;
+    }
+
+    // the last piece is matched against the caller's condition
+    FindPathParams finalParams = fpp;
+    finalParams.maxSearchDist = refineDistance;
+
+    segment.clear();
+    if (not getPathMatching(creature, current, segment, pathCondition, finalParams))
+    {
+        return false;
+    }
+
+    route.insert(route.end(), segment.rbegin(), segment.rend());
+    dirList.insert(dirList.end(), route.rbegin(), route.rend());
+    return true;
+}
+
+bool Map::getFlowFieldPath(CreaturePtr& creature, const uint32_t targetId, const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp)
+{
+    const Position startPos = creature->getPosition();
+    if (startPos.z != targetPos.z)
+    {
+        return false;
+    }
+
+    const auto& field = flow_fields.Get(*this, targetId, targetPos, OTSYS_TIME() / EVENT_CREATURE_THINK_INTERVAL);
+
+    static constexpr struct { int32_t x, y; Direction direction; } steps[8] = {
+        {-1, 0, DIRECTION_WEST}, {0, 1, DIRECTION_SOUTH}, {1, 0, DIRECTION_EAST}, {0, -1, DIRECTION_NORTH},
+        {-1, -1, DIRECTION_NORTHWEST}, {1, -1, DIRECTION_NORTHEAST}, {1, 1, DIRECTION_SOUTHEAST}, {-1, 1, DIRECTION_SOUTHWEST}
+    };
+
+    const int32_t stopDistance = std::max<int32_t>(fpp.maxTargetDist, 1);
+    const size_t firstStep = dirList.size();
+
+    Position position = startPos;
+    uint16_t current = field.DistanceAt(position.x, position.y);
+
+    while (std::max(Position::getDistanceX(position, targetPos), Position::getDistanceY(position, targetPos)) > stopDistance)
+    {
+        // steepest step first, the next best ones when a creature or a field is in the way
+        std::array<std::pair<uint16_t, uint8_t>, 8> candidates;
+        size_t candidateCount = 0;
+
+        for (uint8_t i = 0; i < (fpp.allowDiagonal ? 8 : 4); ++i)
         {
-            direction_count = 8;
-            neighbors = *allNeighbors;
+            const uint16_t distance = field.DistanceAt(position.x + steps[i].x, position.y + steps[i].y);
+            if (distance < current)
+            {
+                candidates[candidateCount++] = { distance, i };
+            }
         }
 
-        const int_fast32_t parent_g_score = node->g_score;
+        std::sort(candidates.begin(), candidates.begin() + candidateCount);
 
-        for (uint_fast32_t i = 0; i < direction_count; ++i)
+        bool moved = false;
+        for (size_t i = 0; i < candidateCount and not moved; ++i)
         {
-            position.x = x + *neighbors++;
-            position.y = y + *neighbors++;
+            const auto& step = steps[candidates[i].second];
+            const Position next(position.x + step.x, position.y + step.y, position.z);
 
             if (fpp.maxSearchDist != 0
-                and (Position::getDistanceX(start_position, position) > fpp.maxSearchDist
-                or Position::getDistanceY(start_position, position) > fpp.maxSearchDist))
+                and (Position::getDistanceX(startPos, next) > fpp.maxSearchDist
+                or Position::getDistanceY(startPos, next) > fpp.maxSearchDist))
             {
                 continue;
             }
 
-            if (fpp.keepDistance and not pathCondition.isInRange(start_position, position, fpp))
+            if (not canWalkTo(creature, next))
             {
                 continue;
             }
 
-            auto* neighbor_node = nodes.GetNodeByPosition(position.x, position.y);
-            const TilePtr& tile = neighbor_node ? getTile(position.x, position.y, position.z) : canWalkTo(creature, position);
+            dirList.push_back(step.direction);
+            position = next;
+            current = candidates[i].first;
+            moved = true;
+        }
 
-            if (not tile)
-            {
-                continue;
-            }
+        if (not moved)
+        {
+            dirList.resize(firstStep);
+            ++flow_fields.stats.fallbacks;
+            return false;
+        }
+    }
+
+    // same order getPathMatching produces, the first step is taken from the back
+    std::reverse(dirList.begin() + firstStep, dirList.end());
 
-            const int_fast32_t cost = AStarNodes::GetMapWalkCost(node, position);
-            const int_fast32_t extra_cost = AStarNodes::GetTileWalkCost(creature, tile);
-            const int_fast32_t neighbor_g_score = parent_g_score + cost + extra_cost;
-            const int_fast32_t neighbor_h_score = manhattan_heuristic(position.x, position.y);
-            const int_fast32_t neighbor_f_score = neighbor_g_score + neighbor_h_score;
+    ++flow_fields.stats.paths;
+    return true;
+}
+
+void Map::runFlowFieldBenchmark(const Position& target, const uint32_t followerCount, std::string monsterName, const uint32_t rounds)
+{
+    if (monsterName.empty() and not g_monsters.monsters.empty())
+    {
+        monsterName = g_monsters.monsters.begin()->first;
+    }
 
-            if (neighbor_node)
+    // followers take the free tiles around the target, nearest ring first
+    std::vector<CreaturePtr> followers;
+    for (int32_t radius = 2; radius <= 9 and followers.size() < followerCount; ++radius)
+    {
+        for (int32_t dy = -radius; dy <= radius and followers.size() < followerCount; ++dy)
+        {
+            for (int32_t dx = -radius; dx <= radius and followers.size() < followerCount; ++dx)
             {
-                if (neighbor_node->f <= neighbor_f_score)
+                if (std::max(std::abs(dx), std::abs(dy)) != radius)
                 {
-                    // Existing path is at least as cheap so lets skip it
                     continue;
                 }
-                neighbor_node->f = neighbor_f_score;
-                neighbor_node->g_score = neighbor_g_score;
-                neighbor_node->parent = node;
-                // Sifts the node up in the min-heap
-                nodes.OpenNode(neighbor_node);
-            }
-            else
-            {
-                neighbor_node = nodes.CreateOpenNode(node, position.x, position.y, neighbor_f_score, neighbor_g_score);
-                if (not neighbor_node)
+
+                const Position pos(target.x + dx, target.y + dy, target.z);
+                const auto& tile = getTile(pos);
+                if (not tile or not tile->getGround() or tile->getCreatureCount() != 0
+                    or tile->hasFlag(TILESTATE_BLOCKSOLID | TILESTATE_BLOCKPATH | TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT))
                 {
-                    if (found)
-                    {
-                        break;
-                    }
-                    return false;
+                    continue;
                 }
-            }
-        }
 
-        nodes.CloseNode(node);
-    }
+                CreaturePtr follower = Monster::createMonster(monsterName);
+                if (not follower)
+                {
+                    fmt::print("\n    Flow field benchmark: unknown monster \"{}\"\n\n", monsterName);
+                    return;
+                }
 
-    if (not found)
-    {
-        return false;
+                if (placeCreature(pos, follower, false, true))
+                {
+                    followers.push_back(std::move(follower));
+                }
+            }
+        }
     }
 
-    int_fast32_t prevx = end_position.x;
-    int_fast32_t prevy = end_position.y;
-    found = found->parent;
+    FindPathParams fpp;
+    fpp.fullPathSearch = true;
+    fpp.clearSight = false;
+    fpp.maxSearchDist = 12;
+    fpp.minTargetDist = 1;
+    fpp.maxTargetDist = 1;
 
-    while (found)
-    {
-        position.x = found->x;
-        position.y = found->y;
+    const FrozenPathingConditionCall pathCondition(target);
+    std::vector<Direction> dirList;
 
-        const int_fast32_t dx = position.getX() - prevx;
-        const int_fast32_t dy = position.getY() - prevy;
-
-        prevx = position.x;
-        prevy = position.y;
+    using Clock = std::chrono::steady_clock;
+    auto microsPerRound = [rounds](Clock::duration elapsed) {
+        return std::chrono::duration<double, std::micro>(elapsed).count() / rounds;
+    };
 
-        if (dx == 1 and dy == 1)
-        {
-            dirList.push_back(DIRECTION_NORTHWEST);
-        }
-        else if (dx == -1 and dy == 1)
-        {
-            dirList.push_back(DIRECTION_NORTHEAST);
-        }
-        else if (dx == 1 and dy == -1)
-        {
-            dirList.push_back(DIRECTION_SOUTHWEST);
-        }
-        else if (dx == -1 and dy == -1)
+    uint64_t aStarPaths = 0;
+    auto start = Clock::now();
+    for (uint32_t round = 0; round < rounds; ++round)
+    {
+        for (auto& follower : followers)
         {
-            dirList.push_back(DIRECTION_SOUTHEAST);
+            dirList.clear();
+            aStarPaths += getPathMatching(follower, dirList, pathCondition, fpp) ? 1 : 0;
         }
-        else if (dx == 1)
+    }
+    const double aStarMicros = microsPerRound(Clock::now() - start);
+
+    const auto statsBefore = flow_fields.stats;
+    uint64_t flowPaths = 0;
+    start = Clock::now();
+    for (uint32_t round = 0; round < rounds; ++round)
+    {
+        // every round is a new tick, the field is built again
+        flow_fields.Clear();
+        for (auto& follower : followers)
         {
-            dirList.push_back(DIRECTION_WEST);
+            dirList.clear();
+            flowPaths += (getFlowFieldPath(follower, 0, target, dirList, fpp) or getPathMatching(follower, dirList, pathCondition, fpp)) ? 1 : 0;
         }
-        else if (dx == -1)
+    }
+    const double flowMicros = microsPerRound(Clock::now() - start);
+    const auto& statsAfter = flow_fields.stats;
+
+    fmt::print("\n    Flow field benchmark at [x: {}, y: {}, z: {}]: {} followers ({}), {} rounds\n\n",
+        target.x, target.y, static_cast<int32_t>(target.z), followers.size(), monsterName, rounds);
+    fmt::print("    {:<28} {:>12.1f} us per tick, {:.1f} paths\n", "A* per follower", aStarMicros, static_cast<double>(aStarPaths) / rounds);
+    fmt::print("    {:<28} {:>12.1f} us per tick, {:.1f} paths {:>7.2f}x\n", "shared flow field", flowMicros, static_cast<double>(flowPaths) / rounds, aStarMicros / flowMicros);
+    fmt::print("    {:<28} {:>12.1f} us per build, {:.1f} A* fallbacks per tick\n\n", "",
+        static_cast<double>(statsAfter.buildNanos - statsBefore.buildNanos) / 1000.0 / std::max<uint64_t>(statsAfter.builds - statsBefore.builds, 1),
+        static_cast<double>(statsAfter.fallbacks - statsBefore.fallbacks) / rounds);
+
+    for (auto& follower : followers)
+    {
+        follower->getTile()->removeCreature(follower);
+    }
+    flow_fields.Clear();
+}
+
+void Map::runSightBenchmark(const Position& center, const uint32_t casts)
+{
+    // a handful of area centers around center, as when a group of monsters keeps bombarding the same players
+    std::array<Position, 16> areaCenters;
+    for (auto& areaCenter : areaCenters)
+    {
+        areaCenter = Position(static_cast<uint16_t>(std::clamp<int32_t>(center.x + uniform_random(-5, 5), 0, 0xFFFF)),
+            static_cast<uint16_t>(std::clamp<int32_t>(center.y + uniform_random(-5, 5), 0, 0xFFFF)), center.z);
+    }
+
+    // what Combat::IsAreaSightClear did before the bitmaps, a tile lookup for every step of the line
+    const auto tileLine = [this](const Position& from, const Position& to) {
+        if (from == to or (std::abs(from.x - to.x) < 2 and std::abs(from.y - to.y) < 2))
+            return true;
+
+        const bool steep = std::abs(to.y - from.y) > std::abs(to.x - from.x);
+        uint16_t x0 = steep ? from.y : from.x, y0 = steep ? from.x : from.y;
+        uint16_t x1 = steep ? to.y : to.x, y1 = steep ? to.x : to.y;
+        if (x0 > x1)
         {
-            dirList.push_back(DIRECTION_EAST);
+            std::swap(x0, x1);
+            std::swap(y0, y1);
         }
-        else if (dy == 1)
+
+        const float dx = x1 - x0;
+        const float slope = (dx == 0.0f) ? 1.0f : (y1 - y0) / dx;
+        float yi = y0 + slope;
+        for (uint16_t x = x0 + 1; x < x1; ++x, yi += slope)
         {
-            dirList.push_back(DIRECTION_NORTH);
+            const auto y = static_cast<uint16_t>(std::floor(yi + 0.1f));
+            if (const auto& tile = getTile(steep ? y : x, steep ? x : y, from.z); tile and tile->blocksArea())
+                return false;
         }
-        else if (dy == -1)
+        return true;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    fmt::print("\n    Sight benchmark at [x: {}, y: {}, z: {}]: {} area spells of each size\n",
+        center.x, center.y, static_cast<int32_t>(center.z), casts);
+
+    for (const int32_t radius : { 3, 4 })
+    {
+        const uint64_t lines = static_cast<uint64_t>(casts) * (radius * 2 + 1) * (radius * 2 + 1);
+        auto nanosPerLine = [lines](Clock::duration elapsed) {
+            return std::chrono::duration<double, std::nano>(elapsed).count() / lines;
+        };
+
+        const auto forEachLine = [&](auto&& check) {
+            uint64_t clear = 0;
+            for (uint32_t cast = 0; cast < casts; ++cast)
+            {
+                const Position& areaCenter = areaCenters[cast % areaCenters.size()];
+                for (int32_t dy = -radius; dy <= radius; ++dy)
+                {
+                    for (int32_t dx = -radius; dx <= radius; ++dx)
+                    {
+                        const Position to(static_cast<uint16_t>(std::clamp<int32_t>(areaCenter.x + dx, 0, 0xFFFF)),
+                            static_cast<uint16_t>(std::clamp<int32_t>(areaCenter.y + dy, 0, 0xFFFF)), areaCenter.z);
+                        clear += check(areaCenter, to) ? 1 : 0;
+                    }
+                }
+            }
+            return clear;
+        };
+
+        auto start = Clock::now();
+        const uint64_t tileClear = forEachLine(tileLine);
+        const double tileNanos = nanosPerLine(Clock::now() - start);
+
+        start = Clock::now();
+        const uint64_t bitmapClear = forEachLine([this](const Position& from, const Position& to) {
+            if (from == to or (std::abs(from.x - to.x) < 2 and std::abs(from.y - to.y) < 2))
+                return true;
+            return isLineClear<0.1f>(from.x, from.y, to.x, to.y, from.z, &BlackTek::World::Chunk::block_area_mask);
+        });
+        const double bitmapNanos = nanosPerLine(Clock::now() - start);
+
+        // the whole benchmark is one dispatcher cycle, the memo starts out empty for every size
+        sightCache.clear();
+        const auto statsBefore = sightCacheStats;
+        start = Clock::now();
+        const uint64_t memoClear = forEachLine([this](const Position& from, const Position& to) { return isAreaSightClear(from, to); });
+        const double memoNanos = nanosPerLine(Clock::now() - start);
+        const uint64_t hits = sightCacheStats.hits - statsBefore.hits;
+        const uint64_t lookups = hits + sightCacheStats.misses - statsBefore.misses;
+
+        size_t mismatches = 0;
+        for (const auto& areaCenter : areaCenters)
         {
-            dirList.push_back(DIRECTION_SOUTH);
+            for (int32_t dy = -radius; dy <= radius; ++dy)
+            {
+                for (int32_t dx = -radius; dx <= radius; ++dx)
+                {
+                    const Position to(static_cast<uint16_t>(std::clamp<int32_t>(areaCenter.x + dx, 0, 0xFFFF)),
+                        static_cast<uint16_t>(std::clamp<int32_t>(areaCenter.y + dy, 0, 0xFFFF)), areaCenter.z);
+                    mismatches += tileLine(areaCenter, to) != isAreaSightClear(areaCenter, to) ? 1 : 0;
+                }
+            }
         }
 
-        found = found->parent;
+        fmt::print("\n    {}x{} areas, {} lines\n", radius * 2 + 1, radius * 2 + 1, lines);
+        fmt::print("    {:<28} {:>10.2f} ns per line, {} clear\n", "tile lookups", tileNanos, tileClear);
+        fmt::print("    {:<28} {:>10.2f} ns per line, {} clear {:>7.2f}x\n", "chunk bitmaps", bitmapNanos, bitmapClear, tileNanos / bitmapNanos);
+        fmt::print("    {:<28} {:>10.2f} ns per line, {} clear {:>7.2f}x, {:.1f}% hits\n", "chunk bitmaps + cycle memo", memoNanos, memoClear, tileNanos / memoNanos,
+            lookups ? 100.0 * static_cast<double>(hits) / static_cast<double>(lookups) : 0.0);
+        fmt::print("    {:<28} {:>10} of {} lines disagree\n", "", mismatches, areaCenters.size() * (radius * 2 + 1) * (radius * 2 + 1));
     }
-    return true;
+
+    fmt::print("\n");
+    sightCache.clear();
 }
 
 AStarNodes::AStarNodes(uint32_t x, uint32_t y) : heap_size(1), current_node(1), closed_nodes(0)
@@ -17,6 +17,10 @@
 #include "chunk.h"
 #include "chunkgrid.h"
 #include "floorpool.h"
+#include "flowfield.h"
+#include "pathgraph.h"
+
+#include <gtl/phmap.hpp>
 
 class Creature;
 class Player;
@@ -25,6 +29,8 @@ class Tile;
 class Map;
 
 struct FindPathParams;
+
+namespace BlackTek::World { class MapSnapshot; class WalkSnapshot; }
 struct AStarNode {
 	AStarNode* parent;
 	int_fast32_t f;        // f = g_score + h_score, used for heap ordering
@@ -70,6 +76,40 @@ class AStarNodes
 
 class FrozenPathingConditionCall;
 
+struct MapLoadStats
+{
+	int64_t time;
+	uint32_t dimensions;
+	uint32_t tileCount;
+	uint64_t itemCount;
+
+	// per phase, in milliseconds; the commit phase only exists when tile areas were parsed in parallel
+	int64_t treeTime = 0;
+	int64_t tileParseTime = 0;
+	int64_t commitTime = 0;
+	uint32_t workerCount = 1;
+	// tiles the workers handed back to the commit phase (house tiles, beds, augmented items)
+	uint32_t serialTileCount = 0;
+	// materialized from the pre-baked snapshot instead of the OTBM file; tileParseTime covers it
+	bool fromSnapshot = false;
+};
+
+struct SpectatorCacheStats
+{
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	// cached results dropped before the end of their cycle because a creature entered, left or moved in one of their chunks
+	uint64_t invalidations = 0;
+};
+
+struct SightCacheStats
+{
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	// times the cached results were dropped before the end of their cycle because a tile changed its blocking bits
+	uint64_t invalidations = 0;
+};
+
 class Map
 {
 	public:
@@ -77,6 +117,8 @@ class Map
 		static constexpr int32_t maxViewportY = 11; //min value: maxClientViewportY + 1
 		static constexpr int32_t maxClientViewportX = 8;
 		static constexpr int32_t maxClientViewportY = 6;
+		// view range plus the largest x/y offset between two floors a player sees at once
+		static constexpr int32_t dormancyRange = maxViewportX + 7;
 
 		static uint32_t clean();
 		bool loadMap(const std::string& identifier, bool loadHouses);
@@ -106,9 +148,55 @@ class Map
 		bool canThrowObjectTo(const Position& fromPos, const Position& toPos, bool checkLineOfSight = true, bool sameFloor = false, int32_t rangex = Map::maxClientViewportX, int32_t rangey = Map::maxClientViewportY);
 		bool isTileClear(uint16_t x, uint16_t y, uint8_t z, bool blockFloor = false);
 		bool isSightClear(const Position& fromPos, const Position& toPos, bool sameFloor = false);
-		static bool checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z);
+		// Whether an area spell centered on from spreads to to, see Combat::IsAreaSightClear
+		bool isAreaSightClear(const Position& fromPos, const Position& toPos);
+		bool checkSightLine(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z);
+
+		// Whether the tiles strictly between (x0, y0) and (x1, y1) are clear in one of the chunk blocking
+		// bitmaps, on the line the sight checks have always walked. Nudge is added before flooring the minor
+		// axis, the map rounds it in double and the area spells in float.
+		template <auto Nudge>
+		bool isLineClear(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint8_t z, const std::array<uint64_t, BlackTek::World::MaxLayers> BlackTek::World::Chunk::* layers);
 		const TilePtr& canWalkTo(CreaturePtr& creature, const Position& pos);
 		bool getPathMatching(CreaturePtr& creature, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp);
+		bool getPathMatching(CreaturePtr& creature, const Position& startPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp);
+		// Same search against a walk snapshot, safe to run off the dispatcher as long as fpp.clearSight is off.
+		// Creatures and blocking items in the snapshot can't be entered, nothing else adds to the cost.
+		static bool getPathMatching(const BlackTek::World::WalkSnapshot& snapshot, const Position& startPos, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp);
+
+		// For targets further away than the tile A* can reasonably search: routes over the chunk graph first and
+		// refines the route with short getPathMatching searches. False for short paths and when no route exists.
+		bool getHierarchicalPath(CreaturePtr& creature, std::vector<Direction>& dirList, const FrozenPathingConditionCall& pathCondition, const FindPathParams& fpp);
+
+		// Path for a melee follower sampled from the flow field shared by everyone following targetId this think
+		// interval. False when the field can't lead the creature there, the caller falls back to getPathMatching.
+		bool getFlowFieldPath(CreaturePtr& creature, uint32_t targetId, const Position& targetPos, std::vector<Direction>& dirList, const FindPathParams& fpp);
+		const BlackTek::World::FlowFieldStats& getFlowFieldStats() const { return flow_fields.stats; }
+
+		// Places followerCount monsters around target and compares A* for every follower with the shared flow
+		// field, per tick. Runs on the loaded map before the game starts; the monsters are removed again.
+		void runFlowFieldBenchmark(const Position& target, uint32_t followerCount, std::string monsterName, uint32_t rounds = 100);
+
+		// Drops the cached spectator results that scanned the chunk holding (x, y). Has to be called whenever
+		// a creature is added to, removed from or moved within a chunk's creature lists.
+		void invalidateSpectatorCache(uint16_t x, uint16_t y);
+		const SpectatorCacheStats& getSpectatorCacheStats() const { return spectatorCacheStats; }
+
+		// Drops the sight results cached this dispatcher cycle. Has to be called whenever a projectile or area
+		// blocking bit of a chunk changes.
+		void invalidateSightCache();
+		const SightCacheStats& getSightCacheStats() const { return sightCacheStats; }
+
+		// Times the area spell sight lines of casts 7x7 and 9x9 squares around center, walking tiles against
+		// the chunk bitmaps, and the memo for repeated lines. Runs on the loaded map before the game starts.
+		void runSightBenchmark(const Position& center, uint32_t casts = 10000);
+
+		// Whether any chunk within dormancyRange of pos holds a player, on any floor. Monsters don't sleep
+		// while it does.
+		bool hasPlayersNear(const Position& pos);
+		// Wakes the sleeping monsters for which a player in the chunk holding pos is near, called whenever
+		// a player enters a chunk.
+		void wakeMonstersNear(const Position& pos);
 
 		std::map<std::string, Position> waypoints;
 
@@ -130,19 +218,52 @@ class Map
 		std::filesystem::path otbmFilePath;
 		std::vector<Zones::LegacyZoneFlagTile> legacyZoneFlagTiles;
 
-		int64_t  lastLoadTimeSeconds = 0;
-		uint32_t lastLoadTileCount = 0;
-		uint64_t lastLoadItemCount = 0;
+		MapLoadStats lastLoadStats{};
 
 	private:
 		BlackTek::World::ChunkGrid chunk_grid;
 		BlackTek::World::FloorPool floor_pool;
 
+		BlackTek::World::FlowFieldCache flow_fields;
+		BlackTek::World::PathGraph path_graph;
+
 		std::filesystem::path housefile;
 
 		uint32_t width = 0;
 		uint32_t height = 0;
 
+		// Results of the spectator queries made during the current dispatcher cycle, keyed by their normalized
+		// ranges. Only the dispatcher thread reads or writes it.
+		struct SpectatorCacheEntry
+		{
+			Position centerPos;
+			int32_t minRangeX, maxRangeX, minRangeY, maxRangeY, minRangeZ, maxRangeZ;
+			bool onlyPlayers;
+			// chunks the scan covered
+			int32_t startChunkX, startChunkY, endChunkX, endChunkY;
+			SpectatorVec spectators;
+		};
+
+		static constexpr size_t maxSpectatorCacheEntries = 64;
+
+		std::vector<SpectatorCacheEntry> spectatorCache;
+		uint64_t spectatorCacheCycle = 0;
+		SpectatorCacheStats spectatorCacheStats;
+
+		// Results of the sight checks made during the current dispatcher cycle, keyed by sightCacheKey. Only the
+		// dispatcher thread reads or writes it.
+		enum class SightQuery : uint64_t { AnyFloor, SameFloor, Area };
+
+		static constexpr size_t maxSightCacheEntries = 4096;
+
+		gtl::flat_hash_map<uint64_t, bool> sightCache;
+		uint64_t sightCacheCycle = 0;
+		SightCacheStats sightCacheStats;
+
+		// empty for checks made off the dispatcher thread or between positions too far apart to pack
+		std::optional<uint64_t> sightCacheKey(const Position& fromPos, const Position& toPos, SightQuery query);
+		bool traceSight(const Position& fromPos, const Position& toPos, bool sameFloor);
+
 		// Actually scans the map for spectators
 		void getSpectatorsInternal(SpectatorVec& spectators, const Position& centerPos,
 		                           int32_t minRangeX, int32_t maxRangeX,
@@ -151,6 +272,7 @@ class Map
 
 		friend class Game;
 		friend class IOMap;
+		friend class BlackTek::World::MapSnapshot;
 };
 
 #endif
@@ -0,0 +1,472 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "mapsnapshot.h"
+#include "iomap.h"
+
+#include <fstream>
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    class SnapshotBuffer
+    {
+    public:
+        template <typename T>
+        void Write(T value)
+        {
+            const auto* raw = reinterpret_cast<const char*>(&value);
+            bytes.insert(bytes.end(), raw, raw + sizeof(T));
+        }
+
+        template <typename T>
+        void Patch(size_t offset, T value)
+        {
+            std::memcpy(bytes.data() + offset, &value, sizeof(T));
+        }
+
+        bool WriteString(std::string_view str)
+        {
+            if (str.size() > std::numeric_limits<uint16_t>::max())
+                return false;
+
+            Write(static_cast<uint16_t>(str.size()));
+            bytes.insert(bytes.end(), str.begin(), str.end());
+            return true;
+        }
+
+        bool WriteStream(PropStream& stream)
+        {
+            const size_t start = bytes.size();
+            bytes.resize(start + stream.size());
+            return stream.readBytes(std::as_writable_bytes(std::span(bytes).subspan(start)));
+        }
+
+        [[nodiscard]] size_t Size() const { return bytes.size(); }
+        [[nodiscard]] const char* Data() const { return bytes.data(); }
+
+    private:
+        std::vector<char> bytes;
+    };
+
+    // 64 bit multiply-xorshift over whole words; fast enough to hash the map on every startup
+    uint64_t MixWord(uint64_t hash, uint64_t word)
+    {
+        hash ^= word;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        return hash ^ (hash >> 31);
+    }
+
+    bool HashFile(const fs::path& path, uint64_t& hash, uint64_t* fileSize = nullptr)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (not in)
+            return false;
+
+        // a multiple of the word size, so only the very last read can leave a partial word
+        std::vector<char> chunk(size_t{1} << 20);
+        uint64_t total = 0;
+
+        while (in)
+        {
+            in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            const size_t count = static_cast<size_t>(in.gcount());
+            total += count;
+
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= count; i += sizeof(uint64_t))
+            {
+                uint64_t word;
+                std::memcpy(&word, chunk.data() + i, sizeof(word));
+                hash = MixWord(hash, word);
+            }
+
+            if (i < count)
+            {
+                uint64_t word = 0;
+                std::memcpy(&word, chunk.data() + i, count - i);
+                hash = MixWord(hash, word ^ (uint64_t{count - i} << 56));
+            }
+        }
+
+        if (in.bad())
+            return false;
+
+        hash = MixWord(hash, total);
+        if (fileSize)
+            *fileSize = total;
+        return true;
+    }
+
+    bool Fail(std::string& error, std::string message)
+    {
+        error = std::move(message);
+        return false;
+    }
+
+    bool WriteMeta(const Map& map, const fs::path& houseFile, SnapshotBuffer& out)
+    {
+        if (not out.WriteString(map.spawnfile.string()) or not out.WriteString(houseFile.string()))
+            return false;
+
+        const auto& towns = map.towns.getTowns();
+        out.Write(static_cast<uint32_t>(towns.size()));
+        for (const auto& [townId, town] : towns)
+        {
+            const Position& temple = town->getTemplePosition();
+            out.Write(townId);
+            if (not out.WriteString(town->getName()))
+                return false;
+            out.Write(temple.x);
+            out.Write(temple.y);
+            out.Write(temple.z);
+        }
+
+        out.Write(static_cast<uint32_t>(map.waypoints.size()));
+        for (const auto& [name, pos] : map.waypoints)
+        {
+            if (not out.WriteString(name))
+                return false;
+            out.Write(pos.x);
+            out.Write(pos.y);
+            out.Write(pos.z);
+        }
+
+        // the byte offsets point into the OTBM file, which the snapshot key pins down exactly
+        out.Write(static_cast<uint32_t>(map.legacyZoneFlagTiles.size()));
+        for (const auto& legacyTile : map.legacyZoneFlagTiles)
+        {
+            out.Write(legacyTile.position.x);
+            out.Write(legacyTile.position.y);
+            out.Write(legacyTile.position.z);
+            out.Write(legacyTile.legacy_bits);
+            out.Write(static_cast<uint8_t>(legacyTile.patchable));
+            for (size_t offset : legacyTile.raw_byte_offsets)
+                out.Write(static_cast<uint64_t>(offset));
+        }
+        return true;
+    }
+
+    bool WriteItem(OTB::Loader& loader, const OTB::Node& itemNode, SnapshotBuffer& out, std::string& error)
+    {
+        if (itemNode.type != OTBM_ITEM)
+            return Fail(error, "Unknown node type.");
+
+        if (itemNode.children.size() > std::numeric_limits<uint16_t>::max())
+            return Fail(error, "Too many items in a container.");
+
+        PropStream props;
+        if (not loader.getProps(itemNode, props))
+            return Fail(error, "Invalid item node.");
+
+        const size_t recordStart = out.Size();
+        out.Write<uint32_t>(0);
+        out.Write(static_cast<uint32_t>(props.size()));
+
+        // copied before recursing: getProps reuses one buffer per thread
+        if (not out.WriteStream(props))
+            return Fail(error, "Invalid item node.");
+
+        out.Write(static_cast<uint16_t>(itemNode.children.size()));
+        for (const auto& childNode : itemNode.children)
+        {
+            if (not WriteItem(loader, childNode, out, error))
+                return false;
+        }
+
+        out.Patch(recordStart, static_cast<uint32_t>(out.Size() - recordStart - sizeof(uint32_t)));
+        return true;
+    }
+
+    bool WriteTile(OTB::Loader& loader, const OTB::Node& tileNode, const OTBM_Destination_coords& area, SnapshotBuffer& out, std::string& error)
+    {
+        if (tileNode.type != OTBM_TILE and tileNode.type != OTBM_HOUSETILE)
+            return Fail(error, "Unknown tile node.");
+
+        PropStream props;
+        OTBM_Tile_coords tileCoords;
+        if (not loader.getProps(tileNode, props) or not props.read(tileCoords))
+            return Fail(error, "Could not read tile position.");
+
+        // house id 0 marks a plain tile in the snapshot
+        uint32_t houseId = 0;
+        if (tileNode.type == OTBM_HOUSETILE)
+        {
+            if (not props.read(houseId))
+                return Fail(error, "Could not read house id.");
+
+            if (houseId == 0)
+                return Fail(error, "House tile with house id 0.");
+        }
+
+        out.Write(static_cast<uint16_t>(area.x + tileCoords.x));
+        out.Write(static_cast<uint16_t>(area.y + tileCoords.y));
+        out.Write(area.z);
+        out.Write(houseId);
+
+        const size_t countOffset = out.Size();
+        out.Write<uint16_t>(0);
+        uint32_t itemCount = 0;
+
+        // inline items first, then item nodes: the order IOMap::parseTile places them in
+        uint8_t attribute;
+        while (props.read(attribute))
+        {
+            if (attribute == OTBM_ATTR_TILE_FLAGS)
+            {
+                if (not props.skip(sizeof(uint32_t)))
+                    return Fail(error, "Failed to read tile flags.");
+            }
+            else if (attribute == OTBM_ATTR_ITEM)
+            {
+                uint16_t id;
+                if (not props.read(id))
+                    return Fail(error, "Failed to create item.");
+
+                out.Write(static_cast<uint32_t>(sizeof(uint32_t) + 2 * sizeof(uint16_t)));
+                out.Write(static_cast<uint32_t>(sizeof(uint16_t)));
+                out.Write(id);
+                out.Write<uint16_t>(0);
+                ++itemCount;
+            }
+            else
+            {
+                return Fail(error, "Unknown tile attribute.");
+            }
+        }
+
+        for (const auto& itemNode : tileNode.children)
+        {
+            if (not WriteItem(loader, itemNode, out, error))
+                return false;
+            ++itemCount;
+        }
+
+        if (itemCount > std::numeric_limits<uint16_t>::max())
+            return Fail(error, "Too many items on a tile.");
+
+        out.Patch(countOffset, static_cast<uint16_t>(itemCount));
+        return true;
+    }
+
+    // Structural checks only, so a damaged snapshot is rejected before anything reaches the map.
+    // Item records are checked by their size prefix; their contents are the loader's business.
+    constexpr size_t PositionSize = 2 * sizeof(uint16_t) + sizeof(uint8_t);
+
+    bool ValidateMeta(PropStream meta)
+    {
+        auto skipString = [&meta]() { return meta.readString().second; };
+
+        if (not skipString() or not skipString())
+            return false;
+
+        uint32_t count;
+        if (not meta.read(count))
+            return false;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (not meta.skip(sizeof(uint32_t)) or not skipString() or not meta.skip(PositionSize))
+                return false;
+        }
+
+        if (not meta.read(count))
+            return false;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (not skipString() or not meta.skip(PositionSize))
+                return false;
+        }
+
+        if (not meta.read(count))
+            return false;
+
+        constexpr size_t LegacyTileSize = PositionSize + sizeof(uint32_t) + sizeof(uint8_t) + 4 * sizeof(uint64_t);
+        return meta.skip(size_t{count} * LegacyTileSize) and meta.size() == 0;
+    }
+
+    bool ValidateTiles(PropStream tiles, uint32_t tileCount)
+    {
+        for (uint32_t i = 0; i < tileCount; ++i)
+        {
+            uint16_t itemCount;
+            if (not tiles.skip(PositionSize + sizeof(uint32_t)) or not tiles.read(itemCount))
+                return false;
+
+            for (uint16_t j = 0; j < itemCount; ++j)
+            {
+                uint32_t recordSize;
+                if (not tiles.read(recordSize) or not tiles.skip(recordSize))
+                    return false;
+            }
+        }
+        return tiles.size() == 0;
+    }
+}
+
+namespace BlackTek::World
+{
+    fs::path MapSnapshot::PathFor(const fs::path& otbmFile)
+    {
+        fs::path file = otbmFile;
+        file.replace_extension(".snapshot");
+        return file;
+    }
+
+    std::optional<SnapshotKey> MapSnapshot::ComputeKey(const fs::path& otbmFile)
+    {
+        SnapshotKey key;
+        key.otbmHash = 0x9E3779B97F4A7C15ull;
+        if (not HashFile(otbmFile, key.otbmHash, &key.otbmSize))
+            return std::nullopt;
+
+        // the same inputs Items::reload reads, in a stable order
+        std::vector<fs::path> itemFiles{ g_config.GetString(ConfigManager::ASSETS_DAT_PATH) };
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator("data/items/", ec))
+        {
+            if (entry.path().extension() == ".toml")
+                itemFiles.push_back(entry.path());
+        }
+
+        if (ec)
+            return std::nullopt;
+
+        std::sort(itemFiles.begin() + 1, itemFiles.end());
+
+        key.itemsHash = 0x9E3779B97F4A7C15ull;
+        for (const auto& itemFile : itemFiles)
+        {
+            const std::string name = itemFile.filename().string();
+            for (char c : name)
+                key.itemsHash = MixWord(key.itemsHash, static_cast<uint8_t>(c));
+
+            if (not HashFile(itemFile, key.itemsHash))
+                return std::nullopt;
+        }
+        return key;
+    }
+
+    bool MapSnapshot::Write(const fs::path& file, const SnapshotKey& key, OTB::Loader& loader, const OTB::Node& root, const Map& map, std::string& error)
+    {
+        PropStream rootProps;
+        OTBM_root_header rootHeader{};
+        if (not loader.getProps(root, rootProps) or not rootProps.read(rootHeader) or root.children.empty())
+            return Fail(error, "Could not read header.");
+
+        SnapshotBuffer meta;
+        if (not WriteMeta(map, map.housefile, meta))
+            return Fail(error, "Map metadata does not fit the snapshot format.");
+
+        SnapshotBuffer tiles;
+        uint32_t tileCount = 0;
+
+        for (const auto& areaNode : root.children[0].children)
+        {
+            if (areaNode.type != OTBM_TILE_AREA)
+                continue;
+
+            PropStream areaProps;
+            OTBM_Destination_coords area;
+            if (not loader.getProps(areaNode, areaProps) or not areaProps.read(area))
+                return Fail(error, "Invalid map node.");
+
+            for (const auto& tileNode : areaNode.children)
+            {
+                if (not WriteTile(loader, tileNode, area, tiles, error))
+                    return false;
+                ++tileCount;
+            }
+        }
+
+        SnapshotHeader header;
+        header.magic = SnapshotHeader::Magic;
+        header.version = SnapshotHeader::CurrentVersion;
+        header.key = key;
+        header.otbmVersion = rootHeader.version;
+        header.width = rootHeader.width;
+        header.height = rootHeader.height;
+        header.tileCount = tileCount;
+        header.metaOffset = sizeof(SnapshotHeader);
+        header.metaSize = meta.Size();
+        header.tilesOffset = header.metaOffset + header.metaSize;
+        header.tilesSize = tiles.Size();
+
+        fs::path staging = file;
+        staging += ".tmp";
+
+        {
+            std::ofstream out(staging, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(meta.Data(), static_cast<std::streamsize>(meta.Size()));
+            out.write(tiles.Data(), static_cast<std::streamsize>(tiles.Size()));
+            out.close();
+
+            if (not out)
+            {
+                std::error_code ec;
+                fs::remove(staging, ec);
+                return Fail(error, "Could not write " + staging.string() + ".");
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(staging, file, ec);
+        if (ec)
+        {
+            fs::remove(staging, ec);
+            return Fail(error, "Could not replace " + file.string() + ".");
+        }
+        return true;
+    }
+
+    bool MapSnapshot::Open(const fs::path& file, const SnapshotKey& key)
+    {
+        std::error_code ec;
+        if (not fs::is_regular_file(file, ec) or fs::file_size(file, ec) < sizeof(SnapshotHeader))
+            return false;
+
+        try
+        {
+            contents.open(file.string());
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        std::memcpy(&header, contents.data(), sizeof(header));
+
+        const uint64_t fileSize = contents.size();
+        auto sectionFits = [fileSize](uint64_t offset, uint64_t size) {
+            return offset >= sizeof(SnapshotHeader) and offset <= fileSize and size <= fileSize - offset;
+        };
+
+        if (header.magic != SnapshotHeader::Magic or header.version != SnapshotHeader::CurrentVersion or header.key != key
+            or not sectionFits(header.metaOffset, header.metaSize) or not sectionFits(header.tilesOffset, header.tilesSize)
+            or not ValidateMeta(Meta()) or not ValidateTiles(Tiles(), header.tileCount))
+        {
+            contents.close();
+            return false;
+        }
+        return true;
+    }
+
+    PropStream MapSnapshot::Meta() const
+    {
+        PropStream stream;
+        stream.init(contents.data() + header.metaOffset, header.metaSize);
+        return stream;
+    }
+
+    PropStream MapSnapshot::Tiles() const
+    {
+        PropStream stream;
+        stream.init(contents.data() + header.tilesOffset, header.tilesSize);
+        return stream;
+    }
+}
@@ -0,0 +1,93 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+class Map;
+class PropStream;
+
+namespace OTB
+{
+    class Loader;
+    struct Node;
+}
+
+namespace BlackTek::World
+{
+    // Identifies the inputs a snapshot was baked from. Item types are resolved again when the
+    // snapshot is materialized, but the items files decide which ids exist at all and how the raw
+    // attribute streams are interpreted, so a change there invalidates the snapshot as well.
+    struct SnapshotKey
+    {
+        uint64_t otbmHash = 0;
+        uint64_t otbmSize = 0;
+        uint64_t itemsHash = 0;
+
+        bool operator==(const SnapshotKey&) const = default;
+    };
+
+    // All offsets are from the start of the file, all values in native byte order (a snapshot from
+    // a machine with the other byte order fails the magic check and is rebuilt).
+    //
+    //   meta section   spawn file, house file, towns, waypoints, legacy zone flag tiles
+    //   tile section   per tile: u16 x, u16 y, u8 z, u32 house id (0 = none), u16 item count, items
+    //                  per item: u32 record size (everything after this field, children included),
+    //                            u32 props size, props, u16 child count, children
+    //
+    // Item props are the unescaped properties of the OTBM item (id followed by its attributes), so
+    // a snapshot rebuilds items through the same Item::CreateItem/unserializeAttr path as the OTBM
+    // loader does and loses nothing that the map file carries.
+    struct SnapshotHeader
+    {
+        static constexpr std::array<char, 4> Magic = { 'B', 'T', 'M', 'S' };
+        static constexpr uint32_t CurrentVersion = 1;
+
+        std::array<char, 4> magic{};
+        uint32_t version = 0;
+        SnapshotKey key{};
+        uint32_t otbmVersion = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        uint32_t tileCount = 0;
+        uint32_t reserved = 0;
+        uint64_t metaOffset = 0;
+        uint64_t metaSize = 0;
+        uint64_t tilesOffset = 0;
+        uint64_t tilesSize = 0;
+    };
+
+    class MapSnapshot
+    {
+    public:
+        // data/world/forgotten.otbm -> data/world/forgotten.snapshot
+        static std::filesystem::path PathFor(const std::filesystem::path& otbmFile);
+
+        // nullopt when one of the inputs can not be read
+        static std::optional<SnapshotKey> ComputeKey(const std::filesystem::path& otbmFile);
+
+        // Bakes the map that was just loaded from `loader`. Tiles and items are taken from the OTBM
+        // tree, everything else from `map`. The file is written next to its final name and renamed
+        // into place, so a crash never leaves a truncated snapshot behind.
+        static bool Write(const std::filesystem::path& file, const SnapshotKey& key, OTB::Loader& loader, const OTB::Node& root, const Map& map, std::string& error);
+
+        // Maps the snapshot if it exists, was baked from `key` by this format version and its
+        // sections lie within the file. Anything else counts as stale.
+        bool Open(const std::filesystem::path& file, const SnapshotKey& key);
+
+        [[nodiscard]] const SnapshotHeader& Header() const { return header; }
+        [[nodiscard]] PropStream Meta() const;
+        [[nodiscard]] PropStream Tiles() const;
+
+    private:
+        boost::iostreams::mapped_file_source contents;
+        SnapshotHeader header{};
+    };
+}
@@ -246,87 +246,39 @@ void Monster::onCreatureMove(const CreaturePtr& creature, const TilePtr& newTile
 			}
 			else
 			{
-				const Position& myPos = getPosition();
-				const MonsterPtr& self = getMonster();
-
-				if (dy < 0) // north
+				// slide the window along with the step, only the row and column coming into view are read
+				if (dx != 0)
 				{
-					localMapCache <<= mapWalkWidth;
-					for (int32_t x = -maxWalkCacheWidth; x <= maxWalkCacheWidth; ++x)
+					constexpr uint32_t rowMask = (uint32_t{ 1 } << mapWalkWidth) - 1;
+					for (uint32_t& row : localMapCache)
 					{
-						const auto cacheTile = g_game.map.getTile(myPos.getX() + x, myPos.getY() - maxWalkCacheHeight, myPos.z);
-						updateTileCache(cacheTile, x, -maxWalkCacheHeight, self);
-						findCreaturesOnTile(cacheTile);
+						row = (dx > 0 ? row >> 1 : row << 1) & rowMask;
 					}
 				}
+
+				if (dy < 0) // north
+				{
+					std::shift_right(localMapCache.begin(), localMapCache.end(), 1);
+					updateWalkRow(-maxWalkCacheHeight, -maxWalkCacheWidth, maxWalkCacheWidth, true);
+				}
 				else if (dy > 0) // south
 				{
-					localMapCache >>= mapWalkWidth;
-					for (int32_t x = -maxWalkCacheWidth; x <= maxWalkCacheWidth; ++x)
-					{
-						const auto cacheTile = g_game.map.getTile(myPos.getX() + x, myPos.getY() + maxWalkCacheHeight, myPos.z);
-						updateTileCache(cacheTile, x, maxWalkCacheHeight, self);
-						findCreaturesOnTile(cacheTile);
-					}
+					std::shift_left(localMapCache.begin(), localMapCache.end(), 1);
+					updateWalkRow(maxWalkCacheHeight, -maxWalkCacheWidth, maxWalkCacheWidth, true);
 				}
 
-				if (dx > 0) // east
+				if (dx != 0) // east or west
 				{
-					int32_t starty = 0;
-					int32_t endy = mapWalkHeight - 1;
+					const int32_t edge = dx > 0 ? maxWalkCacheWidth : -maxWalkCacheWidth;
+					const int32_t newRow = dy < 0 ? -maxWalkCacheHeight : (dy > 0 ? maxWalkCacheHeight : mapWalkHeight);
 
-					if (dy < 0)
-					{
-						endy += dy;
-					}
-					else if (dy > 0)
-					{
-						starty = dy;
-					}
-
-					for (int32_t y = starty; y <= endy; ++y)
-					{
-						const int32_t rowBase = y * mapWalkWidth;
-						for (int32_t x = 0; x < mapWalkWidth - 1; ++x)
-						{
-							localMapCache[rowBase + x] = localMapCache[rowBase + x + 1];
-						}
-					}
 					for (int32_t y = -maxWalkCacheHeight; y <= maxWalkCacheHeight; ++y)
 					{
-						const auto cacheTile = g_game.map.getTile(myPos.x + maxWalkCacheWidth, myPos.y + y, myPos.z);
-						updateTileCache(cacheTile, maxWalkCacheWidth, y, self);
-						findCreaturesOnTile(cacheTile);
-					}
-				}
-				else if (dx < 0) // west
-				{
-					int32_t starty = 0;
-					int32_t endy = mapWalkHeight - 1;
-
-					if (dy < 0)
-					{
-						endy += dy;
-					}
-					else if (dy > 0)
-					{
-						starty = dy;
-					}
-
-					for (int32_t y = starty; y <= endy; ++y)
-					{
-						const int32_t rowBase = y * mapWalkWidth;
-						for (int32_t x = mapWalkWidth - 2; x >= 0; --x)
+						if (y != newRow)
 						{
-							localMapCache[rowBase + x + 1] = localMapCache[rowBase + x];
+							updateWalkRow(y, edge, edge, true);
 						}
 					}
-					for (int32_t y = -maxWalkCacheHeight; y <= maxWalkCacheHeight; ++y)
-					{
-						const auto cacheTile = g_game.map.getTile(myPos.x - maxWalkCacheWidth, myPos.y + y, myPos.z);
-						updateTileCache(cacheTile, -maxWalkCacheWidth, y, self);
-						findCreaturesOnTile(cacheTile);
-					}
 				}
 
 				updateTileCache(oldTile, oldPos);
@@ -788,13 +740,21 @@ void Monster::setIdle(const bool idle)
 	isIdle = idle;
 
 	if (!isIdle) {
-		g_game.addCreatureCheck(this->getCreature());
+		// replaying the frozen conditions may leave the monster idle again
+		wakeUp();
+		if (!isIdle) {
+			g_game.addCreatureCheck(this->getCreature());
+		}
 	} else {
 		onIdleStatus();
 		clearTargetList();
 		clearFriendList();
 		Game::removeCreatureCheck(this->getCreature());
 
+		if (sleepingSince == 0 && g_config.GetBoolean(ConfigManager::MONSTER_DORMANCY)) {
+			sleepingSince = OTSYS_TIME();
+		}
+
 		if (not wasIdle)
 		{
 			if (auto spawnOverlay = Zones::ZoneManager::GetSpawns(getPosition()))
@@ -803,6 +763,42 @@ void Monster::setIdle(const bool idle)
 	}
 }
 
+void Monster::wakeUp()
+{
+	if (sleepingSince == 0) {
+		return;
+	}
+
+	const int64_t steps = std::min<int64_t>((OTSYS_TIME() - sleepingSince) / EVENT_CREATURE_THINK_INTERVAL, MaxSleepReplaySteps);
+	sleepingSince = 0;
+
+	for (int64_t step = 0; step < steps && !conditions.empty(); ++step) {
+		if (isRemoved() || getHealth() <= 0) {
+			return;
+		}
+
+		executeConditions(EVENT_CREATURE_THINK_INTERVAL);
+	}
+
+	if (!isIdle && !isRemoved() && getHealth() > 0) {
+		g_game.addCreatureCheck(this->getCreature());
+	}
+}
+
+bool Monster::canSleep()
+{
+	// anything that still acts on its own or is scripted to do so every think stays awake
+	if (!g_config.GetBoolean(ConfigManager::MONSTER_DORMANCY) || isSummon() || !summons.empty() || !targetList.empty()) {
+		return false;
+	}
+
+	if (getAttackedCreature() || getFollowCreature() || mType->info.thinkEvent != -1 || hasEventRegistered(CREATURE_EVENT_THINK)) {
+		return false;
+	}
+
+	return !g_game.map.hasPlayersNear(position);
+}
+
 void Monster::updateIdleStatus()
 {
 	bool idle = false;
@@ -938,11 +934,19 @@ void Monster::onThink(const uint32_t interval)
 		lua_State* L = scriptInterface->getLuaState();
 		env->setScriptId(mType->info.thinkEvent, scriptInterface);
 		scriptInterface->pushFunction(mType->info.thinkEvent);
-		LuaScriptInterface::pushUserdata<Monster>(L, this);
+		LuaScriptInterface::pushSharedPtr(L, getMonster());
 		LuaScriptInterface::setMetatable(L, -1, "Monster");
 		lua_pushinteger(L, interval);
 		scriptInterface->callFunction(2);
 	}
+
+	// Not idle (burning, poisoned, ...) but with no player around to see it. Dormant monsters leave the think
+	// wheel until a player enters one of the chunks near them, see Map::wakeMonstersNear.
+	if (not isIdle and not isRemoved() and sleepingSince == 0 and canSleep())
+	{
+		sleepingSince = OTSYS_TIME();
+		Game::removeCreatureCheck(self);
+	}
 }
 
 void Monster::doAttacking(const uint32_t interval)
@@ -1765,18 +1769,98 @@ bool Monster::followTargetFromDistance(const Position& target_position, Directio
 
 void Monster::updateMapCache()
 {
+	for (int32_t dy = -maxWalkCacheHeight; dy <= maxWalkCacheHeight; ++dy)
+	{
+		updateWalkRow(dy, -maxWalkCacheWidth, maxWalkCacheWidth, false);
+	}
+}
+
+void Monster::updateWalkRow(const int32_t dy, const int32_t firstDx, const int32_t lastDx, const bool findCreatures)
+{
+	using namespace BlackTek::World;
+
+	// zone flags no monster may walk into while pathfinding, see CreatureContainer::canEnter
+	static constexpr uint32_t blockingZoneFlags = static_cast<uint32_t>(Zones::ZoneFlag::Protection) | static_cast<uint32_t>(Zones::ZoneFlag::NoMonsters)
+		| static_cast<uint32_t>(Zones::ZoneFlag::NoWalk) | static_cast<uint32_t>(Zones::ZoneFlag::NoPathfinding);
+
 	const Position& myPos = getPosition();
-	Position pos(0, 0, myPos.z);
+	const int32_t y = myPos.y + dy;
+	const uint8_t z = myPos.z;
+
+	uint32_t& row = localMapCache[maxWalkCacheHeight + dy];
+	row &= ~(((uint32_t{ 1 } << (lastDx - firstDx + 1)) - 1) << (maxWalkCacheWidth + firstDx));
+
+	if (y < 0 or y > 0xFFFF or z >= MaxLayers)
+	{
+		return;
+	}
+
+	const MonsterPtr& self = getMonster();
+	const uint32_t rowShift = (y & Floor::Mask) * Floor::Size;
+	const int32_t lastX = std::min<int32_t>(myPos.x + lastDx, 0xFFFF);
 
-	for (int32_t y = -maxWalkCacheHeight; y <= maxWalkCacheHeight; ++y)
+	// one chunk row of up to Floor::Size tiles at a time
+	for (int32_t x = std::max<int32_t>(myPos.x + firstDx, 0); x <= lastX; x = (x | Floor::Mask) + 1)
 	{
-		for (int32_t x = -maxWalkCacheWidth; x <= maxWalkCacheWidth; ++x)
+		const Chunk* chunk = g_game.map.getChunk(static_cast<uint16_t>(x), static_cast<uint16_t>(y));
+		if (not chunk)
+		{
+			continue;
+		}
+
+		const int32_t chunkX = x & ~Floor::Mask;
+		const uint32_t localMask = ((uint32_t{ 1 } << (std::min<int32_t>(x | Floor::Mask, lastX) - x + 1)) - 1) << (x & Floor::Mask);
+		const auto layerRow = [rowShift, localMask](const uint64_t mask) {
+			return static_cast<uint32_t>(mask >> rowShift) & localMask;
+		};
+
+		uint32_t unwalkable = layerRow(~chunk->ground_mask[z]);
+		uint32_t check = layerRow(chunk->walk_check_mask[z]);
+
+		if (const auto zoneBits = Zones::ZoneManager::ChunkFlagBits(*chunk, z, blockingZoneFlags))
+		{
+			unwalkable |= layerRow(*zoneBits);
+		}
+		else
+		{
+			check = localMask;
+		}
+
+		// tiles holding a creature are up to the creature and the monster, ghosts don't block
+		if (chunk->floor_creature_counts[z] > 0)
+		{
+			for (size_t i = 0; i < chunk->creature_ptrs.size(); ++i)
+			{
+				if (chunk->creature_z[i] != z or chunk->creature_y[i] != y or not ((localMask >> (chunk->creature_x[i] & Floor::Mask)) & 1))
+				{
+					continue;
+				}
+
+				check |= uint32_t{ 1 } << (chunk->creature_x[i] & Floor::Mask);
+
+				if (findCreatures)
+				{
+					onCreatureFound(chunk->creature_ptrs[i]);
+				}
+			}
+		}
+
+		uint32_t walkable = localMask & ~unwalkable & ~check & ~layerRow(chunk->block_path_mask[z] | chunk->block_solid_mask[z]);
+
+		// the per monster exceptions, decided by the tile itself
+		for (uint32_t pending = check & ~unwalkable; pending != 0; pending &= pending - 1)
 		{
-			pos.x = myPos.getX() + x;
-			pos.y = myPos.getY() + y;
-			TilePtr tile = g_game.map.getTile(pos);
-			updateTileCache(tile, pos);
+			const int32_t localX = std::countr_zero(pending);
+			const auto& tile = g_game.map.getTileInChunk(chunk, static_cast<uint16_t>(chunkX + localX), static_cast<uint16_t>(y), z);
+
+			if (tile and tile->canEnter(self, FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE) == RETURNVALUE_NOERROR)
+			{
+				walkable |= uint32_t{ 1 } << localX;
+			}
 		}
+
+		const int32_t offset = chunkX - myPos.x + maxWalkCacheWidth;
+		row |= offset >= 0 ? walkable << offset : walkable >> -offset;
 	}
 }
 
@@ -1790,20 +1874,11 @@ void Monster::updateTileCache(TilePtr tile, int32_t dx, int32_t dy)
 		{
 			canAdd = tile->canEnter(getMonster(), flags) == RETURNVALUE_NOERROR;
 		}
-		localMapCache[(maxWalkCacheHeight + dy) * mapWalkWidth + (maxWalkCacheWidth + dx)] = canAdd;
-	}
-}
 
-void Monster::updateTileCache(const TilePtr& tile, int32_t dx, int32_t dy, const MonsterPtr& self)
-{
-	auto entry = localMapCache[(maxWalkCacheHeight + dy) * mapWalkWidth + (maxWalkCacheWidth + dx)];
-	if (not tile or tile->hasFlag(TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT | TILESTATE_BLOCKSOLID))
-	{
-		entry = false;
-		return;
+		const uint32_t bit = uint32_t{ 1 } << (maxWalkCacheWidth + dx);
+		uint32_t& row = localMapCache[maxWalkCacheHeight + dy];
+		row = canAdd ? row | bit : row & ~bit;
 	}
-	constexpr uint32_t flags = FLAG_PATHFINDING | FLAG_IGNOREFIELDDAMAGE;
-	entry = tile->canEnter(self, flags) == RETURNVALUE_NOERROR;
 }
 
 void Monster::updateTileCache(TilePtr tile, const Position& pos)
@@ -1817,20 +1892,6 @@ void Monster::updateTileCache(TilePtr tile, const Position& pos)
 	}
 }
 
-void Monster::findCreaturesOnTile(const TilePtr& tile)
-{
-	if (not tile)
-		return;
-
-	const auto* creatures = tile->getCreatures();
-
-	if (not creatures)
-		return;
-
-	for (const auto& creature : creatures->getList())
-		onCreatureFound(creature);
-}
-
 int32_t Monster::getWalkCache(const Position& pos) const
 {
 	if (not useCacheMap())
@@ -1855,7 +1916,7 @@ int32_t Monster::getWalkCache(const Position& pos) const
 		int32_t dy = Position::getOffsetY(pos, myPos);
 		if (std::abs(dy) <= maxWalkCacheHeight)
 		{
-			if (localMapCache[(maxWalkCacheHeight + dy) * mapWalkWidth + (maxWalkCacheWidth + dx)])
+			if ((localMapCache[maxWalkCacheHeight + dy] >> (maxWalkCacheWidth + dx)) & 1)
 			{
 				return 1;
 			}
@@ -2193,6 +2254,27 @@ void Monster::getPathSearchParams(const CreatureConstPtr& creature, FindPathPara
 	}
 }
 
+bool Monster::canUseFlowField(const FindPathParams& fpp) const
+{
+	if (!g_config.GetBoolean(ConfigManager::MONSTER_FLOW_FIELDS)) {
+		return false;
+	}
+
+	// the field only knows melee range and ignores fields, so monsters that keep their distance or
+	// have to walk around some field type keep using A*
+	if (fpp.maxTargetDist > 1 || fpp.keepDistance) {
+		return false;
+	}
+
+	return canWalkOnFieldType(COMBAT_ENERGYDAMAGE) && canWalkOnFieldType(COMBAT_FIREDAMAGE) && canWalkOnFieldType(COMBAT_EARTHDAMAGE);
+}
+
+bool Monster::canSearchPathAsync(const FindPathParams& fpp) const
+{
+	// clear sight and distance keeping need the live map, flow field users are cheaper on the dispatcher
+	return !fpp.clearSight && !fpp.keepDistance && !canUseFlowField(fpp);
+}
+
 bool Monster::canPushItems() const
 {
 	if (const auto& master = getMaster() ? getMaster()->getMonster() : nullptr) {
@@ -4,7 +4,7 @@
 #ifndef FS_MONSTER_H
 #define FS_MONSTER_H
 
-#include <bitset>
+#include <array>
 
 #include "tile.h"
 #include "map.h"
@@ -119,6 +119,7 @@ class Monster final : public Creature
 		void doAttacking(uint32_t interval) override;
 		void fleeFromTarget(const Position& targetPos, Direction& direction) noexcept;
 		void setIdle(bool idle);
+		void wakeUp() override;
 
 		void setID() override										{ if (id == 0) id = monsterAutoID++; }
 		void setNameDescription(const std::string& nameDescription) { this->nameDescription = nameDescription; };
@@ -132,6 +133,7 @@ class Monster final : public Creature
 		static constexpr int32_t mapWalkHeight = Map::maxViewportY * 2 + 1;
 		static constexpr int32_t maxWalkCacheWidth = (mapWalkWidth - 1) / 2;
 		static constexpr int32_t maxWalkCacheHeight = (mapWalkHeight - 1) / 2;
+		static_assert(mapWalkWidth <= 32, "a walk cache row has to fit into 32 bits");
 
 		static bool	pushItem(const ItemPtr& item);
 		static void	pushItems(const TilePtr& tile);
@@ -146,7 +148,12 @@ class Monster final : public Creature
 
 		uint64_t getLostExperience() const override { return skillLoss ? mType->info.experience : 0; }
 
+		// think intervals of frozen conditions replayed at most when waking up, the rest is dropped
+		static constexpr int64_t MaxSleepReplaySteps = 600;
+
 		int64_t lastMeleeAttack = 0;
+		// set while off the think wheel, idle or dormant, with conditions frozen since then
+		int64_t sleepingSince = 0;
 		int64_t losCacheTime = 0;
 
 		int32_t minCombatValue = 0;
@@ -173,7 +180,8 @@ class Monster final : public Creature
 		CreatureHashSet friendList;
 		CreatureList targetList;
 		gtl::flat_hash_set<CreaturePtr> targetSet;
-		std::bitset<mapWalkHeight * mapWalkWidth> localMapCache;
+		// one row per y offset, bit maxWalkCacheWidth + dx set when the tile can be walked on
+		std::array<uint32_t, mapWalkHeight> localMapCache{};
 
 		bool losCacheResult = false;
 		bool ignoreFieldDamage = false;
@@ -195,6 +203,7 @@ class Monster final : public Creature
 		bool isOpponent(const CreatureConstPtr& creature) const;
 
 		bool getIdleStatus() const	{ return isIdle; }
+		bool canSleep();
 		bool useCacheMap() const	{ return not randomStepping; }
 
 		void onCreatureEnter(const CreaturePtr& creature);
@@ -217,15 +226,16 @@ class Monster final : public Creature
 		void onEndCondition(ConditionType_t type) override;
 
 		void updateMapCache();
+		void updateWalkRow(int32_t dy, int32_t firstDx, int32_t lastDx, bool findCreatures);
 		void updateTileCache(TilePtr tile, int32_t dx, int32_t dy);
-		void updateTileCache(const TilePtr& tile, int32_t dx, int32_t dy, const MonsterPtr& self);
 		void updateTileCache(TilePtr tile, const Position& pos);
-		void findCreaturesOnTile(const TilePtr& tile);
 
 		void onThinkTarget(uint32_t interval);
 		void onThinkYell(uint32_t interval);
 		void onThinkDefense(uint32_t interval);
 		void getPathSearchParams(const CreatureConstPtr& creature, FindPathParams& fpp) const override;
+		bool canUseFlowField(const FindPathParams& fpp) const override;
+		bool canSearchPathAsync(const FindPathParams& fpp) const override;
 
 		friend class LuaScriptInterface;
 };
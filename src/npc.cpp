@@ -514,6 +514,17 @@ void Npc::onThink(const uint32_t interval)
 	}
 }
 
+uint32_t Npc::getThinkHold() const
+{
+	// nobody around to talk to or watch it walk, the handler's think can wait
+	if (isIdle and not followCreature.lock() and not hasEventRegistered(CREATURE_EVENT_THINK))
+	{
+		return IdleThinkHold;
+	}
+
+	return 0;
+}
+
 void Npc::doSay(const std::string& text)
 {
 	g_game.internalCreatureSay(this->getNpc(), TALKTYPE_SAY, text, false);
@@ -604,6 +615,10 @@ void Npc::setIdle(const bool idle)
 	{
 		onIdleStatus();
 	}
+	else
+	{
+		g_game.holdCreatureThink(*this, 0);
+	}
 }
 
 bool Npc::canWalkTo(const Position& fromPos, Direction dir)
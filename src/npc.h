@@ -94,6 +94,9 @@ class NpcEventsHandler
 class Npc final : public Creature
 {
 	public:
+		// turns an idle npc skips between thinks
+		static constexpr uint32_t IdleThinkHold = 9;
+
 		explicit Npc(const std::string& name);
 		~Npc() override;
 
@@ -214,6 +217,7 @@ class Npc final : public Creature
 
 		void onCreatureSay(const CreaturePtr& creature, SpeakClasses type, const std::string& text) override;
 		void onThink(uint32_t interval) override;
+		uint32_t getThinkHold() const override;
 		std::string getDescription(int32_t lookDistance) override;
 
 		bool isImmune(CombatType_t) const override
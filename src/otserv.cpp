@@ -18,6 +18,7 @@
 #include "databasemanager.h"
 #include "scheduler.h"
 #include "databasetasks.h"
+#include "pathworkers.h"
 #include "script.h"
 #include <fstream>
 #include <fmt/color.h>
@@ -25,7 +26,12 @@
 #include "zones.h"
 #include "console.h"
 #include "metrics.h"
+#include "luaprofiler.h"
+#include "luagc.h"
+#include "luabytecode.h"
 #include "simd_dispatch.h"
+#include "simd_bench.h"
+#include "protocolgame.h"
 #include <memory>
 
 #if __has_include("gitmetadata.h")
@@ -33,6 +39,7 @@
 #endif
 
 DatabaseTasks g_databaseTasks;
+PathWorkers g_pathWorkers;
 Dispatcher g_dispatcher;
 Dispatcher g_utility_boss;
 Scheduler g_scheduler;
@@ -48,6 +55,25 @@ std::mutex g_loaderLock;
 std::condition_variable g_loaderSignal;
 std::unique_lock<std::mutex> g_loaderUniqueLock(g_loaderLock);
 
+// set by --map-description-bench, runs once the map is loaded
+static std::optional<Position> mapDescriptionBenchCenter;
+
+// set by --flow-field-bench, runs once the map and monsters are loaded
+static std::optional<Position> flowFieldBenchTarget;
+static uint32_t flowFieldBenchFollowers = 30;
+static std::string flowFieldBenchMonster;
+
+// set by --think-bench, runs once the monsters are loaded
+static std::optional<uint32_t> thinkBenchCreatures;
+static std::string thinkBenchMonster;
+
+// set by --zone-flag-bench, runs once the zone flags are stamped onto the map
+static std::optional<uint32_t> zoneFlagBenchLookups;
+
+// set by --sight-bench, runs once the map is loaded
+static std::optional<Position> sightBenchCenter;
+static uint32_t sightBenchCasts = 10000;
+
 // ============================================================================
 // BLACKTEK HOLOGRAPHIC CONSOLE - Color Definitions
 // ============================================================================
@@ -272,6 +298,7 @@ int main(int argc, char* argv[])
 
 		g_scheduler.shutdown();
 		g_databaseTasks.shutdown();
+		g_pathWorkers.shutdown();
 		g_dispatcher.shutdown();
 		g_utility_boss.shutdown();
 
@@ -287,6 +314,7 @@ int main(int argc, char* argv[])
 
 	g_scheduler.join();
 	g_databaseTasks.join();
+	g_pathWorkers.join();
 	g_dispatcher.join();
 	g_utility_boss.join();
 
@@ -350,6 +378,20 @@ void mainLoader(int, char*[], ServiceManager* services)
 	}
 
 	if constexpr (BlackTek::Metrics::ENABLED) BlackTek::Metrics::Initialize();
+	BlackTek::LuaProfiler::Initialize();
+
+	const std::string& simdLevel = g_config.GetString(ConfigManager::SIMD_LEVEL);
+	if (const auto forcedLevel = BlackTek::SIMD::parse_level(asLowerCaseString(simdLevel)))
+	{
+		if (BlackTek::SIMD::force(*forcedLevel) != *forcedLevel)
+		{
+			Console::printWarning(fmt::format("simd_level \"{}\" is not supported by this CPU, using {}.", simdLevel, BlackTek::SIMD::level_name(BlackTek::SIMD::g_level)));
+		}
+	}
+	else if (not caseInsensitiveEqual(simdLevel, "auto") and not simdLevel.empty())
+	{
+		Console::printWarning(fmt::format("Unknown simd_level \"{}\", using auto-detection.", simdLevel));
+	}
 
 	#ifdef _WIN32
 		const std::string& defaultPriority = g_config.GetString(ConfigManager::DEFAULT_PRIORITY);
@@ -382,6 +424,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	Console::printInfo("Compiler", BOOST_COMPILER);
 	Console::printInfo("Compiled", std::string(__DATE__) + " " + __TIME__);
+	Console::printInfo("SIMD Level", std::string(BlackTek::SIMD::level_name(BlackTek::SIMD::g_level)));
 	Console::printInfo("Lua Version", LUA_VERSION);
 	Console::printInfo("Database", std::string("MariaDB ") + Database::getClientVersion());
 
@@ -392,6 +435,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 		return;
 	}
 	g_databaseTasks.start();
+	g_pathWorkers.start();
 	DatabaseManager::updateDatabase();
 
 	if (g_config.GetBoolean(ConfigManager::OPTIMIZE_DATABASE) and not DatabaseManager::optimizeTables())
@@ -470,6 +514,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 		startupErrorMessage("Failed to load script systems");
 		return;
 	}
+	BlackTek::LuaGC::Initialize();
 
 	// Load lua scripts
 	if (not g_scripts->loadScripts("scripts", false, false))
@@ -478,6 +523,12 @@ void mainLoader(int, char*[], ServiceManager* services)
 		return;
 	}
 
+	if (g_config.GetBoolean(ConfigManager::LUA_BYTECODE_CACHE))
+	{
+		const auto& cacheStats = BlackTek::LuaBytecode::GetStats();
+		Console::printProgress("Script cache", true, fmt::format("{} cached, {} parsed, {} ms saved", cacheStats.hits, cacheStats.misses, cacheStats.saved_ns / 1000000));
+	}
+
 	// Load outfits
 	if (not Outfits::getInstance().load())
 	{
@@ -513,12 +564,42 @@ void mainLoader(int, char*[], ServiceManager* services)
 		return;
 	}
 
-	Console::printProgress("Map Tiles", true, std::to_string(g_game.map.lastLoadTileCount));
-	Console::printProgress("Map Items", true, std::to_string(g_game.map.lastLoadItemCount));
-	Console::printProgress("Map Load Time", true, std::to_string(g_game.map.lastLoadTimeSeconds) + "s");
+	const auto& mapLoadStats = g_game.map.lastLoadStats;
+	Console::printProgress("Map Tiles", true, std::to_string(mapLoadStats.tileCount));
+	Console::printProgress("Map Items", true, std::to_string(mapLoadStats.itemCount));
+	Console::printProgress("Map Load Time", true, std::to_string(mapLoadStats.time) + "s");
+
+	if (mapLoadStats.fromSnapshot)
+	{
+		Console::printProgress("Map Load Phases", true, fmt::format("snapshot {}ms", mapLoadStats.tileParseTime));
+	}
+	else if (mapLoadStats.workerCount > 1)
+	{
+		Console::printProgress("Map Load Phases", true, fmt::format("tree {}ms, tiles {}ms ({} workers), commit {}ms ({} serial tiles)",
+			mapLoadStats.treeTime, mapLoadStats.tileParseTime, mapLoadStats.workerCount, mapLoadStats.commitTime, mapLoadStats.serialTileCount));
+	}
+	else
+	{
+		Console::printProgress("Map Load Phases", true, fmt::format("tree {}ms, tiles {}ms", mapLoadStats.treeTime, mapLoadStats.tileParseTime));
+	}
 
 	Zones::ZoneManager::StampWorldZoneFlags();
 
+	if (zoneFlagBenchLookups)
+		Zones::ZoneManager::RunWorldFlagBenchmark(*zoneFlagBenchLookups);
+
+	if (thinkBenchCreatures)
+		g_game.runThinkBenchmark(*thinkBenchCreatures, thinkBenchMonster);
+
+	if (mapDescriptionBenchCenter)
+		ProtocolGame::RunMapDescriptionBenchmark(*mapDescriptionBenchCenter);
+
+	if (sightBenchCenter)
+		g_game.map.runSightBenchmark(*sightBenchCenter, sightBenchCasts);
+
+	if (flowFieldBenchTarget)
+		g_game.map.runFlowFieldBenchmark(*flowFieldBenchTarget, flowFieldBenchFollowers, flowFieldBenchMonster);
+
 	if (g_config.GetBoolean(ConfigManager::SMART_CONVERT_LEGACY_ZONES))
 		Zones::ZoneManager::SmartConvertLegacyZoneFlags(g_game.map);
 
@@ -599,11 +680,28 @@ bool argumentsHandler(const StringVector& args)
 			"\t--ip=$1\t\t\tIP address of the server.\n"
 			"\t\t\t\tShould be equal to the global IP.\n"
 			"\t--login-port=$1\tPort for login server to listen on.\n"
-			"\t--game-port=$1\tPort for game server to listen on.\n";
+			"\t--game-port=$1\tPort for game server to listen on.\n"
+			"\t--simd-level=$1\tForce the SIMD level (auto, avx2, sse4.1, sse2, scalar).\n"
+			"\t--simd-bench\t\tBenchmark and verify every SIMD kernel, then exit.\n"
+			"\t--map-description-bench=$1,$2,$3\n"
+			"\t\t\t\tBenchmark map descriptions around x,y,z after the map is loaded.\n"
+			"\t--flow-field-bench=$1,$2,$3[,$4[,$5]]\n"
+			"\t\t\t\tCompare A* with the shared flow field for $4 (default 30)\n"
+			"\t\t\t\tmonsters of type $5 chasing x,y,z after the map is loaded.\n"
+			"\t--zone-flag-bench[=$1]\tCompare $1 (default 1000000) zone flag lookups in the\n"
+			"\t\t\t\tzone area index with the chunk bitplanes.\n"
+			"\t--think-bench[=$1[,$2]]\tTime picking the due creatures out of $1 (default 50000)\n"
+			"\t\t\t\tmonsters of type $2 per think turn.\n"
+			"\t--sight-bench=$1,$2,$3[,$4]\n"
+			"\t\t\t\tTime the sight lines of $4 (default 10000) 7x7 and 9x9\n"
+			"\t\t\t\tarea spells around x,y,z after the map is loaded.\n";
 			return false;
 		} else if (arg == "--version") {
 			printServerVersion();
 			return false;
+		} else if (arg == "--simd-bench") {
+			BlackTek::SIMD::RunBenchmarks();
+			return false;
 		}
 
 		auto tmp = explodeString(arg, "=");
@@ -614,6 +712,46 @@ bool argumentsHandler(const StringVector& args)
 			g_config.SetNumber(ConfigManager::LOGIN_PORT, std::stoi(tmp[1].data()));
 		else if (tmp[0] == "--game-port")
 			g_config.SetNumber(ConfigManager::GAME_PORT, std::stoi(tmp[1].data()));
+		else if (tmp[0] == "--simd-level")
+			g_config.SetString(ConfigManager::SIMD_LEVEL, tmp[1]);
+		else if (tmp[0] == "--map-description-bench") {
+			const auto coords = vectorAtoi(explodeString(tmp[1], ","));
+			if (coords.size() != 3) {
+				std::clog << "--map-description-bench expects x,y,z" << std::endl;
+				return false;
+			}
+			mapDescriptionBenchCenter = Position(coords[0], coords[1], coords[2]);
+		}
+		else if (tmp[0] == "--flow-field-bench") {
+			const auto params = explodeString(tmp[1], ",");
+			if (params.size() < 3) {
+				std::clog << "--flow-field-bench expects x,y,z[,followers[,monster]]" << std::endl;
+				return false;
+			}
+			flowFieldBenchTarget = Position(std::stoi(params[0].data()), std::stoi(params[1].data()), std::stoi(params[2].data()));
+			if (params.size() > 3)
+				flowFieldBenchFollowers = std::stoi(params[3].data());
+			if (params.size() > 4)
+				flowFieldBenchMonster = std::string(params[4]);
+		}
+		else if (tmp[0] == "--zone-flag-bench")
+			zoneFlagBenchLookups = tmp.size() > 1 ? std::stoi(tmp[1].data()) : 1000000;
+		else if (tmp[0] == "--sight-bench") {
+			const auto params = explodeString(tmp[1], ",");
+			if (params.size() < 3) {
+				std::clog << "--sight-bench expects x,y,z[,casts]" << std::endl;
+				return false;
+			}
+			sightBenchCenter = Position(std::stoi(params[0].data()), std::stoi(params[1].data()), std::stoi(params[2].data()));
+			if (params.size() > 3)
+				sightBenchCasts = std::stoi(params[3].data());
+		}
+		else if (tmp[0] == "--think-bench") {
+			const auto params = tmp.size() > 1 ? explodeString(tmp[1], ",") : std::vector<std::string_view>{};
+			thinkBenchCreatures = not params.empty() ? std::stoi(params[0].data()) : 50000;
+			if (params.size() > 1)
+				thinkBenchMonster = std::string(params[1]);
+		}
 	}
 
 	return true;
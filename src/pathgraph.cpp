@@ -0,0 +1,333 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "pathgraph.h"
+
+#include "map.h"
+
+#include <algorithm>
+#include <gtl/phmap.hpp>
+
+namespace BlackTek::World
+{
+    namespace
+    {
+        constexpr int32_t CellCount = Floor::Size * Floor::Size;
+
+        [[nodiscard]] constexpr uint64_t LayerKey(const int32_t chunkX, const int32_t chunkY, const uint8_t z) noexcept
+        {
+            return (static_cast<uint64_t>(chunkX) << 24) | (static_cast<uint64_t>(chunkY) << 8) | z;
+        }
+
+        // search nodes are a transition of a layer, a layer never has more than 4 sides * 4 openings
+        [[nodiscard]] constexpr uint64_t NodeId(const uint64_t layerKey, const size_t transition) noexcept
+        {
+            return (layerKey << 5) | transition;
+        }
+
+        constexpr uint64_t GoalNode = ~uint64_t{ 0 };
+        constexpr uint64_t StartNode = GoalNode - 1;
+
+        uint64_t WalkableMask(Map& map, const Chunk* chunk, const uint8_t z)
+        {
+            if (not chunk)
+                return 0;
+
+            const uint64_t blocked = chunk->block_path_mask[z] | chunk->block_solid_mask[z];
+            uint64_t walkable = 0;
+
+            for (int32_t bit = 0; bit < CellCount; ++bit)
+            {
+                if ((blocked >> bit) & 1u)
+                    continue;
+
+                // only the offset inside the chunk matters here
+                const auto& tile = map.getTileInChunk(chunk, static_cast<uint16_t>(bit & Floor::Mask), static_cast<uint16_t>(bit >> Floor::Bits), z);
+                if (not tile or not tile->getGround() or tile->hasFlag(TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT))
+                    continue;
+
+                walkable |= uint64_t{ 1 } << bit;
+            }
+            return walkable;
+        }
+
+        // Dijkstra over the 64 cells of one chunk with the A* step costs. The seed counts as walkable.
+        void LocalDistances(const uint64_t walkable, const uint8_t seed, std::array<uint16_t, CellCount>& distances)
+        {
+            distances.fill(PathGraph::Unreachable);
+            distances[seed] = 0;
+
+            std::array<bool, CellCount> done{};
+            while (true)
+            {
+                int32_t current = -1;
+                for (int32_t cell = 0; cell < CellCount; ++cell)
+                {
+                    if (not done[cell] and distances[cell] != PathGraph::Unreachable and (current == -1 or distances[cell] < distances[current]))
+                        current = cell;
+                }
+
+                if (current == -1)
+                    break;
+
+                done[current] = true;
+                const int32_t x = current & Floor::Mask;
+                const int32_t y = current >> Floor::Bits;
+
+                for (int32_t dy = -1; dy <= 1; ++dy)
+                {
+                    for (int32_t dx = -1; dx <= 1; ++dx)
+                    {
+                        const int32_t nx = x + dx;
+                        const int32_t ny = y + dy;
+                        if ((dx == 0 and dy == 0) or nx < 0 or ny < 0 or nx >= Floor::Size or ny >= Floor::Size)
+                            continue;
+
+                        const int32_t neighbor = ny * Floor::Size + nx;
+                        if (not ((walkable >> neighbor) & 1u))
+                            continue;
+
+                        const uint32_t cost = distances[current] + (dx != 0 and dy != 0 ? MAP_DIAGONALWALKCOST : MAP_NORMALWALKCOST);
+                        if (cost < distances[neighbor])
+                            distances[neighbor] = static_cast<uint16_t>(cost);
+                    }
+                }
+            }
+        }
+
+        // the cell of a border, `index` counting along it
+        [[nodiscard]] constexpr uint8_t BorderCell(const uint8_t side, const int32_t index) noexcept
+        {
+            switch (side)
+            {
+                case 0: return static_cast<uint8_t>(index);                                       // north, y = 0
+                case 1: return static_cast<uint8_t>(index * Floor::Size + Floor::Mask);           // east, x = 7
+                case 2: return static_cast<uint8_t>(Floor::Mask * Floor::Size + index);           // south, y = 7
+                default: return static_cast<uint8_t>(index * Floor::Size);                        // west, x = 0
+            }
+        }
+
+        [[nodiscard]] constexpr uint8_t OppositeSide(const uint8_t side) noexcept
+        {
+            return (side + 2) & 3;
+        }
+    }
+
+    const PathGraph::Layer& PathGraph::GetLayer(Map& map, const int32_t chunkX, const int32_t chunkY, const uint8_t z)
+    {
+        const auto chunkAt = [&map](const int32_t x, const int32_t y) -> const Chunk* {
+            if (x < 0 or y < 0 or x > (0xFFFF >> Floor::Bits) or y > (0xFFFF >> Floor::Bits))
+                return nullptr;
+            return map.getChunk(static_cast<uint16_t>(x << Floor::Bits), static_cast<uint16_t>(y << Floor::Bits));
+        };
+
+        const std::array<const Chunk*, 5> chunks = {
+            chunkAt(chunkX, chunkY), chunkAt(chunkX, chunkY - 1), chunkAt(chunkX + 1, chunkY), chunkAt(chunkX, chunkY + 1), chunkAt(chunkX - 1, chunkY)
+        };
+
+        std::array<uint32_t, 5> revisions;
+        for (size_t i = 0; i < chunks.size(); ++i)
+            revisions[i] = chunks[i] ? chunks[i]->path_revision[z] : ~uint32_t{ 0 };
+
+        auto& layer = layers[LayerKey(chunkX, chunkY, z)];
+        if (not layer.built or layer.revisions != revisions)
+        {
+            BuildLayer(map, layer, chunks, z);
+            layer.revisions = revisions;
+            layer.built = true;
+        }
+        return layer;
+    }
+
+    void PathGraph::BuildLayer(Map& map, Layer& layer, const std::array<const Chunk*, 5>& chunks, const uint8_t z)
+    {
+        layer.walkable = WalkableMask(map, chunks[0], z);
+        layer.transitions.clear();
+        layer.costs.clear();
+
+        if (layer.walkable == 0)
+            return;
+
+        // one transition in the middle of every run of border cells that are open on both sides
+        for (uint8_t side = North; side <= West; ++side)
+        {
+            const uint64_t neighborWalkable = WalkableMask(map, chunks[side + 1], z);
+            const uint8_t opposite = OppositeSide(side);
+
+            int32_t runStart = -1;
+            for (int32_t index = 0; index <= Floor::Size; ++index)
+            {
+                const bool open = index < Floor::Size
+                    and ((layer.walkable >> BorderCell(side, index)) & 1u)
+                    and ((neighborWalkable >> BorderCell(opposite, index)) & 1u);
+
+                if (open and runStart == -1)
+                {
+                    runStart = index;
+                }
+                else if (not open and runStart != -1)
+                {
+                    layer.transitions.push_back({ BorderCell(side, (runStart + index - 1) / 2), static_cast<Side>(side) });
+                    runStart = -1;
+                }
+            }
+        }
+
+        const size_t count = layer.transitions.size();
+        layer.costs.assign(count * count, Unreachable);
+
+        std::array<uint16_t, CellCount> distances;
+        for (size_t from = 0; from < count; ++from)
+        {
+            LocalDistances(layer.walkable, layer.transitions[from].local, distances);
+            for (size_t to = 0; to < count; ++to)
+                layer.costs[from * count + to] = distances[layer.transitions[to].local];
+        }
+    }
+
+    bool PathGraph::FindRoute(Map& map, const Position& start, const Position& goal, const int32_t maxSearchDist, std::vector<Position>& waypoints)
+    {
+        if (start.z != goal.z or start.z >= MaxLayers)
+            return false;
+
+        const ChunkCoord startCoord = ToChunkCoord(start.x, start.y);
+        const ChunkCoord goalCoord = ToChunkCoord(goal.x, goal.y);
+        if (startCoord == goalCoord)
+            return false;
+
+        const uint8_t z = start.z;
+        const uint64_t startKey = LayerKey(startCoord.chunk_x, startCoord.chunk_y, z);
+        const uint64_t goalKey = LayerKey(goalCoord.chunk_x, goalCoord.chunk_y, z);
+
+        const Layer& startLayer = GetLayer(map, startCoord.chunk_x, startCoord.chunk_y, z);
+        const Layer& goalLayer = GetLayer(map, goalCoord.chunk_x, goalCoord.chunk_y, z);
+        if (startLayer.transitions.empty() or goalLayer.transitions.empty())
+            return false;
+
+        std::array<uint16_t, CellCount> startDistances;
+        std::array<uint16_t, CellCount> goalDistances;
+        LocalDistances(startLayer.walkable, static_cast<uint8_t>((start.y & Floor::Mask) * Floor::Size + (start.x & Floor::Mask)), startDistances);
+        LocalDistances(goalLayer.walkable, static_cast<uint8_t>((goal.y & Floor::Mask) * Floor::Size + (goal.x & Floor::Mask)), goalDistances);
+
+        const auto transitionPosition = [z](const uint64_t layerKey, const Transition& transition) {
+            const int32_t chunkX = static_cast<int32_t>(layerKey >> 24);
+            const int32_t chunkY = static_cast<int32_t>((layerKey >> 8) & 0xFFFF);
+            return Position(static_cast<uint16_t>((chunkX << Floor::Bits) + (transition.local & Floor::Mask)),
+                static_cast<uint16_t>((chunkY << Floor::Bits) + (transition.local >> Floor::Bits)), z);
+        };
+
+        struct Record
+        {
+            uint32_t g;
+            uint64_t parent;
+            Position position;
+            bool closed = false;
+        };
+
+        gtl::flat_hash_map<uint64_t, Record> records;
+        std::vector<std::pair<uint32_t, uint64_t>> open;
+        const auto byCost = [](const auto& a, const auto& b) { return a.first > b.first; };
+
+        const auto push = [&](const uint64_t node, const uint32_t g, const uint64_t parent, const Position& position) {
+            if (maxSearchDist != 0 and (Position::getDistanceX(start, position) > maxSearchDist or Position::getDistanceY(start, position) > maxSearchDist))
+                return;
+
+            auto [it, inserted] = records.try_emplace(node, Record{ g, parent, position });
+            if (not inserted)
+            {
+                if (it->second.closed or it->second.g <= g)
+                    return;
+
+                it->second.g = g;
+                it->second.parent = parent;
+            }
+
+            const uint32_t h = std::max(Position::getDistanceX(position, goal), Position::getDistanceY(position, goal)) * MAP_NORMALWALKCOST;
+            open.emplace_back(g + h, node);
+            std::ranges::push_heap(open, byCost);
+        };
+
+        for (size_t i = 0; i < startLayer.transitions.size(); ++i)
+        {
+            if (const uint16_t distance = startDistances[startLayer.transitions[i].local]; distance != Unreachable)
+                push(NodeId(startKey, i), distance, StartNode, transitionPosition(startKey, startLayer.transitions[i]));
+        }
+
+        uint32_t expanded = 0;
+        while (not open.empty())
+        {
+            std::ranges::pop_heap(open, byCost);
+            const uint64_t node = open.back().second;
+            open.pop_back();
+
+            auto& record = records.at(node);
+            if (record.closed)
+                continue;
+            record.closed = true;
+
+            if (node == GoalNode)
+            {
+                waypoints.clear();
+                for (uint64_t step = record.parent; step != StartNode; step = records.at(step).parent)
+                    waypoints.push_back(records.at(step).position);
+
+                std::ranges::reverse(waypoints);
+                return true;
+            }
+
+            if (++expanded > MaxExpandedNodes)
+                return false;
+
+            const uint32_t g = record.g;
+            const uint64_t layerKey = node >> 5;
+            const size_t index = node & 31;
+            const int32_t chunkX = static_cast<int32_t>(layerKey >> 24);
+            const int32_t chunkY = static_cast<int32_t>((layerKey >> 8) & 0xFFFF);
+
+            const Layer& layer = GetLayer(map, chunkX, chunkY, z);
+            if (index >= layer.transitions.size())
+                continue;
+
+            const Transition transition = layer.transitions[index];
+
+            // step over the border onto the matching transition of the neighbor
+            static constexpr int32_t sideOffsets[4][2] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+            const int32_t neighborX = chunkX + sideOffsets[transition.side][0];
+            const int32_t neighborY = chunkY + sideOffsets[transition.side][1];
+            if (neighborX >= 0 and neighborY >= 0)
+            {
+                const uint64_t neighborKey = LayerKey(neighborX, neighborY, z);
+                const Layer& neighbor = GetLayer(map, neighborX, neighborY, z);
+                const uint8_t opposite = OppositeSide(transition.side);
+                const int32_t borderIndex = (transition.side == North or transition.side == South) ? (transition.local & Floor::Mask) : (transition.local >> Floor::Bits);
+                const uint8_t mirrored = BorderCell(opposite, borderIndex);
+
+                for (size_t i = 0; i < neighbor.transitions.size(); ++i)
+                {
+                    if (neighbor.transitions[i].side == opposite and neighbor.transitions[i].local == mirrored)
+                    {
+                        push(NodeId(neighborKey, i), g + MAP_NORMALWALKCOST, node, transitionPosition(neighborKey, neighbor.transitions[i]));
+                        break;
+                    }
+                }
+            }
+
+            // walk across this chunk to its other transitions
+            const size_t count = layer.transitions.size();
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (const uint16_t cost = layer.costs[index * count + i]; i != index and cost != Unreachable)
+                    push(NodeId(layerKey, i), g + cost, node, transitionPosition(layerKey, layer.transitions[i]));
+            }
+
+            if (layerKey == goalKey)
+            {
+                if (const uint16_t distance = goalDistances[transition.local]; distance != Unreachable)
+                    push(GoalNode, g + distance, node, goal);
+            }
+        }
+        return false;
+    }
+}
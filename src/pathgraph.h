@@ -0,0 +1,65 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "position.h"
+
+class Map;
+
+namespace BlackTek::World
+{
+    struct Chunk;
+
+    // Abstract graph over the chunk grid for paths too long for the tile A* (HPA*). Every opening between
+    // two neighboring chunks on a floor gets a transition node on both sides, the transitions of a chunk are
+    // connected by their walking distance inside of it. Walkability comes from the chunk path/solid bitmaps
+    // plus tile and ground presence, the per chunk part is rebuilt lazily once Chunk::path_revision of the
+    // chunk or one of its four neighbors moved on.
+    class PathGraph
+    {
+    public:
+        static constexpr uint16_t Unreachable = 0xFFFF;
+        // abstract nodes expanded before a route search gives up
+        static constexpr uint32_t MaxExpandedNodes = 4096;
+
+        // Transition tiles leading from start to goal in walking order, start and goal not included. Fails when
+        // both lie in the same chunk, the goal chunk can't be reached or, with maxSearchDist set, the route
+        // would leave the square of that radius around start.
+        bool FindRoute(Map& map, const Position& start, const Position& goal, int32_t maxSearchDist, std::vector<Position>& waypoints);
+
+        void Clear() { layers.clear(); }
+
+    private:
+        enum Side : uint8_t { North, East, South, West };
+
+        struct Transition
+        {
+            uint8_t local;  // y * Floor::Size + x inside the chunk
+            Side side;
+        };
+
+        struct Layer
+        {
+            // own, north, east, south, west; ~0 for a missing chunk
+            std::array<uint32_t, 5> revisions{};
+            bool built = false;
+            uint64_t walkable = 0;
+            std::vector<Transition> transitions;
+            // transitions.size() squared, walking cost between two transitions inside the chunk
+            std::vector<uint16_t> costs;
+        };
+
+        // references stay valid while other layers are inserted during a search
+        const Layer& GetLayer(Map& map, int32_t chunkX, int32_t chunkY, uint8_t z);
+        // chunks are own, north, east, south, west
+        static void BuildLayer(Map& map, Layer& layer, const std::array<const Chunk*, 5>& chunks, uint8_t z);
+
+        std::unordered_map<uint64_t, Layer> layers;
+    };
+}
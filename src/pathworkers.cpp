@@ -0,0 +1,95 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "pathworkers.h"
+#include "configmanager.h"
+#include "map.h"
+#include "tasks.h"
+
+extern ConfigManager g_config;
+extern Dispatcher g_dispatcher;
+
+void PathWorkers::start()
+{
+	const int32_t threadCount = g_config.GetNumber(ConfigManager::PATH_THREADS);
+	if (threadCount <= 0) {
+		return;
+	}
+
+	// the first worker runs on the ThreadHolder thread
+	ThreadHolder::start();
+	for (int32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(&PathWorkers::workerMain, this);
+	}
+}
+
+void PathWorkers::join()
+{
+	ThreadHolder::join();
+	for (auto& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+}
+
+void PathWorkers::threadMain()
+{
+	workerMain();
+}
+
+void PathWorkers::workerMain()
+{
+	std::vector<Direction> dirList;
+
+	std::unique_lock<std::mutex> requestLockUnique(requestLock);
+	while (true) {
+		if (requests.empty()) {
+			if (getState() == THREAD_STATE_TERMINATED) {
+				break;
+			}
+
+			requestSignal.wait(requestLockUnique);
+			continue;
+		}
+
+		PathRequest request = std::move(requests.front());
+		requests.pop_front();
+		requestLockUnique.unlock();
+
+		dirList.clear();
+		const bool found = Map::getPathMatching(*request.snapshot, request.startPos, dirList, FrozenPathingConditionCall(request.targetPos), request.fpp);
+
+		g_dispatcher.addTask([callback = std::move(request.callback), found, dirList = dirList]() mutable {
+			callback(found, std::move(dirList));
+		});
+
+		requestLockUnique.lock();
+	}
+}
+
+void PathWorkers::addRequest(PathRequest&& request)
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(requestLock);
+		if (getState() != THREAD_STATE_RUNNING) {
+			return;
+		}
+
+		requests.push_back(std::move(request));
+	}
+	requestSignal.notify_one();
+}
+
+void PathWorkers::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lockGuard(requestLock);
+		setState(THREAD_STATE_TERMINATED);
+		// whatever is still queued would only answer to a dispatcher that is going away
+		requests.clear();
+	}
+	requestSignal.notify_all();
+}
@@ -0,0 +1,56 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_PATHWORKERS_H
+#define FS_PATHWORKERS_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "thread_holder_base.h"
+#include "creature.h"
+#include "walksnapshot.h"
+
+struct PathRequest {
+	std::shared_ptr<const BlackTek::World::WalkSnapshot> snapshot;
+	Position startPos;
+	Position targetPos;
+	FindPathParams fpp;
+	// runs on the dispatcher with the search result
+	std::function<void(bool, std::vector<Direction>&&)> callback;
+};
+
+// Runs path searches against walk snapshots on a pool of threads (`path_threads` in server.toml,
+// 0 keeps every search on the dispatcher). Searches only see what the snapshot holds, so requests
+// have to do without a clear sight check, and their result is meant to be checked against the
+// live map once it is back on the dispatcher.
+class PathWorkers : public ThreadHolder<PathWorkers>
+{
+	public:
+		PathWorkers() = default;
+		void start();
+		void join();
+		void shutdown();
+
+		bool isEnabled() const {
+			return getState() == THREAD_STATE_RUNNING;
+		}
+
+		void addRequest(PathRequest&& request);
+
+		void threadMain();
+	private:
+		void workerMain();
+
+		std::vector<std::thread> threads;
+		std::deque<PathRequest> requests;
+		std::mutex requestLock;
+		std::condition_variable requestSignal;
+};
+
+extern PathWorkers g_pathWorkers;
+
+#endif
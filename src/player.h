@@ -19,6 +19,7 @@
 #include "augments.h"
 #include "accountmanager.h"
 
+#include <array>
 #include <bitset>
 #include <optional>
 #include <gtl/phmap.hpp>
@@ -1023,6 +1024,14 @@ class Player final : public Creature
 		LightInfo itemsLight;
 
 		gtl::btree_map<uint32_t, int32_t> storageMap;
+		// fingerprint of each save section as the database holds it after the last finished save,
+		// valid once savedSectionVersion is set; see IOLoginData::snapshotPlayer
+		std::array<uint64_t, PLAYER_SAVE_SECTION_COUNT> savedSectionHashes{};
+		uint64_t savedSectionVersion = 0;
+		// last save version handed out when this instance was loaded, anything up to it was taken of
+		// an earlier session of the character
+		uint64_t loginSaveVersion = 0;
+		uint32_t pendingSaves = 0;
 		Skill skills[SKILL_LAST + 1];
 		std::forward_list<PartyPtr> invitePartyList;
 		std::forward_list<uint32_t> modalWindows;
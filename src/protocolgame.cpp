@@ -739,35 +739,66 @@ void ProtocolGame::parsePacket(NetworkMessage& msg)
 	}
 }
 
-void ProtocolGame::GetTileDescription(const TileConstPtr& tile, NetworkMessage& msg)
+const TileDescriptionCache& ProtocolGame::GetTileDescriptionCache(const TileConstPtr& tile)
 {
-	msg.add<SpecialCode>(SpecialCode::Zero); //environmental effects
+	auto& cache = tile->getDescriptionCache();
+	if (cache.valid)
+	{
+		return cache;
+	}
+
+	// NetworkMessage owns the item encoding, so encode into a scratch message and keep its body;
+	// map descriptions are only ever built on the dispatcher thread
+	static NetworkMessage scratch;
+	scratch.reset();
+
+	scratch.add<SpecialCode>(SpecialCode::Zero); //environmental effects
 
-	int32_t count;
+	uint8_t count = 0;
 	if (const auto& ground = tile->getGround())
 	{
-		msg.addItem(ground);
-		count = 1;
-	} 
-	else
-	{
-		count = 0;
+		scratch.addItem(ground);
+		++count;
 	}
 
 	const auto& items = tile->getItemList();
 	if (items)
 	{
-		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end; ++it)
+		for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end and count < TileDescriptionCache::MAX_THINGS; ++it)
 		{
-			msg.addItem(*it);
+			scratch.addItem(*it);
+			++count;
+		}
+	}
 
-			if (++count == 10)
-			{
-				break;
-			}
+	cache.headCount = count;
+	cache.headSize = scratch.getLength();
+	cache.downCount = 0;
+
+	// creatures go between the top and down items, so a viewer may see fewer of these
+	if (items)
+	{
+		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end and count + cache.downCount < TileDescriptionCache::MAX_THINGS; ++it)
+		{
+			scratch.addItem(*it);
+			cache.downEnds[cache.downCount++] = scratch.getLength();
 		}
 	}
 
+	const uint8_t* body = scratch.getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION;
+	cache.bytes.assign(body, body + scratch.getLength());
+	cache.valid = true;
+	return cache;
+}
+
+void ProtocolGame::GetTileDescription(const TileConstPtr& tile, NetworkMessage& msg)
+{
+	const auto& cache = GetTileDescriptionCache(tile);
+	const char* bytes = reinterpret_cast<const char*>(cache.bytes.data());
+	msg.addBytes(bytes, cache.headSize);
+
+	int32_t count = cache.headCount;
+
 	if (const auto& creatures = tile->getCreatures())
 	{
 		for (const auto& creature : boost::adaptors::reverse(creatures->getList()))
@@ -785,17 +816,10 @@ void ProtocolGame::GetTileDescription(const TileConstPtr& tile, NetworkMessage&
 		}
 	}
 
-	if (items and count < 10)
+	if (count < 10 and cache.downCount != 0)
 	{
-		for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end; ++it)
-		{
-			msg.addItem(*it);
-
-			if (++count == 10)
-			{
-				return;
-			}
-		}
+		const int32_t downItems = std::min<int32_t>(cache.downCount, 10 - count);
+		msg.addBytes(bytes + cache.headSize, cache.downEnds[downItems - 1] - cache.headSize);
 	}
 }
 
@@ -860,6 +884,129 @@ void ProtocolGame::GetFloorDescription(NetworkMessage& msg, int32_t x, int32_t y
 	}
 }
 
+namespace {
+
+// The item encoding GetTileDescription did per viewer before TileDescriptionCache, kept as the
+// baseline for RunMapDescriptionBenchmark.
+void addTileItemsUncached(NetworkMessage& msg, const TileConstPtr& tile)
+{
+	msg.add<SpecialCode>(SpecialCode::Zero);
+
+	int32_t count = 0;
+	if (const auto& ground = tile->getGround())
+	{
+		msg.addItem(ground);
+		++count;
+	}
+
+	const auto& items = tile->getItemList();
+	if (not items)
+	{
+		return;
+	}
+
+	for (auto it = items->getBeginTopItem(), end = items->getEndTopItem(); it != end and count < 10; ++it)
+	{
+		msg.addItem(*it);
+		++count;
+	}
+
+	for (auto it = items->getBeginDownItem(), end = items->getEndDownItem(); it != end and count < 10; ++it)
+	{
+		msg.addItem(*it);
+		++count;
+	}
+}
+
+}
+
+void ProtocolGame::RunMapDescriptionBenchmark(const Position& center, uint32_t rounds)
+{
+	// the area and floors sendMapDescription covers
+	const int32_t x = center.x - Map::maxClientViewportX;
+	const int32_t y = center.y - Map::maxClientViewportY;
+	const int32_t width = (Map::maxClientViewportX * 2) + 2;
+	const int32_t height = (Map::maxClientViewportY * 2) + 2;
+	const int32_t z = center.z;
+
+	const int32_t startz = z > 7 ? z - 2 : 7;
+	const int32_t endz = z > 7 ? std::min<int32_t>(BlackTek::World::MaxLayers - 1, z + 2) : 0;
+	const int32_t zstep = z > 7 ? 1 : -1;
+
+	auto describe = [&](NetworkMessage& msg, bool cached) {
+		msg.reset();
+		uint32_t tiles = 0;
+		for (int32_t nz = startz; nz != endz + zstep; nz += zstep)
+		{
+			const int32_t offset = z - nz;
+			for (int32_t nx = 0; nx < width; ++nx)
+			{
+				for (int32_t ny = 0; ny < height; ++ny)
+				{
+					const auto& tile = g_game.map.getTile(x + nx + offset, y + ny + offset, nz);
+					if (not tile)
+					{
+						continue;
+					}
+
+					++tiles;
+					if (not cached)
+					{
+						addTileItemsUncached(msg, tile);
+						continue;
+					}
+
+					const auto& cache = GetTileDescriptionCache(tile);
+					const char* bytes = reinterpret_cast<const char*>(cache.bytes.data());
+					const size_t size = cache.downCount != 0 ? cache.downEnds[cache.downCount - 1] : cache.headSize;
+					msg.addBytes(bytes, size);
+				}
+			}
+		}
+		return tiles;
+	};
+
+	using Clock = std::chrono::steady_clock;
+	auto nanosPerRound = [rounds](Clock::duration elapsed) {
+		return std::chrono::duration<double, std::nano>(elapsed).count() / rounds;
+	};
+
+	// both messages live on the heap, a NetworkMessage is too large to keep two on the stack
+	auto uncachedMsg = std::make_unique<NetworkMessage>();
+	auto cachedMsg = std::make_unique<NetworkMessage>();
+
+	auto start = Clock::now();
+	uint32_t tileCount = 0;
+	for (uint32_t i = 0; i < rounds; ++i)
+	{
+		tileCount = describe(*uncachedMsg, false);
+	}
+	const double uncachedNanos = nanosPerRound(Clock::now() - start);
+
+	start = Clock::now();
+	describe(*cachedMsg, true);
+	const double coldNanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+	start = Clock::now();
+	for (uint32_t i = 0; i < rounds; ++i)
+	{
+		describe(*cachedMsg, true);
+	}
+	const double cachedNanos = nanosPerRound(Clock::now() - start);
+
+	const bool identical = uncachedMsg->getLength() == cachedMsg->getLength()
+		and std::memcmp(uncachedMsg->getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION,
+			cachedMsg->getBuffer() + NetworkMessage::INITIAL_BUFFER_POSITION, uncachedMsg->getLength()) == 0;
+
+	fmt::print("\n    Map description benchmark at [x: {}, y: {}, z: {}]: {} tiles, {} bytes, {} rounds\n\n",
+		center.x, center.y, static_cast<int32_t>(center.z), tileCount, uncachedMsg->getLength(), rounds);
+	fmt::print("    {:<28} {:>12.1f} us\n", "per item encoding", uncachedNanos / 1000.0);
+	fmt::print("    {:<28} {:>12.1f} us\n", "cached, first (builds)", coldNanos / 1000.0);
+	fmt::print("    {:<28} {:>12.1f} us {:>7.2f}x\n", "cached", cachedNanos / 1000.0, uncachedNanos / cachedNanos);
+	fmt::print("\n    {}\n\n", identical ? "Cached and per item encoding produce identical bytes."
+		: "MISMATCH between cached and per item encoding!");
+}
+
 void ProtocolGame::checkCreatureAsKnown(uint32_t id, bool& known, uint32_t& removedKnown)
 {
 	const auto result = knownCreatureSet.Insert(id);
@@ -1535,9 +1682,7 @@ void ProtocolGame::sendCreatureOutfit(const CreatureConstPtr& creature, const Ou
 	}
 
 	NetworkMessage msg;
-	msg.add(ServerCode::CreatureOutfit);
-	msg.add<uint32_t>(creature->getID());
-	AddOutfit(msg, outfit);
+	AddCreatureOutfit(msg, creature, outfit);
 	writeToOutputBuffer(msg);
 }
 
@@ -2727,35 +2872,7 @@ void ProtocolGame::sendCreatureTurn(const CreatureConstPtr& creature, uint32_t s
 void ProtocolGame::sendCreatureSay(const CreatureConstPtr& creature, SpeakClasses type, const std::string& text, const Position* pos/* = nullptr*/)
 {
 	NetworkMessage msg;
-	msg.add(ServerCode::CreatureSay);
-
-	static uint32_t statementId = 0;
-	msg.add<uint32_t>(++statementId);
-
-	msg.addString(creature->getName());
-
-	//Add level only for players
-	if (const auto& speaker = creature->getPlayer())
-	{
-		msg.add<uint16_t>(speaker->getLevel());
-	}
-	else
-	{
-		msg.add<SpecialCode>(SpecialCode::Zero);
-	}
-
-	msg.addByte(type);
-
-	if (pos)
-	{
-		msg.addPosition(*pos);
-	}
-	else
-	{
-		msg.addPosition(creature->getPosition());
-	}
-
-	msg.addString(text);
+	AddCreatureSay(msg, creature, type, text, pos ? *pos : creature->getPosition());
 	writeToOutputBuffer(msg);
 }
 
@@ -2821,10 +2938,7 @@ void ProtocolGame::sendCancelTarget()
 void ProtocolGame::sendChangeSpeed(const CreatureConstPtr& creature, uint32_t speed)
 {
 	NetworkMessage msg;
-	msg.add(ServerCode::CreatureSpeed);
-	msg.add<uint32_t>(creature->getID());
-	msg.add<uint16_t>(creature->getBaseSpeed() / 2);
-	msg.add<uint16_t>(speed / 2);
+	AddCreatureSpeed(msg, creature, speed);
 	writeToOutputBuffer(msg);
 }
 
@@ -3800,6 +3914,45 @@ void ProtocolGame::AddOutfit(NetworkMessage& msg, const Outfit_t& outfit)
 	msg.add<uint16_t>(outfit.lookMount);
 }
 
+void ProtocolGame::AddCreatureOutfit(NetworkMessage& msg, const CreatureConstPtr& creature, const Outfit_t& outfit)
+{
+	msg.add(ServerCode::CreatureOutfit);
+	msg.add<uint32_t>(creature->getID());
+	AddOutfit(msg, outfit);
+}
+
+void ProtocolGame::AddCreatureSpeed(NetworkMessage& msg, const CreatureConstPtr& creature, uint32_t speed)
+{
+	msg.add(ServerCode::CreatureSpeed);
+	msg.add<uint32_t>(creature->getID());
+	msg.add<uint16_t>(creature->getBaseSpeed() / 2);
+	msg.add<uint16_t>(speed / 2);
+}
+
+void ProtocolGame::AddCreatureSay(NetworkMessage& msg, const CreatureConstPtr& creature, SpeakClasses type, const std::string& text, const Position& pos)
+{
+	msg.add(ServerCode::CreatureSay);
+
+	static uint32_t statementId = 0;
+	msg.add<uint32_t>(++statementId);
+
+	msg.addString(creature->getName());
+
+	//Add level only for players
+	if (const auto& speaker = creature->getPlayer())
+	{
+		msg.add<uint16_t>(speaker->getLevel());
+	}
+	else
+	{
+		msg.add<SpecialCode>(SpecialCode::Zero);
+	}
+
+	msg.addByte(type);
+	msg.addPosition(pos);
+	msg.addString(text);
+}
+
 void ProtocolGame::AddWorldLight(NetworkMessage& msg, LightInfo lightInfo) const
 {
 	msg.add(ServerCode::WorldLight);
@@ -89,11 +89,21 @@ class ProtocolGame final : public Protocol
 			return version;
 		}
 
+		// These encode packets that read the same for every viewer, so Game builds them once per
+		// event and appends the same message to each spectator's output buffer.
 		static void AddCreatureHealth(NetworkMessage& msg, const CreatureConstPtr& creature);
+		static void AddCreatureOutfit(NetworkMessage& msg, const CreatureConstPtr& creature, const Outfit_t& outfit);
+		static void AddCreatureSpeed(NetworkMessage& msg, const CreatureConstPtr& creature, uint32_t speed);
+		static void AddCreatureSay(NetworkMessage& msg, const CreatureConstPtr& creature, SpeakClasses type, const std::string& text, const Position& pos);
 		static void AddMagicEffect(NetworkMessage& msg, const Position& pos, uint8_t type);
 		static void AddDistanceShoot(NetworkMessage& msg, const Position& from, const Position& to, uint8_t type);
 		static void AddTextMessage(NetworkMessage& msg, const TextMessage& message);
 
+		// Encodes the item part of the full map description around `center` with and without the
+		// tile description cache, checks both give the same bytes and prints the timings. Creatures
+		// are left out, they are encoded per viewer either way. Run by --map-description-bench.
+		static void RunMapDescriptionBenchmark(const Position& center, uint32_t rounds = 500);
+
 	private:
 		ProtocolGame_ptr getThis() {
 			return std::static_pointer_cast<ProtocolGame>(shared_from_this());
@@ -315,6 +325,9 @@ class ProtocolGame final : public Protocol
 		// translate a tile to client-readable format
 		void GetTileDescription(const TileConstPtr& tile, NetworkMessage& msg);
 
+		// the viewer independent part of GetTileDescription, rebuilt here whenever the tile marked it stale
+		static const TileDescriptionCache& GetTileDescriptionCache(const TileConstPtr& tile);
+
 		// translate a floor to client-readable format
 		void GetFloorDescription(NetworkMessage& msg, int32_t x, int32_t y, int32_t z,
 		                         int32_t width, int32_t height, int32_t offset, int32_t& skip);
@@ -325,7 +338,7 @@ class ProtocolGame final : public Protocol
 
 		void AddCreature(NetworkMessage& msg, const CreatureConstPtr& creature, bool known, uint32_t remove);
 		void AddPlayerStats(NetworkMessage& msg) const;
-		void AddOutfit(NetworkMessage& msg, const Outfit_t& outfit);
+		static void AddOutfit(NetworkMessage& msg, const Outfit_t& outfit);
 		void AddPlayerSkills(NetworkMessage& msg) const;
 		void AddWorldLight(NetworkMessage& msg, LightInfo lightInfo) const;
 		void AddCreatureLight(NetworkMessage& msg, const CreatureConstPtr& creature) const;
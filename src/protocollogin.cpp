@@ -9,6 +9,7 @@
 #include "tasks.h"
 
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "iologindata.h"
 #include "ban.h"
 #include "game.h"
@@ -52,12 +53,23 @@ void ProtocolLogin::getCharacterList(const std::string& accountName, const std::
 		return;
 	}
 
-	Account account;
-	if (!IOLoginData::loginserverAuthentication(accountName, password, account)) {
-		disconnectClient("Account name or password is not correct.", version);
-		return;
-	}
+	// looked up on the priority lane, so queued saves and script queries don't hold up the login
+	auto account = std::make_shared<Account>();
+	g_databaseTasks.addPriorityJob([=](Database& db) {
+		return IOLoginData::loginserverAuthentication(db, accountName, password, *account);
+	}, [thisPtr = std::static_pointer_cast<ProtocolLogin>(shared_from_this()), account, accountName, password, token, version](DBResult_ptr, bool success) {
+		if (!success) {
+			thisPtr->disconnectClient("Account name or password is not correct.", version);
+			return;
+		}
 
+		thisPtr->sendCharacterList(*account, accountName, password, token, version);
+	});
+}
+
+void ProtocolLogin::sendCharacterList(const Account& account, const std::string& accountName, const std::string& password, const std::string& token, uint16_t version)
+{
+	//dispatcher thread
 	uint32_t ticks = time(nullptr) / AUTHENTICATOR_PERIOD;
 
 	auto output = OutputMessagePool::getOutputMessage();
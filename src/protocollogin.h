@@ -8,6 +8,7 @@
 
 class NetworkMessage;
 class OutputMessage;
+struct Account;
 
 class ProtocolLogin : public Protocol
 {
@@ -28,6 +29,7 @@ class ProtocolLogin : public Protocol
 		void disconnectClient(const std::string& message, uint16_t version);
 
 		void getCharacterList(const std::string& accountName, const std::string& password, const std::string& token, uint16_t version);
+		void sendCharacterList(const Account& account, const std::string& accountName, const std::string& password, const std::string& token, uint16_t version);
 };
 
 #endif
@@ -7,33 +7,51 @@
 #include <boost/asio/post.hpp>
 #include <memory>
 
+uint64_t Scheduler::currentTick() const
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
 uint32_t Scheduler::addEvent(SchedulerTask* task)
 {
+	if (getState() == THREAD_STATE_TERMINATED) {
+		delete task;
+		return 0;
+	}
+
 	// check if the event has a valid id
 	if (task->getEventId() == 0) {
 		task->setEventId(++lastEventId);
 	}
 
-	boost::asio::post(io_context, [this, task]() {
-		// insert the event id in the list of active events
-		auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
-		auto& timer = it.first->second;
+	// the task may be fired and deleted as soon as eventLock is released
+	const uint32_t eventId = task->getEventId();
 
-		timer.expires_after(std::chrono::milliseconds(task->getDelay()));
-		timer.async_wait([this, task](const boost::system::error_code& error) {
-			eventIdTimerMap.erase(task->getEventId());
+	bool rearm = false;
+	{
+		std::lock_guard<std::mutex> lockClass(eventLock);
 
-			if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
-				// the timer has been manually canceled(timer->cancel()) or Scheduler::shutdown has been called
-				delete task;
-				return;
-			}
+		const uint64_t now = currentTick();
+		if (wheel.empty()) {
+			// nothing can expire, just catch the wheel up so the new event lands in level 0 if it can
+			wheel.advance(now, [](BlackTek::TimerWheelNode*) {});
+		}
 
-			g_dispatcher.addTask(task);
-		});
-	});
+		// insert the event id in the list of active events
+		events[eventId] = task;
+		wheel.schedule(task, now + task->getDelay());
 
-	return task->getEventId();
+		// the wheel timer only has to move if this event is due before whatever it waits for now
+		if (task->wheel_expiry < armedTick) {
+			armedTick = task->wheel_expiry;
+			rearm = true;
+		}
+	}
+
+	if (rearm) {
+		boost::asio::post(io_context, [this]() { rearmTimer(); });
+	}
+	return eventId;
 }
 
 void Scheduler::stopEvent(uint32_t eventId)
@@ -42,33 +60,87 @@ void Scheduler::stopEvent(uint32_t eventId)
 		return;
 	}
 
-	boost::asio::post(io_context, [this, eventId]() {
+	SchedulerTask* task;
+	{
+		std::lock_guard<std::mutex> lockClass(eventLock);
+
 		// search the event id
-		auto it = eventIdTimerMap.find(eventId);
-		if (it != eventIdTimerMap.end()) {
-			it->second.cancel();
+		auto it = events.find(eventId);
+		if (it == events.end()) {
+			return;
 		}
-	});
+
+		task = it->second;
+		events.erase(it);
+		wheel.cancel(task);
+	}
+
+	// the wheel timer may still go off for it; that wake simply finds nothing to do
+	delete task;
+}
+
+void Scheduler::rearmTimer()
+{
+	uint64_t wakeTick;
+	{
+		std::lock_guard<std::mutex> lockClass(eventLock);
+		wakeTick = armedTick;
+	}
+
+	if (wakeTick == NO_WAKE || getState() == THREAD_STATE_TERMINATED) {
+		return;
+	}
+
+	// expires_at() aborts the wait that is currently pending, if any
+	wheelTimer.expires_at(epoch + std::chrono::milliseconds(wakeTick));
+	wheelTimer.async_wait([this](const boost::system::error_code& error) { onTimer(error); });
+}
+
+void Scheduler::onTimer(const boost::system::error_code& error)
+{
+	if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
+		// superseded by an earlier event (rearmTimer) or Scheduler::shutdown has been called
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lockClass(eventLock);
+		wheel.advance(currentTick(), [this](BlackTek::TimerWheelNode* node) {
+			auto task = static_cast<SchedulerTask*>(node);
+			events.erase(task->getEventId());
+			expiredTasks.push_back(task);
+		});
+		armedTick = wheel.nextWakeTick().value_or(NO_WAKE);
+	}
+
+	for (SchedulerTask* task : expiredTasks) {
+		g_dispatcher.addTask(task);
+	}
+	expiredTasks.clear();
+
+	rearmTimer();
 }
 
 void Scheduler::shutdown()
 {
 	setState(THREAD_STATE_TERMINATED);
 	boost::asio::post(io_context, [this]() {
-		// cancel all active timers
-		for (auto& it : eventIdTimerMap) {
-			it.second.cancel();
+		{
+			// drop all pending events
+			std::lock_guard<std::mutex> lockClass(eventLock);
+			for (auto& it : events) {
+				wheel.cancel(it.second);
+				delete it.second;
+			}
+			events.clear();
+			armedTick = NO_WAKE;
 		}
 
+		wheelTimer.cancel();
 		io_context.stop();
 	});
 }
 
-SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f)
-{
-	return new SchedulerTask(delay, std::move(f));
-}
-
 namespace BlackTek::Scheduling
 {
 	boost::asio::awaitable<void> RunDispatcherHeartbeat(Scheduler& scheduler, std::chrono::milliseconds interval, TaskFunc onTick)
@@ -6,10 +6,13 @@
 
 #include "tasks.h"
 #include "thread_holder_base.h"
+#include "timerwheel.h"
 
 #include <gtl/phmap.hpp>
 #include <algorithm>
 #include <chrono>
+#include <limits>
+#include <mutex>
 
 static constexpr int32_t SCHEDULER_MINTICKS = 50;
 
@@ -29,7 +32,9 @@ namespace BlackTek
 	}
 }
 
-class SchedulerTask : public Task
+// Linked straight into the scheduler's timer wheel while it waits, then handed to the
+// dispatcher queue as a plain Task once it comes due.
+class SchedulerTask : public Task, public BlackTek::TimerWheelNode
 {
 	public:
 		void setEventId(uint32_t id) {
@@ -45,15 +50,21 @@ class SchedulerTask : public Task
 		}
 	
 	private:
-		SchedulerTask(uint32_t delay, TaskFunc&& f) : Task(std::move(f)), delay(delay) {}
+		template <typename F>
+		SchedulerTask(uint32_t delay, F&& f) : Task(std::forward<F>(f)), delay(delay) {}
 
 		uint32_t eventId = 0;
 		uint32_t delay = 0;
 
-		friend SchedulerTask* createSchedulerTask(uint32_t, TaskFunc&&);
+		template <typename F> requires std::invocable<std::decay_t<F>&>
+		friend SchedulerTask* createSchedulerTask(uint32_t, F&&);
 };
 
-SchedulerTask* createSchedulerTask(uint32_t delay, TaskFunc&& f);
+template <typename F> requires std::invocable<std::decay_t<F>&>
+SchedulerTask* createSchedulerTask(uint32_t delay, F&& f)
+{
+	return new SchedulerTask(delay, std::forward<F>(f));
+}
 
 class Scheduler : public ThreadHolder<Scheduler>
 {
@@ -68,9 +79,29 @@ class Scheduler : public ThreadHolder<Scheduler>
 
 		void threadMain() { io_context.run(); }
 	private:
+		static constexpr uint64_t NO_WAKE = std::numeric_limits<uint64_t>::max();
+
+		// milliseconds since the scheduler was created; the wheel runs on this clock
+		uint64_t currentTick() const;
+		void rearmTimer();
+		void onTimer(const boost::system::error_code& error);
+
 		std::atomic<uint32_t> lastEventId{0};
-		gtl::node_hash_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
+
+		// All pending events live in one hashed timer wheel driven by a single asio timer, so
+		// adding or stopping an event is a couple of pointer swaps under eventLock instead of a
+		// steady_timer (plus its hash node) per event and a round trip through the io_context.
+		std::mutex eventLock;
+		BlackTek::TimerWheel wheel;
+		gtl::flat_hash_map<uint32_t, SchedulerTask*> events;
+		uint64_t armedTick = NO_WAKE;
+
+		// only touched on the scheduler thread
+		std::vector<SchedulerTask*> expiredTasks;
+
+		const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
 		boost::asio::io_context io_context;
+		boost::asio::steady_timer wheelTimer{ io_context };
 		boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{ io_context.get_executor() };
 };
 
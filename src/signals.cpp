@@ -19,6 +19,7 @@
 #include "events.h"
 #include "scheduler.h"
 #include "databasetasks.h"
+#include "luagc.h"
 
 extern Scheduler g_scheduler;
 extern DatabaseTasks g_databaseTasks;
@@ -55,7 +56,7 @@ namespace
 		g_luaEnvironment.loadFile("data/global.lua");
 		BlackTek::Console::Info("Reloaded global.lua.");
 
-		lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+		BlackTek::LuaGC::RequestCycle();
 	}
 	#else
 	void sigbreakHandler()
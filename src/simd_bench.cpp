@@ -0,0 +1,231 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "simd_bench.h"
+#include "simd_kernels.h"
+#include "combat.h"
+#include "xtea.h"
+
+#include <fmt/format.h>
+#include <random>
+
+namespace BlackTek::SIMD
+{
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Keeps the optimizer from discarding kernel output we never read back.
+	volatile uint64_t g_sink = 0;
+
+	struct KernelResult
+	{
+		double nanos_per_element = 0.0;
+		bool bit_exact = true;
+	};
+
+	template<class Fn>
+	double time_best_of(uint32_t rounds, size_t elementCount, Fn&& fn)
+	{
+		auto best = Clock::duration::max();
+		for (uint32_t round = 0; round < rounds; ++round)
+		{
+			const auto start = Clock::now();
+			fn();
+			best = std::min(best, Clock::now() - start);
+		}
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(best).count()) / static_cast<double>(elementCount);
+	}
+
+	template<class T>
+	bool same_bytes(const std::vector<T>& lhs, const std::vector<T>& rhs)
+	{
+		g_sink = g_sink + (lhs.empty() ? 0 : static_cast<uint64_t>(lhs.front()));
+		return lhs.size() == rhs.size() and std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0;
+	}
+
+	void print_row(std::string_view kernel, Level level, const KernelResult& result, double scalarNanos)
+	{
+		const double speedup = result.nanos_per_element > 0.0 ? scalarNanos / result.nanos_per_element : 0.0;
+		fmt::print("    {:<28} {:<8} {:>10.3f} ns/elem {:>7.2f}x  {}\n",
+			kernel, level_name(level), result.nanos_per_element, speedup, result.bit_exact ? "exact" : "MISMATCH");
+	}
+
+	// Runs `kernel` at every supported level against `reference`, printing one row per level.
+	// `kernel` writes into the output vector it is given; `reference` holds the scalar result.
+	template<class T, class Fn>
+	bool bench_kernel(std::string_view name, size_t elementCount, uint32_t rounds, const std::vector<T>& reference, Fn&& kernel)
+	{
+		bool allExact = true;
+		double scalarNanos = 0.0;
+		std::vector<T> output(reference.size());
+
+		for (uint8_t raw = 0; raw <= static_cast<uint8_t>(g_detected); ++raw)
+		{
+			const Level level = force(static_cast<Level>(raw));
+			KernelResult result;
+			result.nanos_per_element = time_best_of(rounds, elementCount, [&] { kernel(output); });
+			result.bit_exact = same_bytes(output, reference);
+			allExact = allExact and result.bit_exact;
+
+			if (level == Level::Scalar)
+				scalarNanos = result.nanos_per_element;
+
+			print_row(name, level, result, scalarNanos);
+		}
+		return allExact;
+	}
+
+} // namespace
+
+bool RunBenchmarks(size_t elementCount, uint32_t rounds)
+{
+	const Level previous = g_level;
+	detect();
+
+	fmt::print("\n    SIMD kernel benchmark: {} elements, best of {} rounds, detected level {}\n\n",
+		elementCount, rounds, level_name(g_detected));
+
+	std::mt19937 rng(0xB1AC7E4u);
+	auto random_in = [&rng](int32_t lo, int32_t hi) { return std::uniform_int_distribution<int32_t>(lo, hi)(rng); };
+
+	bool allExact = true;
+
+	// --- gen_positions ------------------------------------------------------
+	{
+		std::vector<CoordOffset> spreads(elementCount), forwards(elementCount);
+		for (size_t index = 0; index < elementCount; ++index)
+		{
+			spreads[index]  = static_cast<CoordOffset>(random_in(-16, 16));
+			forwards[index] = static_cast<CoordOffset>(random_in(-16, 16));
+		}
+
+		constexpr MapCoord base_x = 32000, base_y = 31000;
+		std::vector<MapCoord> referenceXY(elementCount * 2);
+		detail::scalar_gen_positions(spreads.data(), forwards.data(), elementCount, base_x, base_y, referenceXY.data(), referenceXY.data() + elementCount);
+
+		allExact &= bench_kernel("gen_positions", elementCount, rounds, referenceXY, [&](std::vector<MapCoord>& out)
+		{
+			gen_positions(spreads.data(), forwards.data(), elementCount, base_x, base_y, out.data(), out.data() + elementCount);
+		});
+	}
+
+	// shared coordinate set for the bbox and spectator mask kernels
+	std::vector<MapCoord> xs(elementCount), ys(elementCount);
+	for (size_t index = 0; index < elementCount; ++index)
+	{
+		xs[index] = static_cast<MapCoord>(random_in(0, 0xFFFF));
+		ys[index] = static_cast<MapCoord>(random_in(0, 0xFFFF));
+	}
+
+	// --- compute_bbox -------------------------------------------------------
+	{
+		std::vector<MapCoord> reference = { 0xFFFFu, 0u, 0xFFFFu, 0u };
+		detail::scalar_compute_bbox(xs.data(), ys.data(), elementCount, reference[0], reference[1], reference[2], reference[3]);
+
+		allExact &= bench_kernel("compute_bbox", elementCount, rounds, reference, [&](std::vector<MapCoord>& out)
+		{
+			out = { 0xFFFFu, 0u, 0xFFFFu, 0u };
+			compute_bbox(xs.data(), ys.data(), elementCount, out[0], out[1], out[2], out[3]);
+		});
+	}
+
+	// --- compute_spectator_mask ---------------------------------------------
+	{
+		constexpr MapCoord xMin = 0x4000, xMax = 0xC000, yMin = 0x2000, yMax = 0xA000;
+		std::vector<uint8_t> reference(elementCount);
+		detail::scalar_reject_mask(xs.data(), ys.data(), elementCount, xMin, xMax, yMin, yMax, reference.data());
+
+		allExact &= bench_kernel("compute_spectator_mask", elementCount, rounds, reference, [&](std::vector<uint8_t>& out)
+		{
+			compute_spectator_mask(xs.data(), ys.data(), elementCount, xMin, xMax, yMin, yMax, out.data());
+		});
+	}
+
+	// combat inputs: include non-positive values so every formula's clamp branch is exercised
+	std::vector<CombatStat> stats(elementCount), rolls(elementCount), outputs(elementCount), resistances(elementCount);
+	for (size_t index = 0; index < elementCount; ++index)
+	{
+		stats[index]       = random_in(-20, 600);
+		rolls[index]       = random_in(std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max());
+		outputs[index]     = random_in(0, 5000);
+		resistances[index] = random_in(-50, 600);
+	}
+
+	// --- batch_resistance ---------------------------------------------------
+	{
+		constexpr std::pair<std::string_view, ResistanceFactors> presets[] = {
+			{ "batch_resistance/Identity",     Combat::ScaledResistance },
+			{ "batch_resistance/LinearRandom", Combat::ClassicDefense },
+			{ "batch_resistance/Parity",       Combat::ClassicArmor },
+			{ "batch_resistance/Percent",      Combat::AbsorptionResistance },
+		};
+
+		for (const auto& [name, factors] : presets)
+		{
+			std::vector<CombatStat> reference(elementCount);
+			detail::scalar_batch_resistance(stats.data(), elementCount, factors, rolls.data(), reference.data());
+
+			allExact &= bench_kernel(name, elementCount, rounds, reference, [&](std::vector<CombatStat>& out)
+			{
+				batch_resistance(stats.data(), elementCount, factors, rolls.data(), out.data());
+			});
+		}
+	}
+
+	// --- batch_resolve ------------------------------------------------------
+	{
+		constexpr std::pair<std::string_view, ResolutionFactors> presets[] = {
+			{ "batch_resolve/Subtractive",     Combat::ClassicResolution },
+			{ "batch_resolve/RatioMitigation", Combat::ScaledResolution },
+			{ "batch_resolve/ScaledDivision",  Combat::BalancedResolution },
+			{ "batch_resolve/Layered",         Combat::AbsorptionResolution },
+		};
+
+		for (const auto& [name, factors] : presets)
+		{
+			std::vector<CombatStat> reference(elementCount);
+			detail::scalar_batch_resolve(outputs.data(), resistances.data(), elementCount, factors, reference.data());
+
+			allExact &= bench_kernel(name, elementCount, rounds, reference, [&](std::vector<CombatStat>& out)
+			{
+				batch_resolve(outputs.data(), resistances.data(), elementCount, factors, out.data());
+			});
+		}
+	}
+
+	// --- xtea ---------------------------------------------------------------
+	{
+		const auto roundKeys = xtea::expand_key({ 0x01234567u, 0x89ABCDEFu, 0xFEDCBA98u, 0x76543210u });
+		std::vector<uint8_t> plain(elementCount * 8);
+		for (auto& byte : plain) byte = static_cast<uint8_t>(random_in(0, 0xFF));
+
+		// the scalar path is the reference: force it, encrypt, then restore for the per-level runs
+		force(Level::Scalar);
+		std::vector<uint8_t> cipher = plain;
+		xtea::encrypt(cipher.data(), cipher.size(), roundKeys);
+
+		allExact &= bench_kernel("xtea/encrypt", elementCount, rounds, cipher, [&](std::vector<uint8_t>& out)
+		{
+			std::memcpy(out.data(), plain.data(), plain.size());
+			xtea::encrypt(out.data(), out.size(), roundKeys);
+		});
+
+		allExact &= bench_kernel("xtea/decrypt", elementCount, rounds, plain, [&](std::vector<uint8_t>& out)
+		{
+			std::memcpy(out.data(), cipher.data(), cipher.size());
+			xtea::decrypt(out.data(), out.size(), roundKeys);
+		});
+	}
+
+	g_level = previous;
+
+	fmt::print("\n    {}\n\n", allExact ? "All levels are bit-exact against the scalar reference."
+	                                      : "One or more levels DIFFER from the scalar reference!");
+	return allExact;
+}
+
+} // namespace BlackTek::SIMD
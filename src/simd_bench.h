@@ -0,0 +1,14 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace BlackTek::SIMD
+{
+	// Runs every kernel from simd_kernels.h (plus XTEA) once per dispatch level the CPU supports,
+	// compares each result byte-for-byte against the scalar reference and prints timings/speedups.
+	// Invoked by the --simd-bench command line switch; returns false if any level was not bit-exact.
+	bool RunBenchmarks(size_t elementCount = 4096, uint32_t rounds = 200);
+}
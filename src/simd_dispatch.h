@@ -3,10 +3,15 @@
 
 #pragma once
 #include <cstdint>
+#include <optional>
+#include <string_view>
 
 #if defined(_MSC_VER) || defined(__INTEL_COMPILER)
 #	include <intrin.h>
 #	include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#	include <cpuid.h>
+#	define BT_SIMD_GNU_CPUID 1
 #endif
 
 namespace BlackTek::SIMD
@@ -18,47 +23,114 @@ namespace BlackTek::SIMD
 	using CombatStat  = int32_t;    // signed combat stat, damage output, or resistance value
 	using RandomRoll  = uint32_t;   // unsigned random number consumed by resistance formulas
 
-	inline Level g_level = Level::Scalar;
+	// g_level is what the kernels dispatch on; g_detected is the highest level the CPU and OS
+	// actually support, and is the ceiling for any override coming from config or the command line.
+	inline Level g_level    = Level::Scalar;
+	inline Level g_detected = Level::Scalar;
 
-	inline void detect() noexcept
+namespace detail
+{
+	// Returns { eax, ebx, ecx, edx } for the given leaf / subleaf, all zero when the leaf is unsupported.
+	inline void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t (&regs)[4]) noexcept
 	{
+		regs[0] = regs[1] = regs[2] = regs[3] = 0;
 #if defined(_MSC_VER) || defined(__INTEL_COMPILER)
 		int info[4];
+		__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int index = 0; index < 4; ++index) regs[index] = static_cast<uint32_t>(info[index]);
+#elif defined(BT_SIMD_GNU_CPUID)
+		if (__get_cpuid_max(leaf & 0x80000000u, nullptr) < leaf)
+			return;
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+		(void)leaf;
+		(void)subleaf;
+#endif
+	}
+
+	// XCR0 tells us whether the OS saves/restores the YMM state on context switch.
+	// Only valid to call once CPUID.1:ECX.OSXSAVE has been confirmed.
+	inline uint64_t xgetbv0() noexcept
+	{
+#if defined(_MSC_VER) || defined(__INTEL_COMPILER)
+		return _xgetbv(0);
+#elif defined(BT_SIMD_GNU_CPUID)
+		// inline asm rather than _xgetbv() so we don't need -mxsave on the whole translation unit
+		uint32_t eax = 0, edx = 0;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<uint64_t>(edx) << 32) | eax;
+#else
+		return 0;
+#endif
+	}
+} // namespace detail
+
+	inline void detect() noexcept
+	{
+		uint32_t regs[4];
 
-		__cpuid(info, 1);
-		const bool has_sse2    = (info[3] >> 26) & 1;
-		const bool has_sse4_1  = (info[2] >> 19) & 1;
-		const bool has_osxsave = (info[2] >> 27) & 1;
+		detail::cpuid(1, 0, regs);
+		const bool has_sse2    = (regs[3] >> 26) & 1;
+		const bool has_sse4_1  = (regs[2] >> 19) & 1;
+		const bool has_osxsave = (regs[2] >> 27) & 1;
 
 		if (not has_sse2)
 		{
-			g_level = Level::Scalar;
+			g_detected = g_level = Level::Scalar;
 			return;
 		}
 
 		if (not has_sse4_1)
 		{
-			g_level = Level::SSE2;
+			g_detected = g_level = Level::SSE2;
 			return;
 		}
 
-		__cpuidex(info, 7, 0);
-		const bool has_avx2 = (info[1] >> 5) & 1;
+		detail::cpuid(7, 0, regs);
+		const bool has_avx2 = (regs[1] >> 5) & 1;
 
 		if (has_avx2 and has_osxsave)
 		{
-			const uint64_t xcr0 = _xgetbv(0);
+			const uint64_t xcr0 = detail::xgetbv0();
 			if ((xcr0 & 0x6u) == 0x6u)
 			{
-				g_level = Level::AVX2;
+				g_detected = g_level = Level::AVX2;
 				return;
 			}
 		}
 
-		g_level = Level::SSE4_1;
-#else
-		g_level = Level::Scalar;
-#endif
+		g_detected = g_level = Level::SSE4_1;
+	}
+
+	[[nodiscard]] constexpr std::string_view level_name(Level level) noexcept
+	{
+		switch (level)
+		{
+			case Level::SSE2:   return "SSE2";
+			case Level::SSE4_1: return "SSE4.1";
+			case Level::AVX2:   return "AVX2";
+			default:            return "Scalar";
+		}
+	}
+
+	// Accepts the spellings used by the [performance] simd_level config key.
+	// "auto" (or an empty string) yields nullopt, meaning "keep whatever detect() found".
+	[[nodiscard]] constexpr std::optional<Level> parse_level(std::string_view text) noexcept
+	{
+		if (text == "scalar" or text == "none")  return Level::Scalar;
+		if (text == "sse2")                       return Level::SSE2;
+		if (text == "sse4.1" or text == "sse41")  return Level::SSE4_1;
+		if (text == "avx2")                       return Level::AVX2;
+		return std::nullopt;
+	}
+
+	// Forces the dispatch level, clamped to what detect() found so a misconfigured
+	// override can never route us into an instruction the CPU would fault on.
+	// Returns the level actually applied.
+	inline Level force(Level requested) noexcept
+	{
+		g_level = static_cast<uint8_t>(requested) > static_cast<uint8_t>(g_detected) ? g_detected : requested;
+		return g_level;
 	}
 
 } // namespace BlackTek::SIMD
@@ -186,11 +186,12 @@ inline void gen_positions(const CoordOffset* spreads, const CoordOffset* forward
 				packedMaxY = _mm_max_epi16(packedMaxY, yChunkSigned);
 			}
 
-			// flip back from signed domain to unsigned
-			minX = static_cast<MapCoord>(detail::sse2_hmin_epi16(packedMinX) ^ static_cast<CoordOffset>(0x8000));
-			maxX = static_cast<MapCoord>(detail::sse2_hmax_epi16(packedMaxX) ^ static_cast<CoordOffset>(0x8000));
-			minY = static_cast<MapCoord>(detail::sse2_hmin_epi16(packedMinY) ^ static_cast<CoordOffset>(0x8000));
-			maxY = static_cast<MapCoord>(detail::sse2_hmax_epi16(packedMaxY) ^ static_cast<CoordOffset>(0x8000));
+			// flip back from signed domain to unsigned, merging with the incoming bounds so this
+			// can also serve as the tail of a wider kernel without discarding what it already found
+			minX = std::min(minX, static_cast<MapCoord>(detail::sse2_hmin_epi16(packedMinX) ^ static_cast<CoordOffset>(0x8000)));
+			maxX = std::max(maxX, static_cast<MapCoord>(detail::sse2_hmax_epi16(packedMaxX) ^ static_cast<CoordOffset>(0x8000)));
+			minY = std::min(minY, static_cast<MapCoord>(detail::sse2_hmin_epi16(packedMinY) ^ static_cast<CoordOffset>(0x8000)));
+			maxY = std::max(maxY, static_cast<MapCoord>(detail::sse2_hmax_epi16(packedMaxY) ^ static_cast<CoordOffset>(0x8000)));
 
 			scalar_compute_bbox(xs + index, ys + index, count - index, minX, maxX, minY, maxY);
 		}
@@ -213,10 +214,11 @@ inline void gen_positions(const CoordOffset* spreads, const CoordOffset* forward
 				packedMaxY = _mm_max_epu16(packedMaxY, yChunk);
 			}
 
-			minX = detail::sse41_hmin_epu16(packedMinX);
-			maxX = detail::sse41_hmax_epu16(packedMaxX);
-			minY = detail::sse41_hmin_epu16(packedMinY);
-			maxY = detail::sse41_hmax_epu16(packedMaxY);
+			// merge with the incoming bounds: avx2_compute_bbox hands its running result to us for the tail
+			minX = std::min(minX, detail::sse41_hmin_epu16(packedMinX));
+			maxX = std::max(maxX, detail::sse41_hmax_epu16(packedMaxX));
+			minY = std::min(minY, detail::sse41_hmin_epu16(packedMinY));
+			maxY = std::max(maxY, detail::sse41_hmax_epu16(packedMaxY));
 
 			scalar_compute_bbox(xs + index, ys + index, count - index, minX, maxX, minY, maxY);
 		}
@@ -254,10 +256,10 @@ inline void gen_positions(const CoordOffset* spreads, const CoordOffset* forward
 			}
 
 			// we reduce 256-bit to 128-bit then we use the SSE4.1 horizontal reduce
-			minX = avx2_hmin_epu16(packedMinX);
-			maxX = avx2_hmax_epu16(packedMaxX);
-			minY = avx2_hmin_epu16(packedMinY);
-			maxY = avx2_hmax_epu16(packedMaxY);
+			minX = std::min(minX, avx2_hmin_epu16(packedMinX));
+			maxX = std::max(maxX, avx2_hmax_epu16(packedMaxX));
+			minY = std::min(minY, avx2_hmin_epu16(packedMinY));
+			maxY = std::max(maxY, avx2_hmax_epu16(packedMaxY));
 
 			sse41_compute_bbox(xs + index, ys + index, count - index, minX, maxX, minY, maxY);
 		}
@@ -514,6 +516,8 @@ namespace detail
 					Vec128Int    maskedRng        = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const Vec128Int*>(rng_vals + index)), rngMask31Bit);
 					Vec128Float  floatOffset      = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(maskedRng), vecRngInverse), floatRange);
 					Vec128Int    outputValues     = _mm_add_epi32(intLowerBound, _mm_cvttps_epi32(floatOffset));
+					// non-positive stats resist nothing, matching the scalar early-out
+					outputValues = _mm_and_si128(outputValues, _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const Vec128Int*>(stats + index)), _mm_setzero_si128()));
 					_mm_storeu_si128(reinterpret_cast<Vec128Int*>(out + index), outputValues);
 				}
 
@@ -546,6 +550,7 @@ namespace detail
 					Vec128Int   maskedRng          = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const Vec128Int*>(rng_vals + index)), rngMask31Bit);
 					Vec128Int   randomResult       = _mm_add_epi32(intLowerBound, _mm_cvttps_epi32(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(maskedRng), vecRngInverse), floatRange)));
 					Vec128Int   outputValues       = _mm_or_si128(_mm_and_si128(aboveThresholdMask, randomResult), _mm_andnot_si128(aboveThresholdMask, vecFlatAmount));
+								outputValues       = _mm_and_si128(outputValues, _mm_cmpgt_epi32(packedStats, _mm_setzero_si128()));
 					_mm_storeu_si128(reinterpret_cast<Vec128Int*>(out + index), outputValues);
 				}
 
@@ -611,6 +616,8 @@ namespace detail
 					Vec256Int    maskedRng        = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const Vec256Int*>(rng_vals + index)), rngMask31Bit);
 					Vec256Float  floatOffset     = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(maskedRng), vecRngInverse), floatRange);
 					Vec256Int    outputValues    = _mm256_add_epi32(intLowerBound, _mm256_cvttps_epi32(floatOffset));
+					// non-positive stats resist nothing, matching the scalar early-out
+					outputValues                 = _mm256_and_si256(outputValues, _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const Vec256Int*>(stats + index)), _mm256_setzero_si256()));
 					_mm256_storeu_si256(reinterpret_cast<Vec256Int*>(out + index), outputValues);
 				}
 
@@ -644,6 +651,7 @@ namespace detail
 					Vec256Int   maskedRng          = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const Vec256Int*>(rng_vals + index)), rngMask31Bit);
 					Vec256Int   randomResult       = _mm256_add_epi32(intLowerBound, _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(maskedRng), vecRngInverse), floatRange)));
 					Vec256Int   outputValues       = _mm256_blendv_epi8(vecFlatAmount, randomResult, aboveThresholdMask);
+					outputValues                   = _mm256_and_si256(outputValues, _mm256_cmpgt_epi32(packedStats, _mm256_setzero_si256()));
 					_mm256_storeu_si256(reinterpret_cast<Vec256Int*>(out + index), outputValues);
 				}
 
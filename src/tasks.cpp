@@ -8,74 +8,116 @@
 
 extern Game g_game;
 
-Task* createTask(TaskFunc&& f)
+namespace {
+
+// Large enough for Task and SchedulerTask (with its timer wheel hook) with a full inline callable buffer.
+constexpr std::size_t TASK_BLOCK_SIZE = 160;
+constexpr std::size_t TASK_BLOCK_ALIGN = alignof(std::max_align_t);
+constexpr std::size_t TASK_FREE_LIST_CAPACITY = 4096;
+constexpr std::size_t TASK_MAGAZINE_CAPACITY = 64;
+
+using TaskMagazine = BlackTek::Memory::ThreadLocalMagazine<TASK_BLOCK_SIZE, TASK_BLOCK_ALIGN, TASK_FREE_LIST_CAPACITY, TASK_MAGAZINE_CAPACITY>;
+
+TaskMagazine& localTaskMagazine() noexcept
 {
-	return new Task(std::move(f));
+	thread_local TaskMagazine magazine;
+	return magazine;
 }
 
-Task* createTask(uint32_t expiration, TaskFunc&& f)
+} // namespace
+
+void* Task::operator new(std::size_t size)
 {
-	return new Task(expiration, std::move(f));
+	if (size > TASK_BLOCK_SIZE) [[unlikely]] {
+		return ::operator new(size);
+	}
+
+	if (void* block = localTaskMagazine().allocate()) [[likely]] {
+		return block;
+	}
+	return BlackTek::Memory::aligned_new<TASK_BLOCK_ALIGN>(TASK_BLOCK_SIZE);
 }
 
-void Dispatcher::threadMain()
+void Task::operator delete(void* p, std::size_t size) noexcept
 {
-	std::vector<Task*> tmpTaskList;
-	// NOTE: second argument defer_lock is to prevent from immediate locking
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
+	if (size > TASK_BLOCK_SIZE) [[unlikely]] {
+		::operator delete(p);
+		return;
+	}
 
-	while (getState() != THREAD_STATE_TERMINATED) {
-		// check if there are tasks waiting
-		taskLockUnique.lock();
-		if (taskList.empty()) {
-			//if the list is empty wait for signal
-			taskSignal.wait(taskLockUnique);
-		}
-		tmpTaskList.swap(taskList);
-		taskLockUnique.unlock();
+	// tasks are mostly created on producer threads and destroyed on the dispatcher, so the
+	// dispatcher's magazine overflows into the central pool where producers pick the blocks up again
+	localTaskMagazine().deallocate(p);
+}
 
-		for (Task* task : tmpTaskList) {
+void Dispatcher::threadMain()
+{
+	while (getState() != THREAD_STATE_TERMINATED) {
+		if (auto node = taskQueue.try_pop()) {
+			Task* task = static_cast<Task*>(node);
 			if (!task->hasExpired()) {
 				++dispatcherCycle;
 				// execute it
 				(*task)();
 			}
 			delete task;
+			continue;
+		}
+
+		if (!taskQueue.empty()) {
+			// a producer swapped the queue head but hasn't linked its node yet
+			std::this_thread::yield();
+			continue;
+		}
+
+		if (idleHandler && idleHandler()) {
+			continue;
+		}
+
+		// park until a producer sees the flag; re-check after publishing it so a push that
+		// raced with the store above can't be missed
+		idle.store(true, std::memory_order_seq_cst);
+		if (taskQueue.empty()) {
+			idle.wait(true, std::memory_order_seq_cst);
+		}
+		idle.store(false, std::memory_order_relaxed);
+	}
+
+	// drop whatever was queued behind the shutdown task
+	while (!taskQueue.empty()) {
+		if (auto node = taskQueue.try_pop()) {
+			delete static_cast<Task*>(node);
+		} else {
+			std::this_thread::yield();
 		}
-		tmpTaskList.clear();
 	}
 }
 
-void Dispatcher::addTask(Task* task)
+void Dispatcher::wakeConsumer()
 {
-	bool do_signal = false;
-
-	taskLock.lock();
+	if (idle.load(std::memory_order_seq_cst)) {
+		idle.store(false, std::memory_order_seq_cst);
+		idle.notify_one();
+	}
+}
 
-	if (getState() == THREAD_STATE_RUNNING) {
-		do_signal = taskList.empty();
-		taskList.push_back(task);
-	} else {
+void Dispatcher::addTask(Task* task)
+{
+	if (getState() != THREAD_STATE_RUNNING) {
 		delete task;
+		return;
 	}
 
-	taskLock.unlock();
-
-	// send a signal if the list was empty
-	if (do_signal) {
-		taskSignal.notify_one();
-	}
+	taskQueue.push(task);
+	wakeConsumer();
 }
 
 void Dispatcher::shutdown()
 {
 	Task* task = createTask([this]() {
 		setState(THREAD_STATE_TERMINATED);
-		taskSignal.notify_one();
 	});
 
-	std::lock_guard<std::mutex> lockClass(taskLock);
-	taskList.push_back(task);
-
-	taskSignal.notify_one();
+	taskQueue.push(task);
+	wakeConsumer();
 }
@@ -5,20 +5,82 @@
 #define FS_TASKS_H
 
 #include <condition_variable>
+#include <concepts>
+#include <type_traits>
 #include "thread_holder_base.h"
+#include "lockfree.h"
 #include "enums.h"
 
 using TaskFunc = std::function<void(void)>;
 const int DISPATCHER_TASK_EXPIRATION = 2000;
 const auto TASK_TIME_ZERO = std::chrono::steady_clock::time_point(std::chrono::milliseconds(0));
 
-class Task
+// Type-erased void() callable with inline storage. Callables that fit the buffer (most
+// dispatcher lambdas capture a few ids, a shared_ptr or a std::function) are constructed
+// in place, so a task costs one pooled node instead of a node plus a std::function heap
+// block. Larger callables fall back to a single heap allocation. Never copied or moved:
+// it lives inside a Task, which is itself only ever handled through a pointer.
+class TaskCallable
+{
+	public:
+		static constexpr std::size_t INLINE_SIZE = 64;
+
+		template <typename F>
+		explicit TaskCallable(F&& f)
+		{
+			using Fn = std::decay_t<F>;
+			if constexpr (sizeof(Fn) <= INLINE_SIZE and alignof(Fn) <= alignof(std::max_align_t)) {
+				::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+				ops = &inlineOps<Fn>;
+			} else {
+				::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(f)));
+				ops = &heapOps<Fn>;
+			}
+		}
+
+		~TaskCallable() { ops->destroy(storage); }
+
+		TaskCallable(const TaskCallable&) = delete;
+		TaskCallable& operator=(const TaskCallable&) = delete;
+
+		void operator()() const { ops->invoke(storage); }
+
+	private:
+		struct Ops
+		{
+			void (*invoke)(void*);
+			void (*destroy)(void*) noexcept;
+		};
+
+		template <typename Fn>
+		static constexpr Ops inlineOps {
+			[](void* p) { (*static_cast<Fn*>(p))(); },
+			[](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); }
+		};
+
+		template <typename Fn>
+		static constexpr Ops heapOps {
+			[](void* p) { (**static_cast<Fn**>(p))(); },
+			[](void* p) noexcept { delete *static_cast<Fn**>(p); }
+		};
+
+		const Ops* ops;
+		alignas(std::max_align_t) mutable unsigned char storage[INLINE_SIZE];
+};
+
+// Tasks are linked straight into the dispatcher queue through MPSCNode and their memory comes
+// from a per-thread magazine backed by a shared lock-free pool, so enqueueing from the network
+// strands or the scheduler touches neither a mutex nor the global allocator.
+class Task : public BlackTek::Memory::MPSCNode
 {
 	public:
 		// DO NOT allocate this class on the stack
-		explicit Task(TaskFunc&& f) : func(std::move(f)) {}
-		Task(uint32_t ms, TaskFunc&& f) :
-			expiration(std::chrono::steady_clock::now() + std::chrono::milliseconds(ms)), func(std::move(f)) {}
+		template <typename F> requires std::invocable<std::decay_t<F>&>
+		explicit Task(F&& f) : func(std::forward<F>(f)) {}
+
+		template <typename F> requires std::invocable<std::decay_t<F>&>
+		Task(uint32_t ms, F&& f) :
+			expiration(std::chrono::steady_clock::now() + std::chrono::milliseconds(ms)), func(std::forward<F>(f)) {}
 
 		virtual ~Task() = default;
 		void operator()() const
@@ -37,6 +99,9 @@ class Task
 			return expiration < std::chrono::steady_clock::now();
 		}
 
+		static void* operator new(std::size_t size);
+		static void operator delete(void* p, std::size_t size) noexcept;
+
 	protected:
 		std::chrono::steady_clock::time_point expiration = TASK_TIME_ZERO;
 
@@ -44,19 +109,30 @@ class Task
 		// Expiration has another meaning for scheduler tasks,
 		// then it is the time the task should be added to the
 		// dispatcher
-		TaskFunc func;
+		TaskCallable func;
 };
 
-Task* createTask(TaskFunc&& f);
-Task* createTask(uint32_t expiration, TaskFunc&& f);
+template <typename F> requires std::invocable<std::decay_t<F>&>
+Task* createTask(F&& f)
+{
+	return new Task(std::forward<F>(f));
+}
+
+template <typename F> requires std::invocable<std::decay_t<F>&>
+Task* createTask(uint32_t expiration, F&& f)
+{
+	return new Task(expiration, std::forward<F>(f));
+}
 
 class Dispatcher : public ThreadHolder<Dispatcher> {
 	public:
 		void addTask(Task* task);
 
-		void addTask(TaskFunc&& f) { addTask(new Task(std::move(f))); }
+		template <typename F> requires std::invocable<std::decay_t<F>&>
+		void addTask(F&& f) { addTask(new Task(std::forward<F>(f))); }
 
-		void addTask(uint32_t expiration, TaskFunc&& f) { addTask(new Task(expiration, std::move(f))); }
+		template <typename F> requires std::invocable<std::decay_t<F>&>
+		void addTask(uint32_t expiration, F&& f) { addTask(new Task(expiration, std::forward<F>(f))); }
 
 		void shutdown();
 
@@ -64,14 +140,26 @@ class Dispatcher : public ThreadHolder<Dispatcher> {
 			return dispatcherCycle;
 		}
 
+		// Called on the dispatcher thread every time the queue ran dry, before it parks. Returning
+		// true asks for another call as soon as the queue is empty again, so the handler has to
+		// keep its own time budget. Only set it from the dispatcher thread.
+		void setIdleHandler(std::function<bool()> handler) {
+			idleHandler = std::move(handler);
+		}
+
 		void threadMain();
 
 	private:
-		std::mutex taskLock;
-		std::condition_variable taskSignal;
+		void wakeConsumer();
+
+		BlackTek::Memory::MPSCQueue taskQueue;
+
+		// Set by the dispatcher thread right before it parks on an empty queue. Producers only
+		// pay for a notify (futex wake) when they observe it, i.e. once per idle period.
+		alignas(BlackTek::Memory::CacheSlot) std::atomic<bool> idle{false};
 
-		std::vector<Task*> taskList;
 		uint64_t dispatcherCycle = 0;
+		std::function<bool()> idleHandler;
 };
 
 extern Dispatcher g_dispatcher;
@@ -0,0 +1,145 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "thinkwheel.h"
+
+#include "creature.h"
+#include "tools.h"
+
+namespace BlackTek
+{
+    void ThinkWheel::Schedule(const CreaturePtr& creature)
+    {
+        if (creature->thinkIndex != InvalidIndex)
+        {
+            // still waiting to be swept, whatever it held back while unscheduled was handled elsewhere
+            if (not (flags[creature->thinkIndex] & Scheduled))
+                Reset(creature->thinkIndex, *creature);
+            return;
+        }
+
+        creature->thinkIndex = static_cast<uint32_t>(creatures.size());
+        creatures.push_back(creature);
+        slots.push_back(static_cast<uint8_t>(uniform_random(0, Slots - 1)));
+        flags.push_back(0);
+        next_think.push_back(0);
+        last_think.push_back(0);
+        last_conditions.push_back(0);
+        condition_deadline.push_back(0);
+        Reset(creature->thinkIndex, *creature);
+    }
+
+    void ThinkWheel::Unschedule(Creature& creature)
+    {
+        if (creature.thinkIndex != InvalidIndex)
+            flags[creature.thinkIndex] &= ~Scheduled;
+    }
+
+    void ThinkWheel::HoldThink(Creature& creature, const uint32_t turns)
+    {
+        if (creature.thinkIndex != InvalidIndex)
+            next_think[creature.thinkIndex] = last_think[creature.thinkIndex] + 1 + turns;
+    }
+
+    void ThinkWheel::SetAttacking(Creature& creature, const bool attacking)
+    {
+        if (creature.thinkIndex == InvalidIndex)
+            return;
+
+        if (attacking)
+            flags[creature.thinkIndex] |= Attacking;
+        else
+            flags[creature.thinkIndex] &= ~Attacking;
+    }
+
+    void ThinkWheel::SetConditionDeadline(Creature& creature, const int64_t deadline)
+    {
+        if (creature.thinkIndex != InvalidIndex)
+            condition_deadline[creature.thinkIndex] = deadline;
+    }
+
+    uint32_t ThinkWheel::SettleConditions(Creature& creature)
+    {
+        const uint32_t index = creature.thinkIndex;
+        if (index == InvalidIndex or not (flags[index] & Scheduled))
+            return 0;
+
+        return TakeConditionTurns(index, LastVisit(index));
+    }
+
+    uint32_t ThinkWheel::ClaimConditions(Creature& creature)
+    {
+        const uint32_t index = creature.thinkIndex;
+        if (index == InvalidIndex or not (flags[index] & Scheduled))
+            return 0;
+
+        return TakeConditionTurns(index, turn);
+    }
+
+    uint32_t ThinkWheel::LastVisit(const uint32_t index) const
+    {
+        if (index == dispatching)
+            return turn - 1;
+
+        return current_slot == 0 or slots[index] < current_slot ? turn : turn - 1;
+    }
+
+    uint32_t ThinkWheel::TakeConditionTurns(const uint32_t index, const uint32_t until)
+    {
+        // never moves back, a visit hands out its turn before the dispatch settling in it runs
+        if (until <= last_conditions[index])
+            return 0;
+
+        const uint32_t turns = until - last_conditions[index];
+        last_conditions[index] = until;
+        return turns;
+    }
+
+    void ThinkWheel::Reset(const uint32_t index, Creature& creature)
+    {
+        flags[index] = Scheduled;
+        if (creature.getAttackedCreature())
+            flags[index] |= Attacking;
+
+        next_think[index] = 0;
+        last_think[index] = LastVisit(index);
+        last_conditions[index] = last_think[index];
+        condition_deadline[index] = creature.getConditionDeadline();
+    }
+
+    void ThinkWheel::Sweep()
+    {
+        // highest index first, so the entry swapped in from the back is never one still waiting to be removed
+        for (auto it = visited.rbegin(); it != visited.rend(); ++it)
+        {
+            const uint32_t index = *it;
+            if (flags[index] & Scheduled)
+                continue;
+
+            creatures[index]->thinkIndex = InvalidIndex;
+
+            const uint32_t last = static_cast<uint32_t>(creatures.size() - 1);
+            if (index != last)
+            {
+                creatures[index] = std::move(creatures[last]);
+                slots[index] = slots[last];
+                flags[index] = flags[last];
+                next_think[index] = next_think[last];
+                last_think[index] = last_think[last];
+                last_conditions[index] = last_conditions[last];
+                condition_deadline[index] = condition_deadline[last];
+                creatures[index]->thinkIndex = index;
+            }
+
+            creatures.pop_back();
+            slots.pop_back();
+            flags.pop_back();
+            next_think.pop_back();
+            last_think.pop_back();
+            last_conditions.pop_back();
+            condition_deadline.pop_back();
+        }
+    }
+}
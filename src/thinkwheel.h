@@ -0,0 +1,135 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include "declarations.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace BlackTek
+{
+    // Creatures getting onThink/onAttacking/executeConditions, spread over Slots buckets so each of them comes up
+    // once every Slots cycles (a turn). The scheduling and hot think state is kept in parallel arrays indexed by
+    // Creature::thinkIndex: the turn onThink is next due, whether the creature has a target, and the time its
+    // conditions next have something to do. A cycle works out what each entry of its slot has due from those
+    // arrays alone, and only creatures with due work get dereferenced. Unscheduling is lazy, the entry stays until
+    // its slot comes up again and is swapped out with the last one then.
+    class ThinkWheel
+    {
+    public:
+        static constexpr uint8_t Slots = 20;
+        static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+        static constexpr int64_t NoDeadline = std::numeric_limits<int64_t>::max();
+
+        enum Due : uint8_t
+        {
+            Think = 1 << 0,
+            Attack = 1 << 1,
+            Conditions = 1 << 2,
+        };
+
+        void Schedule(const CreaturePtr& creature);
+        void Unschedule(Creature& creature);
+
+        // onThink skips the next turns of the creature, the turns held back are handed to the one it gets then
+        void HoldThink(Creature& creature, uint32_t turns);
+        void SetAttacking(Creature& creature, bool attacking);
+        // executeConditions waits until then, NoDeadline without conditions
+        void SetConditionDeadline(Creature& creature, int64_t deadline);
+        // the turns of condition time held back before the entry's current visit, counted as handed out
+        [[nodiscard]] uint32_t SettleConditions(Creature& creature);
+        // the same while dispatching the entry, up to and including the turn being dispatched
+        [[nodiscard]] uint32_t ClaimConditions(Creature& creature);
+
+        // dispatch(Creature&, due, thinkTurns, conditionTurns) for every scheduled entry of the next slot with
+        // something due, the turns being how many of the entry's turns the due parts cover
+        template <typename Dispatch>
+        void Cycle(const int64_t now, Dispatch&& dispatch)
+        {
+            if (current_slot == 0)
+                ++turn;
+
+            const uint8_t slot = current_slot;
+            current_slot = (current_slot + 1) % Slots;
+
+            visited.clear();
+            const uint32_t count = static_cast<uint32_t>(slots.size());
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                if (slots[index] == slot)
+                    visited.push_back(index);
+            }
+
+            // entries are only ever removed below, so the wheel keeps everything visited alive while thinking
+            for (const uint32_t index : visited)
+            {
+                if (not (flags[index] & Scheduled))
+                    continue;
+
+                uint8_t due = 0;
+                uint32_t thinkTurns = 0;
+                uint32_t conditionTurns = 0;
+                if (next_think[index] <= turn)
+                {
+                    due |= Think;
+                    thinkTurns = std::max<uint32_t>(turn - last_think[index], 1);
+                    last_think[index] = turn;
+                    next_think[index] = turn + 1;
+                }
+                if (flags[index] & Attacking)
+                    due |= Attack;
+                if (condition_deadline[index] <= now)
+                {
+                    due |= Conditions;
+                    conditionTurns = std::max<uint32_t>(turn - last_conditions[index], 1);
+                    last_conditions[index] = turn;
+                }
+
+                if (not due)
+                    continue;
+
+                dispatching = index;
+                dispatch(*creatures[index], due, thinkTurns, conditionTurns);
+                dispatching = InvalidIndex;
+            }
+
+            Sweep();
+        }
+
+        [[nodiscard]] size_t Size() const { return creatures.size(); }
+
+    private:
+        enum Flag : uint8_t
+        {
+            Scheduled = 1 << 0,
+            Attacking = 1 << 1,
+        };
+
+        // the last turn the entry's slot came up in, this one if it already did and isn't still being dispatched
+        [[nodiscard]] uint32_t LastVisit(uint32_t index) const;
+        [[nodiscard]] uint32_t TakeConditionTurns(uint32_t index, uint32_t until);
+        // fresh think state for an entry (re)joining the wheel
+        void Reset(uint32_t index, Creature& creature);
+        // drops the entries of the last cycle's slot that are no longer scheduled
+        void Sweep();
+
+        std::vector<CreaturePtr> creatures;
+        std::vector<uint8_t> slots;
+        std::vector<uint8_t> flags;
+        std::vector<uint32_t> next_think;
+        std::vector<uint32_t> last_think;
+        std::vector<uint32_t> last_conditions;
+        std::vector<int64_t> condition_deadline;
+
+        std::vector<uint32_t> visited;
+        uint32_t dispatching = InvalidIndex;
+        uint8_t current_slot = 0;
+        // starts at 1 so a last turn of turn - 1 never wraps
+        uint32_t turn = 1;
+    };
+}
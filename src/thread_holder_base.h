@@ -27,6 +27,10 @@ class ThreadHolder
 				thread.join();
 			}
 		}
+
+		bool isCurrentThread() const {
+			return std::this_thread::get_id() == thread.get_id();
+		}
 	protected:
 		void setState(ThreadState newState) {
 			threadState.store(newState, std::memory_order_relaxed);
@@ -340,6 +340,8 @@ GameModel Tile::getTopVisibleGameModel(const CreaturePtr& creature)
 
 void Tile::onAddTileItem(const ItemPtr& item, std::span<const CreaturePtr> spectators)
 {
+	invalidateDescription();
+
 	if (item->hasProperty(CONST_PROP_MOVEABLE) || item->getContainer()) {
 		if (const auto it = g_game.browseFields.find(getTile()); it != g_game.browseFields.end()) {
 			ItemPtr addedItem = item;
@@ -369,6 +371,8 @@ void Tile::onAddTileItem(const ItemPtr& item, std::span<const CreaturePtr> spect
 
 void Tile::onUpdateTileItem(const ItemPtr& oldItem, const ItemType& oldType, const ItemPtr& newItem, const ItemType& newType, std::span<const CreaturePtr> spectators)
 {
+	invalidateDescription();
+
 	if (newItem->hasProperty(CONST_PROP_MOVEABLE) || newItem->getContainer()) {
 		if (const auto it = g_game.browseFields.find(getTile()); it != g_game.browseFields.end()) {
 			if (int32_t index = it->second->getItemIndex(oldItem); index != -1)
@@ -411,6 +415,8 @@ void Tile::onUpdateTileItem(const ItemPtr& oldItem, const ItemType& oldType, con
 
 void Tile::onRemoveTileItem(std::span<const CreaturePtr> spectators, const std::vector<int32_t>& oldStackPosVector, const ItemPtr& item)
 {
+	invalidateDescription();
+
 	if (item->hasProperty(CONST_PROP_MOVEABLE) || item->getContainer()) {
 		if (const auto it = g_game.browseFields.find(getTile()); it != g_game.browseFields.end()) {
 			it->second->removeItem(item, item->getItemCount());
@@ -456,6 +462,8 @@ void Tile::onRemoveTileItem(std::span<const CreaturePtr> spectators, const std::
 
 void Tile::onUpdateTile(std::span<const CreaturePtr> spectators)
 {
+	invalidateDescription();
+
 	const Position& cylinderMapPos = getPosition();
 
 	for (const auto& spectatorPlayer : spectators
@@ -1068,6 +1076,7 @@ void Tile::removeCreature(CreaturePtr& creature)
 	if (auto* chunk = g_game.map.getChunk(owning_chunk))
 	{
 		chunk->RemoveCreature(creature);
+		g_game.map.invalidateSpectatorCache(tilePos.x, tilePos.y);
 	}
 	if (const auto creatures = getCreatures())
 	{
@@ -1483,6 +1492,7 @@ void Tile::notifyCreatureRemoved(const CreaturePtr& creature, const TilePtr&, st
 
 void Tile::addItemSilently(const ItemPtr& item)
 {
+	invalidateDescription();
 	item->setTileParent(getTile());
 
 	if (auto itemContainer = item->getContainer())
@@ -1671,8 +1681,38 @@ void Tile::syncChunkFlags()
 	const uint32_t offsetX = tilePos.x & BlackTek::World::Floor::Mask;
 	const uint32_t offsetY = tilePos.y & BlackTek::World::Floor::Mask;
 
+	const uint64_t projectileBits = chunk->block_projectile_mask[tilePos.z];
+	const uint64_t areaBits = chunk->block_area_mask[tilePos.z];
+	// cross floor sight goes through tiles without ground, see Map::isTileClear
+	const uint64_t groundBits = chunk->ground_mask[tilePos.z];
+
 	chunk->SetTileBlockState(offsetX, offsetY, tilePos.z,
-		hasFlag(TILESTATE_BLOCKPATH), hasFlag(TILESTATE_BLOCKSOLID), hasProperty(CONST_PROP_BLOCKPROJECTILE));
+		hasFlag(TILESTATE_BLOCKPATH), hasFlag(TILESTATE_BLOCKSOLID), hasProperty(CONST_PROP_BLOCKPROJECTILE), blocksArea());
+	chunk->SetTileWalkState(offsetX, offsetY, tilePos.z, ground != nullptr, needsWalkCheck());
+
+	if (chunk->block_projectile_mask[tilePos.z] != projectileBits || chunk->block_area_mask[tilePos.z] != areaBits
+			|| chunk->ground_mask[tilePos.z] != groundBits) {
+		g_game.map.invalidateSightCache();
+	}
+}
+
+bool Tile::blocksArea() const
+{
+	return hasFlag(TILESTATE_IMMOVABLEBLOCKSOLID | TILESTATE_BLOCKPATH | TILESTATE_IMMOVABLENOFIELDBLOCKPATH);
+}
+
+bool Tile::needsWalkCheck()
+{
+	if (isHouseTile() || hasFlag(TILESTATE_FLOORCHANGE | TILESTATE_TELEPORT | TILESTATE_MAGICFIELD)) {
+		return true;
+	}
+
+	// blocking items some creatures push out of their way
+	if (hasFlag(TILESTATE_BLOCKSOLID) && !hasFlag(TILESTATE_IMMOVABLEBLOCKSOLID)) {
+		return true;
+	}
+
+	return hasFlag(TILESTATE_NOFIELDBLOCKPATH) && !hasFlag(TILESTATE_IMMOVABLENOFIELDBLOCKPATH);
 }
 
 bool Tile::isMoveableBlocking() const
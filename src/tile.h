@@ -132,6 +132,24 @@ class TileItemVector : public ItemVector
 		uint16_t downItemCount = 0;
 };
 
+// Client encoding of the item part of a tile: the environment marker, ground and top items, then
+// the down items, each item exactly as NetworkMessage::addItem writes it. It does not depend on the
+// viewer, so ProtocolGame builds it once and copies it into every map description; the tile marks
+// it stale on any item change and it is rebuilt on the next description.
+struct TileDescriptionCache
+{
+	// the client shows at most this many things (items and creatures) per tile
+	static constexpr uint8_t MAX_THINGS = 10;
+
+	std::vector<uint8_t> bytes;
+	uint16_t headSize = 0;
+	uint8_t headCount = 0;
+	uint8_t downCount = 0;
+	// end offset in `bytes` of each of the first down items
+	std::array<uint16_t, MAX_THINGS> downEnds{};
+	bool valid = false;
+};
+
 class House;
 class CreatureContainer;
 
@@ -307,6 +325,11 @@ class Tile : public SharedObject
 			return house != nullptr;
 		}
 
+		// whether the path and solid state alone can't tell if a creature may enter, see Chunk::walk_check_mask
+		bool needsWalkCheck();
+		// whether area spells stop spreading at this tile, see Chunk::block_area_mask
+		bool blocksArea() const;
+
 		ItemPtr getUseItem(int32_t index);
 
 		ItemPtr getGround() const {
@@ -325,11 +348,25 @@ class Tile : public SharedObject
 	
 		void setGround(const ItemPtr& item) {
 			ground = item;
+			invalidateDescription();
 		}
 
 		void updateHouse(const ItemPtr& item);
 
+		TileDescriptionCache& getDescriptionCache() const {
+			if (not descriptionCache) {
+				descriptionCache = std::make_unique<TileDescriptionCache>();
+			}
+			return *descriptionCache;
+		}
+
 	private:
+		void invalidateDescription() {
+			if (descriptionCache) {
+				descriptionCache->valid = false;
+			}
+		}
+
         TilePtr resolveFloorChangeDestination(uint32_t& flags);
 
 		void onAddTileItem(const ItemPtr& item, std::span<const CreaturePtr> spectators);
@@ -351,5 +388,6 @@ class Tile : public SharedObject
 		uint32_t itemProperties = 0;
 		TileItemsPtr items;
 		std::unique_ptr<CreatureContainer> creatures;
+		mutable std::unique_ptr<TileDescriptionCache> descriptionCache;
 };
 #endif
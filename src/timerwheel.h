@@ -0,0 +1,232 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_TIMERWHEEL_H
+#define FS_TIMERWHEEL_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace BlackTek
+{
+	// Intrusive hook for TimerWheel. Whatever derives from this can be scheduled without the
+	// wheel allocating anything; a node sits in at most one wheel at a time.
+	struct TimerWheelNode
+	{
+		TimerWheelNode* wheel_prev = nullptr;
+		TimerWheelNode* wheel_next = nullptr;
+		uint64_t wheel_expiry = 0;
+		uint16_t wheel_slot = 0;
+
+		[[nodiscard]] bool isScheduled() const noexcept { return wheel_next != nullptr; }
+	};
+
+	// Hashed hierarchical timer wheel with 1 tick (1 ms for our users) resolution.
+	//
+	// Level 0 has 256 one-tick buckets; levels 1..3 have 64 buckets each covering 256, 16384 and
+	// 1048576 ticks, so anything up to ~18.6 hours is placed exactly and anything further out parks
+	// in the last level-3 bucket and is re-placed when that bucket cascades. schedule() and cancel()
+	// are O(1); advance() touches one bucket per elapsed tick that actually holds timers, plus a
+	// cascade every 256 ticks while the upper levels are non-empty. Not thread-safe.
+	class TimerWheel
+	{
+	public:
+		static constexpr uint32_t LEVEL0_BITS = 8;
+		static constexpr uint32_t LEVELN_BITS = 6;
+		static constexpr uint32_t LEVELS = 4;
+		static constexpr uint32_t LEVEL0_SLOTS = 1u << LEVEL0_BITS;
+		static constexpr uint32_t LEVELN_SLOTS = 1u << LEVELN_BITS;
+		static constexpr uint32_t SLOT_COUNT = LEVEL0_SLOTS + (LEVELS - 1) * LEVELN_SLOTS;
+		static constexpr uint64_t MAX_RANGE = uint64_t{1} << (LEVEL0_BITS + (LEVELS - 1) * LEVELN_BITS);
+
+		explicit TimerWheel(uint64_t startTick = 0) noexcept : now(startTick)
+		{
+			for (auto& head : slots) {
+				head.wheel_prev = head.wheel_next = &head;
+			}
+		}
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		[[nodiscard]] uint64_t currentTick() const noexcept { return now; }
+		[[nodiscard]] std::size_t size() const noexcept { return count; }
+		[[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+		// Expiries at or before the current tick fire on the next advance().
+		void schedule(TimerWheelNode* node, uint64_t expiryTick) noexcept
+		{
+			node->wheel_expiry = expiryTick > now ? expiryTick : now + 1;
+			place(node);
+			++count;
+		}
+
+		void cancel(TimerWheelNode* node) noexcept
+		{
+			if (not node->isScheduled()) {
+				return;
+			}
+			unlink(node);
+			--count;
+		}
+
+		// Moves the wheel forward to `targetTick`, calling onExpired(TimerWheelNode*) for every node
+		// that comes due, in tick order and FIFO within a tick. The node is already unlinked when the
+		// callback runs, so the callback may free it or schedule it (or anything else) again.
+		template <typename Fn>
+		void advance(uint64_t targetTick, Fn&& onExpired)
+		{
+			while (now < targetTick) {
+				if (count == 0) {
+					now = targetTick;
+					return;
+				}
+
+				// jump straight to the next occupied level-0 bucket or the next cascade boundary
+				const uint64_t next = nextInterestingTick();
+				now = next <= targetTick ? next - 1 : targetTick;
+				if (now == targetTick) {
+					return;
+				}
+
+				++now;
+				if ((now & (LEVEL0_SLOTS - 1)) == 0) {
+					cascade();
+				}
+				expireSlot(static_cast<uint32_t>(now & (LEVEL0_SLOTS - 1)), onExpired);
+			}
+		}
+
+		// The earliest tick worth waking up for: either a level-0 bucket holding timers or the next
+		// level-0 wrap, where upper-level timers cascade down. nullopt when nothing is scheduled.
+		[[nodiscard]] std::optional<uint64_t> nextWakeTick() const noexcept
+		{
+			if (count == 0) {
+				return std::nullopt;
+			}
+			return nextInterestingTick();
+		}
+
+	private:
+		uint64_t nextInterestingTick() const noexcept
+		{
+			const uint32_t start = static_cast<uint32_t>((now + 1) & (LEVEL0_SLOTS - 1));
+			if (start == 0) {
+				// the very next tick is a level-0 wrap and has to be visited for its cascade
+				return now + 1;
+			}
+
+			// level-0 buckets from `start` up belong to the current 256-tick block; buckets below
+			// it belong to the next block, which is only reached through the wrap (cascade) tick
+			const uint64_t blockBase = now & ~uint64_t{LEVEL0_SLOTS - 1};
+			for (uint32_t word = start / 64; word < LEVEL0_SLOTS / 64; ++word) {
+				uint64_t bits = occupied[word];
+				if (word == start / 64) {
+					bits &= ~uint64_t{0} << (start % 64);
+				}
+				if (bits != 0) {
+					return blockBase + word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+				}
+			}
+			return blockBase + LEVEL0_SLOTS;
+		}
+
+		void place(TimerWheelNode* node) noexcept
+		{
+			const uint64_t expiry = node->wheel_expiry;
+			const uint64_t delta = expiry - now;
+
+			uint32_t slot;
+			if (delta < LEVEL0_SLOTS) {
+				slot = static_cast<uint32_t>(expiry & (LEVEL0_SLOTS - 1));
+				occupied[slot / 64] |= uint64_t{1} << (slot % 64);
+			} else {
+				// beyond the top level: park in the furthest bucket and get re-placed on cascade
+				const uint64_t placed = delta < MAX_RANGE ? expiry : now + MAX_RANGE - 1;
+				uint32_t level = 1;
+				while (level < LEVELS - 1 and (placed - now) >= (uint64_t{1} << (LEVEL0_BITS + level * LEVELN_BITS))) {
+					++level;
+				}
+				const uint32_t shift = LEVEL0_BITS + (level - 1) * LEVELN_BITS;
+				slot = LEVEL0_SLOTS + (level - 1) * LEVELN_SLOTS + static_cast<uint32_t>((placed >> shift) & (LEVELN_SLOTS - 1));
+			}
+
+			TimerWheelNode& head = slots[slot];
+			node->wheel_slot = static_cast<uint16_t>(slot);
+			node->wheel_next = &head;
+			node->wheel_prev = head.wheel_prev;
+			head.wheel_prev->wheel_next = node;
+			head.wheel_prev = node;
+		}
+
+		void unlink(TimerWheelNode* node) noexcept
+		{
+			node->wheel_prev->wheel_next = node->wheel_next;
+			node->wheel_next->wheel_prev = node->wheel_prev;
+
+			const uint32_t slot = node->wheel_slot;
+			if (slot < LEVEL0_SLOTS and slots[slot].wheel_next == &slots[slot]) {
+				occupied[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+			}
+			node->wheel_prev = node->wheel_next = nullptr;
+		}
+
+		// Re-places every node of the upper-level bucket that `now` has just entered. A level only
+		// cascades when the level below it wrapped, so the lowest level goes first and a node pulled
+		// down from level 3 can land directly in level 0 if it is already that close.
+		void cascade() noexcept
+		{
+			for (uint32_t level = 1; level < LEVELS; ++level) {
+				const uint32_t shift = LEVEL0_BITS + (level - 1) * LEVELN_BITS;
+				const uint32_t index = static_cast<uint32_t>((now >> shift) & (LEVELN_SLOTS - 1));
+				TimerWheelNode& head = slots[LEVEL0_SLOTS + (level - 1) * LEVELN_SLOTS + index];
+
+				TimerWheelNode* node = head.wheel_next;
+				head.wheel_prev = head.wheel_next = &head;
+				while (node != &head) {
+					TimerWheelNode* next = node->wheel_next;
+					place(node);
+					node = next;
+				}
+
+				if (index != 0) {
+					break;
+				}
+			}
+		}
+
+		template <typename Fn>
+		void expireSlot(uint32_t slot, Fn& onExpired)
+		{
+			TimerWheelNode& head = slots[slot];
+			if (head.wheel_next == &head) {
+				return;
+			}
+
+			// detach the bucket first: callbacks may schedule into this very slot (for the next lap)
+			TimerWheelNode* node = head.wheel_next;
+			head.wheel_prev->wheel_next = nullptr;
+			head.wheel_prev = head.wheel_next = &head;
+			occupied[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+
+			while (node) {
+				TimerWheelNode* next = node->wheel_next;
+				node->wheel_prev = node->wheel_next = nullptr;
+				--count;
+				onExpired(node);
+				node = next;
+			}
+		}
+
+		std::array<TimerWheelNode, SLOT_COUNT> slots;
+		std::array<uint64_t, LEVEL0_SLOTS / 64> occupied{};
+		uint64_t now = 0;
+		std::size_t count = 0;
+	};
+}
+
+#endif
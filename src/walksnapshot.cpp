@@ -0,0 +1,92 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "walksnapshot.h"
+
+#include "map.h"
+
+namespace BlackTek::World
+{
+    namespace
+    {
+        constexpr uint32_t MissingChunk = ~uint32_t{ 0 };
+
+        const Chunk* ChunkAt(Map& map, const int32_t chunkX, const int32_t chunkY)
+        {
+            return map.getChunk(static_cast<uint16_t>(chunkX << Floor::Bits), static_cast<uint16_t>(chunkY << Floor::Bits));
+        }
+    }
+
+    std::shared_ptr<const WalkSnapshot> WalkSnapshot::Capture(Map& map, const Position& center, const int32_t radius, const Creature* ignored)
+    {
+        auto snapshot = std::make_shared<WalkSnapshot>();
+        snapshot->z = center.z;
+        snapshot->min_x = std::max<int32_t>(center.x - radius, 0);
+        snapshot->min_y = std::max<int32_t>(center.y - radius, 0);
+        snapshot->max_x = std::min<int32_t>(center.x + radius, 0xFFFF);
+        snapshot->max_y = std::min<int32_t>(center.y + radius, 0xFFFF);
+
+        snapshot->first_chunk_x = snapshot->min_x >> Floor::Bits;
+        snapshot->first_chunk_y = snapshot->min_y >> Floor::Bits;
+        snapshot->chunks_wide = (snapshot->max_x >> Floor::Bits) - snapshot->first_chunk_x + 1;
+        const int32_t chunksHigh = (snapshot->max_y >> Floor::Bits) - snapshot->first_chunk_y + 1;
+
+        snapshot->blocked.assign(snapshot->chunks_wide * chunksHigh, ~uint64_t{ 0 });
+        snapshot->revisions.assign(snapshot->chunks_wide * chunksHigh, MissingChunk);
+
+        if (center.z >= MaxLayers)
+            return snapshot;
+
+        for (int32_t row = 0; row < chunksHigh; ++row)
+        {
+            for (int32_t column = 0; column < snapshot->chunks_wide; ++column)
+            {
+                const Chunk* chunk = ChunkAt(map, snapshot->first_chunk_x + column, snapshot->first_chunk_y + row);
+                if (not chunk)
+                    continue;
+
+                const size_t index = row * snapshot->chunks_wide + column;
+                snapshot->revisions[index] = chunk->path_revision[center.z];
+
+                if (not chunk->floor_handles[center.z].IsValid())
+                    continue;
+
+                uint64_t bits = chunk->block_path_mask[center.z] | chunk->block_solid_mask[center.z];
+                for (size_t i = 0; i < chunk->creature_ptrs.size(); ++i)
+                {
+                    if (chunk->creature_z[i] != center.z or chunk->creature_ptrs[i].get() == ignored)
+                        continue;
+
+                    bits |= uint64_t{ 1 } << ((chunk->creature_y[i] & Floor::Mask) * Floor::Size + (chunk->creature_x[i] & Floor::Mask));
+                }
+                snapshot->blocked[index] = bits;
+            }
+        }
+        return snapshot;
+    }
+
+    bool WalkSnapshot::IsBlocked(const int32_t x, const int32_t y) const
+    {
+        if (x < min_x or y < min_y or x > max_x or y > max_y)
+            return true;
+
+        const size_t index = ((y >> Floor::Bits) - first_chunk_y) * chunks_wide + ((x >> Floor::Bits) - first_chunk_x);
+        return (blocked[index] >> ((y & Floor::Mask) * Floor::Size + (x & Floor::Mask))) & 1u;
+    }
+
+    bool WalkSnapshot::IsCurrent(Map& map) const
+    {
+        for (size_t index = 0; index < revisions.size(); ++index)
+        {
+            const int32_t chunkX = first_chunk_x + static_cast<int32_t>(index % chunks_wide);
+            const int32_t chunkY = first_chunk_y + static_cast<int32_t>(index / chunks_wide);
+
+            const Chunk* chunk = ChunkAt(map, chunkX, chunkY);
+            if ((chunk ? chunk->path_revision[z] : MissingChunk) != revisions[index])
+                return false;
+        }
+        return true;
+    }
+}
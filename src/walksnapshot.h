@@ -0,0 +1,46 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "position.h"
+
+class Creature;
+class Map;
+
+namespace BlackTek::World
+{
+    // Immutable copy of the walkability around one position, taken on the dispatcher so that a path search
+    // can run on another thread. Per chunk it keeps the path and solid bits plus the tiles creatures stood on,
+    // and the path_revision each chunk had at the time, which is the version a result is checked against.
+    class WalkSnapshot
+    {
+    public:
+        // `ignored` is left out of the creature bits, usually the creature the path is for
+        static std::shared_ptr<const WalkSnapshot> Capture(Map& map, const Position& center, int32_t radius, const Creature* ignored);
+
+        // anything outside of the captured square counts as blocked
+        [[nodiscard]] bool IsBlocked(int32_t x, int32_t y) const;
+
+        // false once any captured chunk had its path bits changed (or was created)
+        [[nodiscard]] bool IsCurrent(Map& map) const;
+
+    private:
+        int32_t min_x = 0;
+        int32_t min_y = 0;
+        int32_t max_x = -1;
+        int32_t max_y = -1;
+        int32_t first_chunk_x = 0;
+        int32_t first_chunk_y = 0;
+        int32_t chunks_wide = 0;
+        uint8_t z = 0;
+
+        // per chunk, row by row
+        std::vector<uint64_t> blocked;
+        std::vector<uint32_t> revisions;
+    };
+}
@@ -0,0 +1,139 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "zoneindex.h"
+
+#include <algorithm>
+
+namespace Zones
+{
+    ZoneArea ZoneArea::FromCorners(const Position& first, const Position& second)
+    {
+        ZoneArea area;
+        area.min_x = std::min(first.x, second.x);
+        area.min_y = std::min(first.y, second.y);
+        area.max_x = std::max(first.x, second.x);
+        area.max_y = std::max(first.y, second.y);
+        area.min_z = std::min(first.z, second.z);
+        area.max_z = std::max(first.z, second.z);
+        return area;
+    }
+
+    void ZoneIndex::Insert(uint64_t owner, const ZoneArea& area)
+    {
+        uint32_t entryIndex;
+        if (not free_entries.empty())
+        {
+            entryIndex = free_entries.back();
+            free_entries.pop_back();
+        }
+        else
+        {
+            entryIndex = static_cast<uint32_t>(entries.size());
+            entries.emplace_back();
+        }
+
+        entries[entryIndex] = { owner, area };
+        owner_entries[owner].push_back(entryIndex);
+
+        for (uint32_t chunkY = area.min_y >> Floor::Bits; chunkY <= static_cast<uint32_t>(area.max_y >> Floor::Bits); ++chunkY)
+        {
+            for (uint32_t chunkX = area.min_x >> Floor::Bits; chunkX <= static_cast<uint32_t>(area.max_x >> Floor::Bits); ++chunkX)
+                buckets[BucketKey(chunkX, chunkY)].push_back(entryIndex);
+        }
+    }
+
+    void ZoneIndex::InsertPositions(uint64_t owner, std::vector<Position> positions)
+    {
+        std::ranges::sort(positions, [](const Position& a, const Position& b) {
+            return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x);
+        });
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+        // runs of neighboring tiles on a row become one area, a run spanning the same columns as a run on the
+        // row above extends that area downwards instead
+        std::vector<ZoneArea> areas;
+        gtl::flat_hash_map<uint64_t, size_t> openColumns;
+
+        for (size_t i = 0; i < positions.size(); )
+        {
+            const Position& first = positions[i];
+            size_t last = i;
+            while (last + 1 < positions.size() and positions[last + 1].z == first.z and positions[last + 1].y == first.y
+                and positions[last + 1].x == positions[last].x + 1)
+                ++last;
+
+            ZoneArea row = ZoneArea::FromCorners(first, positions[last]);
+            const uint64_t columnsKey = (uint64_t{ row.min_z } << 32) | (uint64_t{ row.min_x } << 16) | row.max_x;
+
+            if (auto open = openColumns.find(columnsKey); open != openColumns.end() and areas[open->second].max_y + 1 == row.min_y)
+            {
+                areas[open->second].max_y = row.max_y;
+            }
+            else
+            {
+                openColumns[columnsKey] = areas.size();
+                areas.push_back(row);
+            }
+
+            i = last + 1;
+        }
+
+        for (const auto& area : areas)
+            Insert(owner, area);
+    }
+
+    void ZoneIndex::Remove(uint64_t owner)
+    {
+        auto it = owner_entries.find(owner);
+        if (it == owner_entries.end())
+            return;
+
+        for (uint32_t entryIndex : it->second)
+        {
+            const ZoneArea& area = entries[entryIndex].area;
+
+            for (uint32_t chunkY = area.min_y >> Floor::Bits; chunkY <= static_cast<uint32_t>(area.max_y >> Floor::Bits); ++chunkY)
+            {
+                for (uint32_t chunkX = area.min_x >> Floor::Bits; chunkX <= static_cast<uint32_t>(area.max_x >> Floor::Bits); ++chunkX)
+                {
+                    auto bucket = buckets.find(BucketKey(chunkX, chunkY));
+                    if (bucket == buckets.end())
+                        continue;
+
+                    std::erase(bucket->second, entryIndex);
+                    if (bucket->second.empty())
+                        buckets.erase(bucket);
+                }
+            }
+
+            free_entries.push_back(entryIndex);
+        }
+
+        owner_entries.erase(it);
+    }
+
+    void ZoneIndex::Clear()
+    {
+        entries.clear();
+        free_entries.clear();
+        buckets.clear();
+        owner_entries.clear();
+    }
+
+    std::vector<ZoneArea> ZoneIndex::AreasOf(uint64_t owner) const
+    {
+        std::vector<ZoneArea> areas;
+
+        if (auto it = owner_entries.find(owner); it != owner_entries.end())
+        {
+            areas.reserve(it->second.size());
+            for (uint32_t entryIndex : it->second)
+                areas.push_back(entries[entryIndex].area);
+        }
+
+        return areas;
+    }
+}
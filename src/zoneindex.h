@@ -0,0 +1,112 @@
+// Copyright 2024 Black Tek Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#pragma once
+
+#include "floorpool.h"
+#include "position.h"
+
+#include <cstdint>
+#include <vector>
+#include <gtl/phmap.hpp>
+
+namespace Zones
+{
+    // Box of tiles, both corners included
+    struct ZoneArea
+    {
+        uint16_t min_x = 0;
+        uint16_t min_y = 0;
+        uint16_t max_x = 0;
+        uint16_t max_y = 0;
+        uint8_t  min_z = 0;
+        uint8_t  max_z = 0;
+
+        static ZoneArea FromCorners(const Position& first, const Position& second);
+        static ZoneArea FromPosition(const Position& position) { return FromCorners(position, position); }
+
+        [[nodiscard]] bool Contains(const Position& pos) const
+        {
+            return pos.x >= min_x and pos.x <= max_x
+               and pos.y >= min_y and pos.y <= max_y
+               and pos.z >= min_z and pos.z <= max_z;
+        }
+
+        [[nodiscard]] uint64_t TileCount() const
+        {
+            return uint64_t{ max_x - min_x + 1u } * (max_y - min_y + 1u) * (max_z - min_z + 1u);
+        }
+    };
+
+    // Areas bucketed by the map chunks (Floor::Size tiles square) they overlap, a lookup only tests the few
+    // areas of one bucket. A rectangle costs one bucket entry per chunk instead of one entry per tile and
+    // position lists are merged into rectangles before they go in. Every area belongs to an owner (zone id or
+    // packed zone handle), which is what lookups hand back and what removal goes by.
+    class ZoneIndex
+    {
+    public:
+        void Insert(uint64_t owner, const ZoneArea& area);
+        void InsertPositions(uint64_t owner, std::vector<Position> positions);
+        void Remove(uint64_t owner);
+        void Clear();
+
+        [[nodiscard]] std::vector<ZoneArea> AreasOf(uint64_t owner) const;
+        [[nodiscard]] size_t AreaCount() const { return entries.size() - free_entries.size(); }
+        [[nodiscard]] size_t BucketCount() const { return buckets.size(); }
+
+        // callback(owner, area) for every area holding pos
+        template <typename Callback>
+        void ForEach(const Position& pos, Callback&& callback) const
+        {
+            auto it = buckets.find(BucketKey(pos.x >> Floor::Bits, pos.y >> Floor::Bits));
+            if (it == buckets.end())
+                return;
+
+            for (uint32_t entryIndex : it->second)
+            {
+                const Entry& entry = entries[entryIndex];
+                if (entry.area.Contains(pos))
+                    callback(entry.owner, entry.area);
+            }
+        }
+
+        // callback(owner, area) for every area overlapping the chunk holding (x, y)
+        template <typename Callback>
+        void ForEachInChunk(uint16_t x, uint16_t y, Callback&& callback) const
+        {
+            auto it = buckets.find(BucketKey(x >> Floor::Bits, y >> Floor::Bits));
+            if (it == buckets.end())
+                return;
+
+            for (uint32_t entryIndex : it->second)
+                callback(entries[entryIndex].owner, entries[entryIndex].area);
+        }
+
+        // callback(owner, area) for every area in the index
+        template <typename Callback>
+        void ForEachArea(Callback&& callback) const
+        {
+            for (const auto& [owner, entryIndexes] : owner_entries)
+            {
+                for (uint32_t entryIndex : entryIndexes)
+                    callback(owner, entries[entryIndex].area);
+            }
+        }
+
+    private:
+        using Floor = BlackTek::World::Floor;
+
+        struct Entry
+        {
+            uint64_t owner = 0;
+            ZoneArea area;
+        };
+
+        static constexpr uint32_t BucketKey(uint32_t chunkX, uint32_t chunkY) { return (chunkX << 16) | chunkY; }
+
+        std::vector<Entry> entries;
+        std::vector<uint32_t> free_entries;
+        gtl::flat_hash_map<uint32_t, std::vector<uint32_t>> buckets;
+        gtl::flat_hash_map<uint64_t, std::vector<uint32_t>> owner_entries;
+    };
+}
@@ -26,6 +26,7 @@
 #include <unordered_set>
 #include <chrono>
 #include <numeric>
+#include <bit>
 #include <cstdlib>
 
 extern ConfigManager g_config;
@@ -370,24 +371,7 @@ namespace Zones
         startpos = start;
         range_end = end;
 
-        uint16_t sx = start.x, sy = start.y, ex = end.x, ey = end.y;
-        uint8_t  sz = start.z, ez = end.z;
-
-        const uint32_t minX = std::min(sx, ex), maxX = std::max(sx, ex);
-        const uint32_t minY = std::min(sy, ey), maxY = std::max(sy, ey);
-        const uint16_t minZ = std::min(sz, ez), maxZ = std::max(sz, ez);
-
-        for (uint32_t x = minX; x <= maxX; ++x)
-        {
-            for (uint32_t y = minY; y <= maxY; ++y)
-            {
-                for (uint16_t z = minZ; z <= maxZ; ++z)
-                {
-                    Position pos(static_cast<uint16_t>(x), static_cast<uint16_t>(y), static_cast<uint8_t>(z));
-                    ZoneManager::RegisterSpawnPosition(pos, self);
-                }
-            }
-        }
+        ZoneManager::RegisterSpawnRange(self, start, end);
     }
 
     void Zone::ProcessCreatures()
@@ -1828,10 +1812,9 @@ namespace Zones
     std::vector<int> ZoneManager::GetZonesByPosition(const Position& position)
     {
         std::vector<int> result;
-        auto range = position_zone_index.equal_range(position);
-
-        for (auto it = range.first; it != range.second; ++it)
-            result.push_back(it->second);
+        zone_index.ForEach(position, [&result](uint64_t owner, const ZoneArea&) {
+            result.push_back(static_cast<int>(owner));
+        });
 
         return result;
     }
@@ -1860,13 +1843,14 @@ namespace Zones
         ZoneHandle handle = zone_pool.Emplace(std::move(zone));
         Zone& registered = *zone_pool.TryGetMutable(handle);
 
-        for (const auto& position : registered.positions)
-            position_zone_index.insert({ position, id });
+        zone_index.InsertPositions(id, registered.positions);
+        if (registered.area_range)
+            zone_index.Insert(id, ZoneArea::FromCorners(registered.area_range->first, registered.area_range->second));
 
         if (registered.world_flags != 0)
         {
-            for (const auto& position : registered.positions)
-                world_flag_cache[position] |= registered.world_flags;
+            for (const auto& area : zone_index.AreasOf(id))
+                AddChunkFlags(area, registered.world_flags);
         }
 
         if (not registered.name.empty())
@@ -1889,55 +1873,20 @@ namespace Zones
 
         zone->Deactivate();
 
-        for (const auto& position : zone->positions)
-        {
-            auto range = position_zone_index.equal_range(position);
-
-            for (auto it = range.first; it != range.second; )
-            {
-                if (it->second == id)
-                    it = position_zone_index.erase(it);
-                else
-                    ++it;
-            }
-        }
+        const auto areas = zone_index.AreasOf(id);
+        zone_index.Remove(id);
 
-        for (const auto& position : zone->positions)
+        if (zone->world_flags != 0)
         {
-            uint32_t otherZoneFlags = 0;
-            auto range = position_zone_index.equal_range(position);
-
-            for (auto it = range.first; it != range.second; ++it)
-            {
-                if (it->second > 0 and it->second < static_cast<int>(zone_registry.size()) and zone_registry[it->second].IsValid())
-                {
-                    if (Zone* other = zone_pool.TryGetMutable(zone_registry[it->second]))
-                        otherZoneFlags |= other->world_flags;
-                }
-            }
-
-            auto externalIt = external_world_flags.find(position);
-            uint32_t externalFlags = (externalIt != external_world_flags.end() ? externalIt->second : 0);
-
-            auto cacheIt = world_flag_cache.find(position);
-            uint32_t remainingFlags = (cacheIt != world_flag_cache.end() ? cacheIt->second & ~zone->world_flags : 0) | otherZoneFlags | externalFlags;
-
-            if (remainingFlags != 0)
-                world_flag_cache[position] = remainingFlags;
-            else
-                world_flag_cache.erase(position);
+            for (const auto& area : areas)
+                RestampChunkFlags(area);
         }
 
-        if (zone->range_end)
-        {
-            for (const auto& position : FillRectangle(zone->startpos, *zone->range_end))
-            {
-                auto it = spawn_position_registry.find(position);
-
-                if (it != spawn_position_registry.end() and it->second.RemoveZone(handle))
-                    spawn_position_registry.erase(it);
-            }
-        }
+        const uint64_t spawnOwner = (uint64_t{ handle.slot_index } << 32) | handle.generation;
+        spawn_index.Remove(spawnOwner);
+        std::erase_if(spawn_overlays, [spawnOwner](const auto& overlay) {
+            return std::ranges::find(overlay.first, spawnOwner) != overlay.first.end();
+        });
 
         if (not zone->name.empty())
             name_registry.erase(zone->name);
@@ -1969,8 +1918,7 @@ namespace Zones
         if (id >= static_cast<int>(zone_registry.size()))
             zone_registry.resize(static_cast<size_t>(id) + 1);
 
-        for (const auto& pos : positions)
-            position_zone_index.insert({ pos, id });
+        zone_index.InsertPositions(id, positions);
 
         Zone newZone(id);
         newZone.positions = std::move(positions);
@@ -2089,7 +2037,7 @@ namespace Zones
                 return { ParseCode::InvalidFormat, "Zone '" + name + "' has neither 'positions' nor 'range'" };
 
             if (explicitPositions.empty() and explicitRange)
-                explicitPositions = FillRectangle(explicitRange->first, explicitRange->second);
+                zone.area_range = explicitRange;
 
             if (not explicitRange and zone.entity_type != SpawnType::None)
             {
@@ -2272,11 +2220,18 @@ namespace Zones
     {
         zone_registry.clear();
         zone_registry.push_back(ZoneHandle{});
-        position_zone_index.clear();
-        world_flag_cache.clear();
+        if (chunk_flags_stamped)
+        {
+            zone_index.ForEachArea([](uint64_t, const ZoneArea& area) { ClearChunkFlags(area); });
+            for (const auto& [position, flags] : external_world_flags)
+                ClearChunkFlags(ZoneArea::FromPosition(position));
+        }
+
+        zone_index.Clear();
         external_world_flags.clear();
         name_registry.clear();
-        spawn_position_registry.clear();
+        spawn_index.Clear();
+        spawn_overlays.clear();
         triggered_spawns.clear();
         staged_spawns.clear();
         linked_spawns.clear();
@@ -2290,13 +2245,16 @@ namespace Zones
         LoadZones();
     }
 
-    void ZoneManager::RegisterSpawnPosition(Position& position, ZoneHandle zone)
+    void ZoneManager::RegisterSpawnRange(ZoneHandle zone, const Position& start, const Position& end)
     {
-        auto entry = spawn_position_registry.find(position);
-        if (entry != spawn_position_registry.end())
-            entry->second.AddZone(zone);
-        else
-            spawn_position_registry.emplace(position, ZoneOverlay(zone));
+        // a zone has one spawn range, setting it again replaces the old one
+        const uint64_t owner = (uint64_t{ zone.slot_index } << 32) | zone.generation;
+        spawn_index.Remove(owner);
+        std::erase_if(spawn_overlays, [owner](const auto& overlay) {
+            return std::ranges::find(overlay.first, owner) != overlay.first.end();
+        });
+
+        spawn_index.Insert(owner, ZoneArea::FromCorners(start, end));
     }
 
     void ZoneManager::RegisterTriggered(uint32_t triggered_id, SpawnTrigger trigger)
@@ -2316,8 +2274,26 @@ namespace Zones
 
     ZoneOverlay* ZoneManager::GetSpawns(Position position)
     {
-        auto it = spawn_position_registry.find(position);
-        return (it != spawn_position_registry.end()) ? &it->second : nullptr;
+        static std::vector<uint64_t> owners;
+        owners.clear();
+        spawn_index.ForEach(position, [](uint64_t owner, const ZoneArea&) { owners.push_back(owner); });
+
+        if (owners.empty())
+            return nullptr;
+
+        std::ranges::sort(owners);
+        auto it = spawn_overlays.find(owners);
+
+        if (it == spawn_overlays.end())
+        {
+            ZoneOverlay overlay;
+            for (uint64_t owner : owners)
+                overlay.AddZone(ZoneHandle{ static_cast<uint32_t>(owner >> 32), static_cast<uint32_t>(owner) });
+
+            it = spawn_overlays.emplace(owners, std::move(overlay)).first;
+        }
+
+        return &it->second;
     }
 
     Zone* ZoneManager::TryGetMutable(ZoneHandle handle)
@@ -2496,30 +2472,283 @@ namespace Zones
            and (pos.getY() >= centerPos.getY() - radius) and (pos.getY() <= centerPos.getY() + radius);
     }
 
+    static_assert(static_cast<uint32_t>(ZoneFlag::NoNpcs) == 1u << (BlackTek::World::ZoneFlagPlanes - 1),
+        "every ZoneFlag needs its own chunk bitplane");
+
+    static constexpr uint32_t ChunkFlagMask = (1u << BlackTek::World::ZoneFlagPlanes) - 1;
+
+    // tiles of the area inside the chunk starting at (baseX, baseY), as a chunk layer bit mask
+    static uint64_t ChunkAreaMask(const ZoneArea& area, uint32_t baseX, uint32_t baseY)
+    {
+        using BlackTek::World::Floor;
+
+        const uint32_t firstX = std::max<uint32_t>(area.min_x, baseX) - baseX;
+        const uint32_t lastX  = std::min<uint32_t>(area.max_x, baseX + Floor::Mask) - baseX;
+        const uint32_t firstY = std::max<uint32_t>(area.min_y, baseY) - baseY;
+        const uint32_t lastY  = std::min<uint32_t>(area.max_y, baseY + Floor::Mask) - baseY;
+
+        const uint64_t row = ((uint64_t{1} << (lastX - firstX + 1)) - 1) << firstX;
+        uint64_t mask = 0;
+        for (uint32_t y = firstY; y <= lastY; ++y)
+            mask |= row << (y * Floor::Size);
+
+        return mask;
+    }
+
+    // callback(chunk, z, baseX, baseY, mask) for every layer of every existing chunk the area overlaps
+    template <typename Callback>
+    static void ForEachChunkLayer(const ZoneArea& area, Callback&& callback)
+    {
+        using namespace BlackTek::World;
+
+        const uint8_t lastZ = std::min<uint8_t>(area.max_z, MaxLayers - 1);
+
+        for (uint32_t chunkY = area.min_y >> Floor::Bits; chunkY <= static_cast<uint32_t>(area.max_y >> Floor::Bits); ++chunkY)
+        {
+            for (uint32_t chunkX = area.min_x >> Floor::Bits; chunkX <= static_cast<uint32_t>(area.max_x >> Floor::Bits); ++chunkX)
+            {
+                const uint32_t baseX = chunkX << Floor::Bits;
+                const uint32_t baseY = chunkY << Floor::Bits;
+
+                // no chunk means no tile yet, Map::setTile stamps the chunk once one is created
+                Chunk* chunk = g_game.map.getChunk(static_cast<uint16_t>(baseX), static_cast<uint16_t>(baseY));
+                if (not chunk)
+                    continue;
+
+                const uint64_t mask = ChunkAreaMask(area, baseX, baseY);
+                for (uint32_t z = area.min_z; z <= lastZ; ++z)
+                    callback(*chunk, static_cast<uint8_t>(z), baseX, baseY, mask);
+            }
+        }
+    }
+
+    static void SetChunkLayerFlags(BlackTek::World::Chunk& chunk, uint8_t z, uint64_t mask, uint32_t flags)
+    {
+        flags &= ChunkFlagMask;
+        if (flags == 0 or mask == 0)
+            return;
+
+        if (not chunk.zone_flags)
+            chunk.zone_flags = std::make_unique<BlackTek::World::ZoneFlagLayers>();
+
+        auto& planes = (*chunk.zone_flags)[z];
+        for (; flags != 0; flags &= flags - 1)
+            planes[std::countr_zero(flags)] |= mask;
+    }
+
+    uint32_t ZoneManager::CollectWorldFlags(const Position& pos)
+    {
+        uint32_t flags = 0;
+
+        if (auto it = external_world_flags.find(pos); it != external_world_flags.end())
+            flags = it->second;
+
+        zone_index.ForEach(pos, [&flags](uint64_t owner, const ZoneArea&) {
+            if (const Zone* zone = GetZone(static_cast<int>(owner)))
+                flags |= zone->world_flags;
+        });
+
+        return flags;
+    }
+
+    uint32_t ZoneManager::ReadChunkFlags(const Position& pos, uint32_t mask)
+    {
+        using namespace BlackTek::World;
+
+        if (pos.z >= MaxLayers)
+            return 0;
+
+        const Chunk* chunk = g_game.map.getChunk(pos.x, pos.y);
+        if (not chunk or not chunk->zone_flags)
+            return 0;
+
+        const auto& planes = (*chunk->zone_flags)[pos.z];
+        const uint32_t bitIndex = (pos.y & Floor::Mask) * Floor::Size + (pos.x & Floor::Mask);
+
+        uint32_t flags = 0;
+        for (mask &= ChunkFlagMask; mask != 0; mask &= mask - 1)
+        {
+            const int plane = std::countr_zero(mask);
+            if ((planes[plane] >> bitIndex) & 1u)
+                flags |= 1u << plane;
+        }
+
+        return flags;
+    }
+
+    std::optional<uint64_t> ZoneManager::ChunkFlagBits(const BlackTek::World::Chunk& chunk, const uint8_t z, uint32_t flags)
+    {
+        if (not chunk_flags_stamped)
+            return std::nullopt;
+
+        if (z >= BlackTek::World::MaxLayers or not chunk.zone_flags)
+            return 0;
+
+        const auto& planes = (*chunk.zone_flags)[z];
+
+        uint64_t bits = 0;
+        for (flags &= ChunkFlagMask; flags != 0; flags &= flags - 1)
+            bits |= planes[std::countr_zero(flags)];
+
+        return bits;
+    }
+
+    void ZoneManager::AddChunkFlags(const ZoneArea& area, uint32_t flags)
+    {
+        if (not chunk_flags_stamped)
+            return;
+
+        ForEachChunkLayer(area, [flags](BlackTek::World::Chunk& chunk, uint8_t z, uint32_t, uint32_t, uint64_t mask) {
+            SetChunkLayerFlags(chunk, z, mask, flags);
+        });
+    }
+
+    void ZoneManager::ClearChunkFlags(const ZoneArea& area)
+    {
+        if (not chunk_flags_stamped)
+            return;
+
+        ForEachChunkLayer(area, [](BlackTek::World::Chunk& chunk, uint8_t z, uint32_t, uint32_t, uint64_t mask) {
+            if (not chunk.zone_flags)
+                return;
+
+            for (auto& plane : (*chunk.zone_flags)[z])
+                plane &= ~mask;
+        });
+    }
+
+    void ZoneManager::RestampChunkFlags(const ZoneArea& area)
+    {
+        if (not chunk_flags_stamped)
+            return;
+
+        // drop the area's bits, then put back whatever the remaining zones and external flags still cover
+        ForEachChunkLayer(area, [](BlackTek::World::Chunk& chunk, uint8_t z, uint32_t baseX, uint32_t baseY, uint64_t mask) {
+            using BlackTek::World::Floor;
+
+            if (chunk.zone_flags)
+            {
+                for (auto& plane : (*chunk.zone_flags)[z])
+                    plane &= ~mask;
+            }
+
+            zone_index.ForEachInChunk(static_cast<uint16_t>(baseX), static_cast<uint16_t>(baseY), [&](uint64_t owner, const ZoneArea& other) {
+                const Zone* zone = GetZone(static_cast<int>(owner));
+                if (zone and zone->world_flags != 0 and z >= other.min_z and z <= other.max_z)
+                    SetChunkLayerFlags(chunk, z, mask & ChunkAreaMask(other, baseX, baseY), zone->world_flags);
+            });
+
+            if (external_world_flags.empty())
+                return;
+
+            for (uint64_t bits = mask; bits != 0; bits &= bits - 1)
+            {
+                const int bitIndex = std::countr_zero(bits);
+                const Position position(static_cast<uint16_t>(baseX + (bitIndex & Floor::Mask)), static_cast<uint16_t>(baseY + (bitIndex >> Floor::Bits)), z);
+
+                if (auto it = external_world_flags.find(position); it != external_world_flags.end())
+                    SetChunkLayerFlags(chunk, z, uint64_t{1} << bitIndex, it->second);
+            }
+        });
+    }
+
     bool ZoneManager::HasWorldFlag(const Position& pos, ZoneFlag flag)
     {
-        if (world_flag_cache.empty())
-            return false;
+        if (chunk_flags_stamped)
+            return ReadChunkFlags(pos, static_cast<uint32_t>(flag)) != 0;
 
-        auto it = world_flag_cache.find(pos);
-        return it != world_flag_cache.end() and (it->second & static_cast<uint32_t>(flag)) != 0;
+        return (CollectWorldFlags(pos) & static_cast<uint32_t>(flag)) != 0;
     }
 
     uint32_t ZoneManager::GetWorldFlags(const Position& pos)
     {
-        if (world_flag_cache.empty())
-            return 0;
+        if (chunk_flags_stamped)
+            return ReadChunkFlags(pos, ChunkFlagMask);
 
-        auto it = world_flag_cache.find(pos);
-        return it != world_flag_cache.end() ? it->second : 0;
+        return CollectWorldFlags(pos);
     }
 
     void ZoneManager::SetWorldFlag(const Position& pos, ZoneFlag flag)
     {
-        world_flag_cache[pos]     |= static_cast<uint32_t>(flag);
         external_world_flags[pos] |= static_cast<uint32_t>(flag);
+        AddChunkFlags(ZoneArea::FromPosition(pos), static_cast<uint32_t>(flag));
     }
 
+    void ZoneManager::StampChunkFlags(uint16_t x, uint16_t y)
+    {
+        using namespace BlackTek::World;
+
+        if (not chunk_flags_stamped)
+            return;
+
+        ZoneArea area;
+        area.min_x = x & ~Floor::Mask;
+        area.min_y = y & ~Floor::Mask;
+        area.max_x = area.min_x + Floor::Mask;
+        area.max_y = area.min_y + Floor::Mask;
+        area.max_z = MaxLayers - 1;
+        RestampChunkFlags(area);
+    }
+
+    void ZoneManager::RunWorldFlagBenchmark(uint32_t lookups)
+    {
+        std::vector<ZoneArea> flagged;
+        zone_index.ForEachArea([&flagged](uint64_t owner, const ZoneArea& area) {
+            if (const Zone* zone = GetZone(static_cast<int>(owner)); zone and zone->world_flags != 0)
+                flagged.push_back(area);
+        });
+
+        if (flagged.empty() or not chunk_flags_stamped)
+        {
+            fmt::print("\n    World flag benchmark: no zone flags loaded\n\n");
+            return;
+        }
+
+        // every other probe is a flagged tile, the rest lands somewhere around one (mostly misses, as in game)
+        std::vector<Position> probes(4096);
+        for (size_t i = 0; i < probes.size(); ++i)
+        {
+            const ZoneArea& area = flagged[uniform_random(0, static_cast<int32_t>(flagged.size()) - 1)];
+            Position position(static_cast<uint16_t>(uniform_random(area.min_x, area.max_x)),
+                static_cast<uint16_t>(uniform_random(area.min_y, area.max_y)),
+                static_cast<uint8_t>(uniform_random(area.min_z, area.max_z)));
+
+            if (i % 2 != 0)
+            {
+                position.x = static_cast<uint16_t>(std::clamp<int32_t>(position.x + uniform_random(-16, 16), 0, 0xFFFF));
+                position.y = static_cast<uint16_t>(std::clamp<int32_t>(position.y + uniform_random(-16, 16), 0, 0xFFFF));
+            }
+            probes[i] = position;
+        }
+
+        static constexpr std::array<ZoneFlag, 4> checkedFlags = { ZoneFlag::Protection, ZoneFlag::NoPvp, ZoneFlag::Pvp, ZoneFlag::NoLogout };
+
+        using Clock = std::chrono::steady_clock;
+        auto nanosPerLookup = [lookups](Clock::duration elapsed) {
+            return std::chrono::duration<double, std::nano>(elapsed).count() / lookups;
+        };
+
+        uint64_t indexHits = 0;
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < lookups; ++i)
+            indexHits += (CollectWorldFlags(probes[i & 4095]) & static_cast<uint32_t>(checkedFlags[i & 3])) != 0 ? 1 : 0;
+        const double indexNanos = nanosPerLookup(Clock::now() - start);
+
+        uint64_t chunkHits = 0;
+        start = Clock::now();
+        for (uint32_t i = 0; i < lookups; ++i)
+            chunkHits += HasWorldFlag(probes[i & 4095], checkedFlags[i & 3]) ? 1 : 0;
+        const double chunkNanos = nanosPerLookup(Clock::now() - start);
+
+        size_t mismatches = 0;
+        for (const auto& position : probes)
+            mismatches += (CollectWorldFlags(position) & ChunkFlagMask) != GetWorldFlags(position) ? 1 : 0;
+
+        fmt::print("\n    World flag benchmark: {} flagged areas in {} buckets, {} lookups\n\n", flagged.size(), zone_index.BucketCount(), lookups);
+        fmt::print("    {:<28} {:>10.2f} ns per lookup, {} hits\n", "zone area index", indexNanos, indexHits);
+        fmt::print("    {:<28} {:>10.2f} ns per lookup, {} hits {:>7.2f}x\n", "chunk bitplanes", chunkNanos, chunkHits, indexNanos / chunkNanos);
+        fmt::print("    {:<28} {:>10} of {} probes disagree\n\n", "", mismatches, probes.size());
+    }
     ZoneType_t ZoneManager::GetZoneType(const Position& pos)
     {
         uint32_t flags = GetWorldFlags(pos);
@@ -2534,16 +2763,15 @@ namespace Zones
 
     void ZoneManager::StampWorldZoneFlags()
     {
-        for (ZoneHandle handle : zone_registry)
-        {
-            Zone* zone = zone_pool.TryGetMutable(handle);
+        chunk_flags_stamped = true;
 
-            if (not zone or zone->world_flags == 0)
-                continue;
+        zone_index.ForEachArea([](uint64_t owner, const ZoneArea& area) {
+            if (const Zone* zone = GetZone(static_cast<int>(owner)); zone and zone->world_flags != 0)
+                AddChunkFlags(area, zone->world_flags);
+        });
 
-            for (const auto& position : zone->positions)
-                world_flag_cache[position] |= zone->world_flags;
-        }
+        for (const auto& [position, flags] : external_world_flags)
+            AddChunkFlags(ZoneArea::FromPosition(position), flags);
     }
 
     static uint32_t TranslateTileFlagsToWorldFlags(uint32_t otbmFlags)
@@ -3024,7 +3252,7 @@ namespace Zones
                 zone.creature_list.push_back(converted);
             }
 
-            zone.positions = FillRectangle(paddedStart, paddedEnd);
+            zone.area_range = std::make_pair(paddedStart, paddedEnd);
             std::string zoneName = zone.name;
             auto handle = ZoneManager::RegisterZone(std::move(zone));
 
@@ -7,11 +7,13 @@
 #include "position.h"
 #include "tile.h"
 #include "handle.h"
+#include "zoneindex.h"
 #include <algorithm>
 #include <utility>
 #include <vector>
 #include <queue>
 #include <deque>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory_resource>
@@ -292,6 +294,8 @@ namespace Zones
         Position                startpos;
         std::optional<Position> range_end;
         std::vector<Position>   positions;
+        // covered area when it was given as a range instead of positions, kept as a box rather than expanded
+        std::optional<std::pair<Position, Position>> area_range;
         uint32_t                world_flags = 0;
         SpawnType               entity_type = SpawnType::None;
         Policy                  policy = Policy::None;
@@ -564,9 +568,16 @@ namespace Zones
 
         static bool     HasWorldFlag(const Position& pos, ZoneFlag flag);
         static uint32_t GetWorldFlags(const Position& pos);
+        // Tiles of a chunk layer with any of flags set, bit y * Floor::Size + x. Nothing until the flags are
+        // stamped into the chunks, callers have to ask HasWorldFlag tile by tile then.
+        static std::optional<uint64_t> ChunkFlagBits(const BlackTek::World::Chunk& chunk, uint8_t z, uint32_t flags);
 
         static void SetWorldFlag(const Position& pos, ZoneFlag flag);
 
+        // Fills the bitplanes of a chunk created after StampWorldZoneFlags
+        static void StampChunkFlags(uint16_t x, uint16_t y);
+        static void RunWorldFlagBenchmark(uint32_t lookups);
+
         static ZoneType_t GetZoneType(const Position& pos);
 
         static void SmartConvertLegacyZoneFlags(Map& map);
@@ -579,7 +590,7 @@ namespace Zones
         static std::optional<ZoneHandle> GetZoneByName(const std::string& name);
         static std::vector<int> GetZonesByPosition(const Position& position);
 
-        static void RegisterSpawnPosition(Position& position, ZoneHandle zone);
+        static void RegisterSpawnRange(ZoneHandle zone, const Position& start, const Position& end);
         static void RegisterTriggered(uint32_t triggered_id, SpawnTrigger trigger);
         static void RegisterStaged(uint32_t staged_id, StageType stage_type);
         static void RegisterLinked(uint32_t linked_id, LinkType link_type);
@@ -613,11 +624,16 @@ namespace Zones
     private:
 
         inline static std::vector<ZoneHandle> zone_registry = { ZoneHandle{} };
-        inline static std::multimap<Position, int>       position_zone_index;
+        // areas of every registered zone by zone id
+        inline static ZoneIndex zone_index;
         inline static std::unordered_map<std::string, ZoneHandle> name_registry;
-        inline static gtl::flat_hash_map<Position, uint32_t, PositionHash> world_flag_cache;
         inline static gtl::flat_hash_map<Position, uint32_t, PositionHash> external_world_flags;
-        inline static gtl::flat_hash_map<Position, ZoneOverlay, PositionHash>  spawn_position_registry;
+        // until the map is loaded world flags are collected from zone_index and external_world_flags, once
+        // StampWorldZoneFlags ran they are kept in the chunk bitplanes and every change is written through
+        inline static bool chunk_flags_stamped = false;
+        // spawn ranges by packed zone handle, one shared overlay per distinct set of ranges covering a tile
+        inline static ZoneIndex spawn_index;
+        inline static std::map<std::vector<uint64_t>, ZoneOverlay> spawn_overlays;
         inline static std::unordered_map<uint32_t, SpawnTrigger>                                triggered_spawns;
         inline static std::unordered_map<uint32_t, StageType>                                   staged_spawns;
         inline static std::unordered_map<uint32_t, LinkType>                                    linked_spawns;
@@ -628,5 +644,11 @@ namespace Zones
 
         static std::pair<SpawnCreaturePtr, ParseResult> SerializeMonsterEntry(const toml::v3::node& toml_data);
         static std::pair<SpawnCreaturePtr, ParseResult> SerializeNpcEntry(const toml::v3::node& toml_data);
+
+        static uint32_t CollectWorldFlags(const Position& pos);
+        static uint32_t ReadChunkFlags(const Position& pos, uint32_t mask);
+        static void     AddChunkFlags(const ZoneArea& area, uint32_t flags);
+        static void     ClearChunkFlags(const ZoneArea& area);
+        static void     RestampChunkFlags(const ZoneArea& area);
     };
 }
\ No newline at end of file